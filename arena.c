@@ -228,6 +228,58 @@ void *zmallocArena(struct Arena **arena, size_t size) {
     return memoryLocation;
 }
 
+void *reallocArena(struct Arena **arena, void *pointer, size_t oldSize,
+                   size_t newSize) {
+    if (arena == NULL || *arena == NULL) {
+        DEBUG_ERROR("`reallocArena` was called with a bad arena pointer");
+        return NULL;
+    }
+    if (pointer == NULL) {
+        return mallocArena(arena, newSize);
+    }
+    // arrays hold onto the node they started with so the pointer can be in
+    // any node from here on
+    for (struct Arena *node = *arena; node != NULL; node = node->nextNode) {
+        char *start = node->start;
+        if ((char *)pointer < start ||
+            (char *)pointer > start + node->currentOffset) {
+            continue;
+        }
+        size_t used = (char *)pointer - start;
+        if (used + oldSize == node->currentOffset &&
+            used + newSize <= node->size) {
+            // keep the free part of the node zeroed like freeArena does
+            if (newSize < oldSize) {
+                memset((char *)pointer + newSize, 0, oldSize - newSize);
+            }
+            node->currentOffset = used + newSize;
+            return pointer;
+        }
+        break;
+    }
+    if (newSize <= oldSize) {
+        return pointer;
+    }
+    void *newPointer = mallocArena(arena, newSize);
+    if (newPointer == NULL) {
+        DEBUG_ERROR("`reallocArena` was unable to allocate memory");
+        return NULL;
+    }
+    memcpy(newPointer, pointer, oldSize);
+    return newPointer;
+}
+
+struct Arena *getLastArenaNode(struct Arena *arena) {
+    if (arena == NULL) {
+        DEBUG_ERROR("`getLastArenaNode` was called with a bad arena pointer");
+        return NULL;
+    }
+    while (arena->nextNode != NULL) {
+        arena = arena->nextNode;
+    }
+    return arena;
+}
+
 void *startScratchPad(const struct Arena *arena) {
     if (arena == NULL) {
         DEBUG_ERROR("`startScratchPad` was called with a bad arena pointer");
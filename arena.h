@@ -27,8 +27,17 @@ int freeArena(struct Arena **arena, size_t size);
 // memory allocs on the arena
 void *mallocArena(struct Arena **arena, size_t size);
 void *zmallocArena(struct Arena **arena, size_t size);
+// resize an allocation. If it is the last thing handed out by its node and the
+// node has room it grows or shrinks in place, otherwise it is copied to a new
+// allocation. The old memory is not reused in that case
+void *reallocArena(struct Arena **arena, void *pointer, size_t oldSize,
+                   size_t newSize);
 
 // scratch pad methods
+// Restoring a scratch pad clears everything after the restore point so a pad
+// should be started from the newest node. Arrays hold onto the node they were
+// created with, so move to the end with `getLastArenaNode` first.
+struct Arena *getLastArenaNode(struct Arena *arena);
 void *startScratchPad(const struct Arena *arena);
 int restoreSratchPad(struct Arena **arena, void *restorePoint);
 #endif
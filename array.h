@@ -3,6 +3,7 @@
 
 #include "arena.h"
 #include "debug.h"
+#include "simd.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,6 +15,10 @@ enum ArrayError {
     UNINITARRAY = 2,
     FAILEDALLOC = 3,
     INVALIDARGS = 4,
+    BUFFERFULL = 5,
+    BUFFEREMPTY = 6,
+    TIMEDOUT = 7,
+    OUTOFRANGE = 8,
 };
 
 // fixed arrays that don't make sense to be allocated in an arena due to either
@@ -90,6 +95,41 @@ enum ArrayError {
         (status) = 0;                                                          \
     } while (0)
 
+// Array that keeps its first N items inside the struct. items points at the
+// inline storage until a push runs past N, then everything moves to the arena
+// like a normal array would when it grows. Since it has the same fields as
+// ARRAY the push, append, clear and search macros all work on it. items points
+// back into the struct so it can't be copied by value and has to be
+// initialized where it will live.
+#define SMALL_ARRAY(type, inlineCount)                                         \
+    struct {                                                                   \
+        type *items;                                                           \
+        size_t size;                                                           \
+        size_t alloc;                                                          \
+        struct Arena *arena;                                                   \
+        type inlineItems[inlineCount];                                         \
+    }
+
+#define NEW_SMALL_ARRAY() {0, 0, 0, 0, {0}}
+// the arena is still needed in case the array outgrows the inline storage
+#define INIT_SMALL_ARRAY(array, givenArena, status)                            \
+    do {                                                                       \
+        if ((givenArena) == NULL) {                                            \
+            DEBUG_ERROR("called INIT_SMALL_ARRAY with a null arena pointer");  \
+            (status) = NULLPOINTER;                                            \
+            break;                                                             \
+        }                                                                      \
+        (array).size = 0;                                                      \
+        (array).items = (array).inlineItems;                                   \
+        (array).alloc =                                                        \
+            sizeof((array).inlineItems) / sizeof(*(array).inlineItems);        \
+        (array).arena = givenArena;                                            \
+        (status) = 0;                                                          \
+    } while (0)
+
+// true while the items still live in the struct
+#define SMALL_ARRAY_IS_INLINE(array) ((array).items == (array).inlineItems)
+
 // Set size to zero which will do a lazy clear
 #define CLEAR_ARRAY(array, status)                                             \
     do {                                                                       \
@@ -150,6 +190,14 @@ enum ArrayError {
         (array).alloc = size;                                                  \
     } while (0)
 
+static inline size_t nextPowerOfTwo(size_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
 static inline size_t nextArrayAllocSize(size_t currentlyAlloced) {
     if (currentlyAlloced != 0) {
         return currentlyAlloced * 2;
@@ -157,6 +205,33 @@ static inline size_t nextArrayAllocSize(size_t currentlyAlloced) {
     return 1;
 }
 
+// append count items from source to the end of the array. The array grows
+// once to fit all of them instead of once per item
+#define APPEND_ARRAY(array, source, count, status)                             \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED(array) || ((source) == NULL && (count) != 0)) { \
+            DEBUG_ERROR("called APPEND_ARRAY with a null pointer");            \
+            (status) = NULLPOINTER;                                            \
+            break;                                                             \
+        }                                                                      \
+        size_t appendTotal = (array).size + (count);                           \
+        if ((array).alloc < appendTotal) {                                     \
+            size_t appendAlloc = nextArrayAllocSize((array).alloc);            \
+            while (appendAlloc < appendTotal) {                                \
+                appendAlloc *= 2;                                              \
+            }                                                                  \
+            REALLOC_ARRAY(array, appendAlloc, status);                         \
+            if ((array).items == NULL) {                                       \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        if ((count) != 0) {                                                    \
+            memcpy((array).items + (array).size, source,                       \
+                   (count) * sizeof(*(array).items));                          \
+        }                                                                      \
+        (array).size = appendTotal;                                            \
+    } while (0)
+
 #define COPY(array_src, array_dst, status)                                     \
     do {                                                                       \
         if (!ARRAY_INITIALIZED(array_src) || !ARRAY_INITIALIZED(array_dst)) {  \
@@ -202,6 +277,69 @@ static inline size_t nextArrayAllocSize(size_t currentlyAlloced) {
         }                                                                      \
     } while (0)
 
+// returned by the search macros when the item is not in the array
+#define ARRAY_NOT_FOUND SIMD_NOT_FOUND
+
+// set index to the first item that is equal to value or ARRAY_NOT_FOUND.
+// Items are compared byte by byte so structs with padding in them should not
+// be searched this way
+#define ARRAY_FIND(array, value, index)                                        \
+    do {                                                                       \
+        __typeof__(*(array).items) arrayFindValue = (value);                   \
+        (index) = findItem((array).items, (array).size,                        \
+                           sizeof(*(array).items), &arrayFindValue);           \
+    } while (0)
+
+// set count to the number of items that are equal to value
+#define ARRAY_COUNT(array, value, count)                                       \
+    do {                                                                       \
+        __typeof__(*(array).items) arrayCountValue = (value);                  \
+        (count) = countItem((array).items, (array).size,                       \
+                            sizeof(*(array).items), &arrayCountValue);         \
+    } while (0)
+
+// set equal to 1 if both arrays hold the same items in the same order
+#define ARRAY_EQUAL(array_a, array_b, equal)                                   \
+    do {                                                                       \
+        (equal) = sizeof(*(array_a).items) == sizeof(*(array_b).items) &&      \
+                  (array_a).size == (array_b).size &&                          \
+                  equalBytes((array_a).items, (array_b).items,                 \
+                             (array_a).size * sizeof(*(array_a).items));       \
+    } while (0)
+
+// resize the array to count items and set all of them to value
+#define ARRAY_FILL(array, value, count, status)                                \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED(array)) {                                       \
+            DEBUG_ERROR("called ARRAY_FILL with an unintialized array");       \
+            (status) = UNINITARRAY;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((array).alloc < (count)) {                                         \
+            REALLOC_ARRAY(array, count, status);                               \
+        }                                                                      \
+        if ((array).items == NULL) {                                           \
+            DEBUG_ERROR("cannot fill the array");                              \
+            break;                                                             \
+        }                                                                      \
+        __typeof__(*(array).items) arrayFillValue = (value);                   \
+        fillItems((array).items, (count), sizeof(*(array).items),              \
+                  &arrayFillValue);                                            \
+        (array).size = (count);                                                \
+    } while (0)
+
+// find the smallest and largest item of an int32_t, int64_t, float or double
+// array. status is set to INVALIDARGS if the array is empty
+#define ARRAY_MIN_MAX(array, min, max, status)                                 \
+    do {                                                                       \
+        (status) = _Generic(*(array).items,                                    \
+            int32_t: minMaxInt32,                                              \
+            int64_t: minMaxInt64,                                              \
+            float: minMaxFloat,                                                \
+            double: minMaxDouble)((array).items, (array).size, &(min),         \
+                                  &(max));                                     \
+    } while (0)
+
 static inline void *reallocArray(struct Arena *arena, void *oldPointer,
                                  size_t oldAlloc, size_t newAlloc) { // NOLINT
     if (arena == NULL) {
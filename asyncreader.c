@@ -0,0 +1,781 @@
+#include "asyncreader.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "mpmcbuffer.h"
+#include "ringbuffer.h"
+#include "string.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// tells a worker thread to exit
+#define STOP_SLOT UINT32_MAX
+
+struct ReadRequest {
+    int fd;
+    // -1 for a read into a buffer that wasn't registered
+    int32_t bufferIndex;
+    char *buffer;
+    size_t size;
+    uint64_t offset;
+    void *userData;
+};
+
+struct ThreadCompletion {
+    uint32_t slot;
+    int64_t result;
+};
+
+// The rings are shared with the kernel. We only write the sq tail and the cq
+// head, and the kernel only writes the other two
+struct Ring {
+    int fd;
+    void *sqMap;
+    size_t sqMapSize;
+    void *cqMap;
+    size_t cqMapSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+    uint32_t *sqTail;
+    uint32_t sqMask;
+    uint32_t *sqArray;
+    uint32_t *cqHead;
+    uint32_t *cqTail;
+    uint32_t cqMask;
+    struct io_uring_cqe *cqes;
+    // written to the sq and not taken by io_uring_enter yet
+    uint32_t unsubmitted;
+};
+
+// the pread fallback. Slots go to the workers through requests and come back
+// through done, and the semaphores count what is waiting in each
+struct ReaderThreads {
+    ARRAY(pthread_t) threads;
+    MPMC_BUFFER(uint32_t) requests;
+    MPMC_BUFFER(struct ThreadCompletion) done;
+    sem_t requestCount;
+    sem_t doneCount;
+    int semaphoresReady;
+    // pushed to requests but not counted in requestCount yet
+    uint32_t unsubmitted;
+};
+
+struct AsyncReader {
+    enum AsyncBackend backend;
+    uint32_t depth;
+    // a read holds its slot from queueing until it is posted
+    ARRAY(struct ReadRequest) requests;
+    ARRAY(uint32_t) freeSlots;
+    ARRAY(char *) fixedBuffers;
+    size_t fixedSize;
+    struct Ring ring;
+    struct ReaderThreads threads;
+};
+
+// the probe can list at most this many ops
+#define PROBE_OP_COUNT 256
+
+// io_uring_setup working only means the kernel is 5.1 or newer but
+// IORING_OP_READ needs 5.6. The probe came in with 5.6 as well, so a kernel
+// that can't answer it can't do the reads either
+static int ringCanRead(int fd) {
+    _Alignas(struct io_uring_probe) unsigned char
+        storage[sizeof(struct io_uring_probe) +
+                PROBE_OP_COUNT * sizeof(struct io_uring_probe_op)];
+    memset(storage, 0, sizeof(storage));
+    struct io_uring_probe *probe = (struct io_uring_probe *)storage;
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                PROBE_OP_COUNT) != 0) {
+        return 0;
+    }
+    uint8_t ops[] = {IORING_OP_READ, IORING_OP_READ_FIXED};
+    for (size_t i = 0; i < sizeof(ops); i++) {
+        if (ops[i] >= probe->ops_len ||
+            !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int setupRing(struct Ring *ring, uint32_t depth) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+    if (ring->fd < 0) {
+        DEBUG_PRINT("io_uring is not available so reads will use threads");
+        ring->fd = -1;
+        return INVALIDARGS;
+    }
+    if (!ringCanRead(ring->fd)) {
+        DEBUG_PRINT("io_uring can't do plain reads so reads will use threads");
+        return INVALIDARGS;
+    }
+    ring->sqMapSize =
+        params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cqMapSize =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    int singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        size_t mapSize = ring->sqMapSize > ring->cqMapSize ? ring->sqMapSize
+                                                           : ring->cqMapSize;
+        ring->sqMapSize = mapSize;
+        ring->cqMapSize = mapSize;
+    }
+    ring->sqMap = mmap(NULL, ring->sqMapSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqMap == MAP_FAILED) {
+        ring->sqMap = NULL;
+        return FAILEDALLOC;
+    }
+    if (singleMap) {
+        ring->cqMap = ring->sqMap;
+    }
+    else {
+        ring->cqMap =
+            mmap(NULL, ring->cqMapSize, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqMap == MAP_FAILED) {
+            ring->cqMap = NULL;
+            return FAILEDALLOC;
+        }
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        return FAILEDALLOC;
+    }
+    char *sq = ring->sqMap;
+    char *cq = ring->cqMap;
+    ring->sqTail = (uint32_t *)(sq + params.sq_off.tail);
+    ring->sqMask = *(uint32_t *)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (uint32_t *)(sq + params.sq_off.array);
+    ring->cqHead = (uint32_t *)(cq + params.cq_off.head);
+    ring->cqTail = (uint32_t *)(cq + params.cq_off.tail);
+    ring->cqMask = *(uint32_t *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->unsubmitted = 0;
+    return OK;
+}
+
+static void teardownRing(struct Ring *ring) {
+    if (ring->sqes != NULL) {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+    if (ring->cqMap != NULL && ring->cqMap != ring->sqMap) {
+        munmap(ring->cqMap, ring->cqMapSize);
+    }
+    if (ring->sqMap != NULL) {
+        munmap(ring->sqMap, ring->sqMapSize);
+    }
+    if (ring->fd != -1) {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(struct Ring));
+    ring->fd = -1;
+}
+
+// submit what is in the sq and wait for minimum completions
+static int enterRing(struct Ring *ring, uint32_t minimum) {
+    for (;;) {
+        unsigned flags = minimum != 0 ? IORING_ENTER_GETEVENTS : 0;
+        long submitted = syscall(__NR_io_uring_enter, ring->fd,
+                                 ring->unsubmitted, minimum, flags, NULL, 0);
+        if (submitted >= 0) {
+            ring->unsubmitted -= (uint32_t)submitted;
+            return OK;
+        }
+        if (errno != EINTR) {
+            DEBUG_ERROR("io_uring_enter failed to submit or wait");
+            return FAILEDALLOC;
+        }
+    }
+}
+
+static void pushRingRead(struct Ring *ring, const struct ReadRequest *request,
+                         uint32_t slot) {
+    uint32_t tail = *ring->sqTail;
+    uint32_t index = tail & ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode =
+        request->bufferIndex < 0 ? IORING_OP_READ : IORING_OP_READ_FIXED;
+    sqe->fd = request->fd;
+    sqe->addr = (uint64_t)(uintptr_t)request->buffer;
+    sqe->len = (uint32_t)request->size;
+    sqe->off = request->offset;
+    sqe->buf_index =
+        (uint16_t)(request->bufferIndex < 0 ? 0 : request->bufferIndex);
+    sqe->user_data = slot;
+    ring->sqArray[index] = index;
+    // the entry has to be written before the kernel can see the new tail
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->unsubmitted++;
+}
+
+static void *readerThreadMain(void *context) {
+    struct AsyncReader *reader = context;
+    struct ReaderThreads *threads = &reader->threads;
+    for (;;) {
+        while (sem_wait(&threads->requestCount) != 0) {
+        }
+        uint32_t slot = 0;
+        int status = OK;
+        TRY_POP_MPMC_BUFFER(threads->requests, slot, status);
+        if (status != OK || slot == STOP_SLOT) {
+            return NULL;
+        }
+        // the slot was filled in before it was pushed so this is safe to read
+        const struct ReadRequest *request = &reader->requests.items[slot];
+        ssize_t bytes = pread(request->fd, request->buffer, request->size,
+                              (off_t)request->offset);
+        struct ThreadCompletion completion = {slot, bytes < 0 ? -errno : bytes};
+        TRY_PUSH_MPMC_BUFFER(threads->done, completion, status);
+        while (status == BUFFERFULL) {
+            sched_yield();
+            TRY_PUSH_MPMC_BUFFER(threads->done, completion, status);
+        }
+        sem_post(&threads->doneCount);
+    }
+}
+
+static void stopThreads(struct ReaderThreads *threads) {
+    for (size_t i = 0; i < threads->threads.size; i++) {
+        int status = OK;
+        TRY_PUSH_MPMC_BUFFER(threads->requests, STOP_SLOT, status);
+        (void)status;
+        sem_post(&threads->requestCount);
+    }
+    for (size_t i = 0; i < threads->threads.size; i++) {
+        pthread_join(threads->threads.items[i], NULL);
+    }
+    threads->threads.size = 0;
+    if (threads->semaphoresReady) {
+        sem_destroy(&threads->requestCount);
+        sem_destroy(&threads->doneCount);
+        threads->semaphoresReady = 0;
+    }
+}
+
+static int startThreads(struct AsyncReader *reader, struct Arena **arena) {
+    struct ReaderThreads *threads = &reader->threads;
+    int status = OK;
+    // room for every slot plus a stop for each thread
+    INIT_MPMC_BUFFER(threads->requests, *arena,
+                     reader->depth + ASYNC_READER_THREADS, status);
+    if (status != OK) {
+        return status;
+    }
+    INIT_MPMC_BUFFER(threads->done, *arena,
+                     reader->depth < 2 ? 2 : reader->depth, status);
+    if (status != OK) {
+        return status;
+    }
+    INIT_ARRAY(threads->threads, *arena, status);
+    if (status != OK) {
+        return status;
+    }
+    REALLOC_ARRAY(threads->threads, ASYNC_READER_THREADS, status);
+    if (status != OK) {
+        return status;
+    }
+    if (sem_init(&threads->requestCount, 0, 0) != 0) {
+        DEBUG_ERROR("The async reader was unable to create a semaphore");
+        return FAILEDALLOC;
+    }
+    if (sem_init(&threads->doneCount, 0, 0) != 0) {
+        DEBUG_ERROR("The async reader was unable to create a semaphore");
+        sem_destroy(&threads->requestCount);
+        return FAILEDALLOC;
+    }
+    threads->semaphoresReady = 1;
+    threads->unsubmitted = 0;
+    for (size_t i = 0; i < ASYNC_READER_THREADS; i++) {
+        if (pthread_create(&threads->threads.items[i], NULL, readerThreadMain,
+                           reader) != 0) {
+            DEBUG_ERROR("The async reader was unable to start a thread");
+            stopThreads(threads);
+            return FAILEDALLOC;
+        }
+        threads->threads.size = i + 1;
+    }
+    return OK;
+}
+
+static void flushThreads(struct ReaderThreads *threads) {
+    for (; threads->unsubmitted != 0; threads->unsubmitted--) {
+        sem_post(&threads->requestCount);
+    }
+}
+
+// give the slot back and post its result. completions can be null to throw
+// the result away
+static void postCompletion(struct AsyncReader *reader, uint32_t slot,
+                           int64_t result,
+                           AsyncCompletionBuffer *completions) {
+    const struct ReadRequest *request = &reader->requests.items[slot];
+    if (completions != NULL) {
+        struct AsyncCompletion completion = {request->userData,
+                                             request->buffer, result};
+        PUSH_BUFFER(*completions, completion);
+    }
+    reader->freeSlots.items[reader->freeSlots.size++] = slot;
+}
+
+static size_t reapRing(struct AsyncReader *reader,
+                       AsyncCompletionBuffer *completions, size_t room) {
+    struct Ring *ring = &reader->ring;
+    uint32_t head = *ring->cqHead;
+    uint32_t tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    size_t reaped = 0;
+    for (; head != tail && reaped < room; head++, reaped++) {
+        const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+        postCompletion(reader, (uint32_t)cqe->user_data, cqe->res,
+                       completions);
+    }
+    // the kernel can reuse the entries once it sees the new head
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+static int waitRing(struct AsyncReader *reader, size_t minimum,
+                    AsyncCompletionBuffer *completions, size_t room) {
+    size_t reaped = reapRing(reader, completions, room);
+    int submitted = reader->ring.unsubmitted == 0;
+    while (reaped < minimum || !submitted) {
+        uint32_t waitFor =
+            reaped < minimum ? (uint32_t)(minimum - reaped) : 0;
+        int status = enterRing(&reader->ring, waitFor);
+        if (status != OK) {
+            return status;
+        }
+        submitted = 1;
+        reaped += reapRing(reader, completions, room - reaped);
+    }
+    return OK;
+}
+
+static int waitThreads(struct AsyncReader *reader, size_t minimum,
+                       AsyncCompletionBuffer *completions, size_t room) {
+    struct ReaderThreads *threads = &reader->threads;
+    flushThreads(threads);
+    for (size_t reaped = 0; reaped < room; reaped++) {
+        if (reaped < minimum) {
+            while (sem_wait(&threads->doneCount) != 0) {
+            }
+        }
+        else if (sem_trywait(&threads->doneCount) != 0) {
+            break;
+        }
+        // the push happens before the post so this can't come up empty
+        struct ThreadCompletion completion = {0};
+        int status = OK;
+        TRY_POP_MPMC_BUFFER(threads->done, completion, status);
+        if (status != OK) {
+            DEBUG_ERROR("The async reader lost a completion");
+            return status;
+        }
+        postCompletion(reader, completion.slot, completion.result,
+                       completions);
+    }
+    return OK;
+}
+
+static int queueRequest(struct AsyncReader *reader,
+                        const struct ReadRequest *request) {
+    if (reader->freeSlots.size == 0) {
+        return BUFFERFULL;
+    }
+    uint32_t slot = reader->freeSlots.items[--reader->freeSlots.size];
+    reader->requests.items[slot] = *request;
+    if (reader->requests.items[slot].size > ASYNC_READ_MAX) {
+        reader->requests.items[slot].size = ASYNC_READ_MAX;
+    }
+    if (reader->backend == ASYNC_BACKEND_IO_URING) {
+        pushRingRead(&reader->ring, &reader->requests.items[slot], slot);
+        return OK;
+    }
+    // there is a cell for every slot so this can't be full
+    int status = OK;
+    TRY_PUSH_MPMC_BUFFER(reader->threads.requests, slot, status);
+    reader->threads.unsubmitted++;
+    return status;
+}
+
+// wait for everything in flight and throw the results away
+static int drainReads(struct AsyncReader *reader) {
+    while (readsInFlight(reader) != 0) {
+        int status = reader->backend == ASYNC_BACKEND_IO_URING
+                         ? waitRing(reader, 1, NULL, SIZE_MAX)
+                         : waitThreads(reader, 1, NULL, SIZE_MAX);
+        if (status != OK) {
+            return status;
+        }
+    }
+    return OK;
+}
+
+struct AsyncReader *createAsyncReader(struct Arena **arena, uint32_t depth,
+                                      enum AsyncBackend backend) {
+    if (arena == NULL || *arena == NULL) {
+        DEBUG_ERROR("`createAsyncReader` was called with a bad arena pointer");
+        return NULL;
+    }
+    if (depth == 0 || depth > ASYNC_READER_MAX_DEPTH) {
+        DEBUG_ERROR("`createAsyncReader` was called with a bad depth");
+        return NULL;
+    }
+    struct AsyncReader *reader =
+        zmallocArena(arena, sizeof(struct AsyncReader));
+    if (reader == NULL) {
+        DEBUG_ERROR("`createAsyncReader` was unable to allocate the reader");
+        return NULL;
+    }
+    reader->depth = depth;
+    reader->ring.fd = -1;
+    // INIT_ARRAY resets status so every step has to be checked on its own
+    int status = OK;
+    INIT_ARRAY(reader->requests, *arena, status);
+    if (status != OK) {
+        return NULL;
+    }
+    REALLOC_ARRAY(reader->requests, depth, status);
+    if (status != OK) {
+        return NULL;
+    }
+    INIT_ARRAY(reader->freeSlots, *arena, status);
+    if (status != OK) {
+        return NULL;
+    }
+    REALLOC_ARRAY(reader->freeSlots, depth, status);
+    if (status != OK) {
+        return NULL;
+    }
+    INIT_ARRAY(reader->fixedBuffers, *arena, status);
+    if (status != OK) {
+        return NULL;
+    }
+    reader->requests.size = depth;
+    // hand out the low slots first
+    for (uint32_t i = 0; i < depth; i++) {
+        reader->freeSlots.items[i] = depth - 1 - i;
+    }
+    reader->freeSlots.size = depth;
+
+    if (backend != ASYNC_BACKEND_THREADS) {
+        if (setupRing(&reader->ring, depth) == OK) {
+            reader->backend = ASYNC_BACKEND_IO_URING;
+            return reader;
+        }
+        teardownRing(&reader->ring);
+        if (backend == ASYNC_BACKEND_IO_URING) {
+            DEBUG_ERROR("`createAsyncReader` was unable to set up io_uring");
+            return NULL;
+        }
+    }
+    reader->backend = ASYNC_BACKEND_THREADS;
+    if (startThreads(reader, arena) != OK) {
+        return NULL;
+    }
+    return reader;
+}
+
+void destroyAsyncReader(struct AsyncReader **reader) {
+    if (reader == NULL || *reader == NULL) {
+        return;
+    }
+    struct AsyncReader *localReader = *reader;
+    drainReads(localReader);
+    if (localReader->backend == ASYNC_BACKEND_IO_URING) {
+        teardownRing(&localReader->ring);
+    }
+    else {
+        stopThreads(&localReader->threads);
+        FREE_ARRAY(localReader->threads.threads);
+    }
+    FREE_ARRAY(localReader->requests);
+    FREE_ARRAY(localReader->freeSlots);
+    FREE_ARRAY(localReader->fixedBuffers);
+    *reader = NULL;
+}
+
+enum AsyncBackend asyncReaderBackend(const struct AsyncReader *reader) {
+    if (reader == NULL) {
+        return ASYNC_BACKEND_ANY;
+    }
+    return reader->backend;
+}
+
+size_t readsInFlight(const struct AsyncReader *reader) {
+    if (reader == NULL) {
+        return 0;
+    }
+    return reader->depth - reader->freeSlots.size;
+}
+
+int registerReadBuffers(struct AsyncReader *reader, char *const *buffers,
+                        size_t bufferSize, uint32_t count) {
+    if (reader == NULL || (buffers == NULL && count != 0)) {
+        DEBUG_ERROR("`registerReadBuffers` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (readsInFlight(reader) != 0) {
+        DEBUG_ERROR("`registerReadBuffers` was called with reads in flight");
+        return INVALIDARGS;
+    }
+    int status = OK;
+    if (reader->fixedBuffers.alloc < count) {
+        REALLOC_ARRAY(reader->fixedBuffers, count, status);
+        if (status != OK) {
+            return status;
+        }
+    }
+    if (reader->backend == ASYNC_BACKEND_IO_URING) {
+        if (reader->fixedBuffers.size != 0) {
+            syscall(__NR_io_uring_register, reader->ring.fd,
+                    IORING_UNREGISTER_BUFFERS, NULL, 0);
+        }
+        reader->fixedBuffers.size = 0;
+        if (count == 0) {
+            return OK;
+        }
+        struct iovec *vectors =
+            mallocArena(&reader->fixedBuffers.arena,
+                        count * sizeof(struct iovec));
+        if (vectors == NULL) {
+            DEBUG_ERROR("`registerReadBuffers` was unable to allocate");
+            return FAILEDALLOC;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            vectors[i].iov_base = buffers[i];
+            vectors[i].iov_len = bufferSize;
+        }
+        // this fails if the buffers can't be pinned under the memlock limit
+        if (syscall(__NR_io_uring_register, reader->ring.fd,
+                    IORING_REGISTER_BUFFERS, vectors, count) != 0) {
+            DEBUG_ERROR("`registerReadBuffers` was unable to pin the buffers");
+            return FAILEDALLOC;
+        }
+    }
+    memcpy(reader->fixedBuffers.items, buffers, count * sizeof(char *));
+    reader->fixedBuffers.size = count;
+    reader->fixedSize = bufferSize;
+    return OK;
+}
+
+int queueRead(struct AsyncReader *reader, int fd, char *buffer, size_t size,
+              uint64_t offset, void *userData) {
+    if (reader == NULL || (buffer == NULL && size != 0)) {
+        DEBUG_ERROR("`queueRead` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    struct ReadRequest request = {fd, -1, buffer, size, offset, userData};
+    return queueRequest(reader, &request);
+}
+
+int queueFixedRead(struct AsyncReader *reader, int fd, uint32_t bufferIndex,
+                   size_t size, uint64_t offset, void *userData) {
+    if (reader == NULL) {
+        DEBUG_ERROR("`queueFixedRead` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (bufferIndex >= reader->fixedBuffers.size ||
+        size > reader->fixedSize) {
+        DEBUG_ERROR("`queueFixedRead` was called with a buffer that wasn't "
+                    "registered or a size that doesn't fit");
+        return INVALIDARGS;
+    }
+    struct ReadRequest request = {fd,
+                                  (int32_t)bufferIndex,
+                                  reader->fixedBuffers.items[bufferIndex],
+                                  size,
+                                  offset,
+                                  userData};
+    return queueRequest(reader, &request);
+}
+
+int submitReads(struct AsyncReader *reader) {
+    if (reader == NULL) {
+        DEBUG_ERROR("`submitReads` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (reader->backend == ASYNC_BACKEND_IO_URING) {
+        return reader->ring.unsubmitted == 0 ? OK
+                                             : enterRing(&reader->ring, 0);
+    }
+    flushThreads(&reader->threads);
+    return OK;
+}
+
+int waitForReads(struct AsyncReader *reader, size_t minimum,
+                 AsyncCompletionBuffer *completions) {
+    if (reader == NULL || completions == NULL) {
+        DEBUG_ERROR("`waitForReads` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (!ARRAY_INITIALIZED(completions->array)) {
+        DEBUG_ERROR("`waitForReads` was called with an uninitialized buffer");
+        return UNINITARRAY;
+    }
+    size_t room = completions->array.alloc - completions->array.size;
+    size_t inFlight = readsInFlight(reader);
+    minimum = minimum < inFlight ? minimum : inFlight;
+    minimum = minimum < room ? minimum : room;
+    if (reader->backend == ASYNC_BACKEND_IO_URING) {
+        return waitRing(reader, minimum, completions, room);
+    }
+    return waitThreads(reader, minimum, completions, room);
+}
+
+// where a file is while readFiles has it open
+struct FileRead {
+    int fd;
+    String *file;
+};
+
+static void finishFile(struct FileRead *read) {
+    close(read->fd);
+    read->fd = -1;
+    read->file->items[read->file->size] = '\0';
+}
+
+// open the file, size its string and queue the first read. Returns 0 if there
+// was nothing to read
+static int startFile(struct AsyncReader *reader, const char *path,
+                     struct FileRead *read, struct Arena *arena,
+                     int *status) {
+    read->fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (read->fd == -1 || fstat(read->fd, &info) != 0) {
+        DEBUG_ERROR("`readFiles` was unable to open a file");
+        if (read->fd != -1) {
+            close(read->fd);
+        }
+        read->fd = -1;
+        *status = INVALIDARGS;
+        return 0;
+    }
+    size_t size = (size_t)info.st_size;
+    char *items = mallocArena(&arena, size + 1);
+    if (items == NULL) {
+        DEBUG_ERROR("`readFiles` was unable to allocate a file");
+        close(read->fd);
+        read->fd = -1;
+        *status = FAILEDALLOC;
+        return 0;
+    }
+    read->file->items = items;
+    read->file->alloc = size + 1;
+    if (size == 0) {
+        finishFile(read);
+        return 0;
+    }
+    queueRead(reader, read->fd, items, size, 0, read);
+    return 1;
+}
+
+int readFiles(struct AsyncReader *reader, const char *const *paths,
+              size_t count, struct Arena *arena, StringArray *files) {
+    if (reader == NULL || (paths == NULL && count != 0) || arena == NULL ||
+        files == NULL) {
+        DEBUG_ERROR("`readFiles` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (!ARRAY_INITIALIZED(*files)) {
+        DEBUG_ERROR("`readFiles` was called with an uninitialized array");
+        return UNINITARRAY;
+    }
+    // every completion is taken to be one of ours
+    if (readsInFlight(reader) != 0) {
+        DEBUG_ERROR("`readFiles` was called with other reads in flight");
+        return INVALIDARGS;
+    }
+    int status = OK;
+    size_t first = files->size;
+    if (files->alloc < first + count) {
+        REALLOC_ARRAY(*files, first + count, status);
+        if (status != OK) {
+            return status;
+        }
+    }
+    AsyncCompletionBuffer completions;
+    INIT_BUFFER(completions, arena, reader->depth < 2 ? 2 : reader->depth,
+                status);
+    struct FileRead *reads = mallocArena(&arena, count * sizeof(*reads));
+    if (status != OK || completions.array.items == NULL ||
+        (reads == NULL && count != 0)) {
+        DEBUG_ERROR("`readFiles` was unable to allocate");
+        return FAILEDALLOC;
+    }
+    for (size_t i = 0; i < count; i++) {
+        String empty = {NULL, 0, 0, arena};
+        files->items[first + i] = empty;
+        reads[i].fd = -1;
+        reads[i].file = &files->items[first + i];
+    }
+    files->size = first + count;
+
+    int result = OK;
+    size_t next = 0;
+    while (next < count || readsInFlight(reader) != 0) {
+        // keep the queue full before waiting on anything
+        while (next < count && readsInFlight(reader) < reader->depth) {
+            startFile(reader, paths[next], &reads[next], arena, &result);
+            next++;
+        }
+        if (readsInFlight(reader) == 0) {
+            continue;
+        }
+        status = waitForReads(reader, 1, &completions);
+        if (status != OK) {
+            // the reads still in flight point at reads and their fds, so they
+            // have to finish before the fds go and the caller gets the reader
+            // back. Their results are thrown away
+            drainReads(reader);
+            for (size_t i = 0; i < next; i++) {
+                if (reads[i].fd != -1) {
+                    close(reads[i].fd);
+                    reads[i].fd = -1;
+                }
+            }
+            return status;
+        }
+        while (completions.array.size != 0) {
+            struct AsyncCompletion completion = *completions.head;
+            POP_FRONT_BUFFER(completions);
+            struct FileRead *read = completion.userData;
+            String *file = read->file;
+            if (completion.result < 0) {
+                DEBUG_ERROR("`readFiles` was unable to read a file");
+                result = INVALIDARGS;
+                file->size = 0;
+                finishFile(read);
+                continue;
+            }
+            file->size += (size_t)completion.result;
+            size_t left = file->alloc - 1 - file->size;
+            // 0 means the file got shorter since it was opened
+            if (left == 0 || completion.result == 0) {
+                finishFile(read);
+                continue;
+            }
+            // the slot this read had is free again
+            queueRead(reader, read->fd, file->items + file->size, left,
+                      file->size, read);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+#ifndef ASYNCREADER_H
+#define ASYNCREADER_H
+
+#include "arena.h"      // NOLINT
+#include "array.h"      // NOLINT
+#include "ringbuffer.h" // NOLINT
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Keeps many file reads in flight at once so the disk queue stays busy. Reads
+// are queued without a syscall, handed to the kernel as one batch and their
+// results are posted into a BUFFER by the completion loop in waitForReads.
+//
+// The reads go through io_uring when the kernel allows it. The ring is set up
+// with the raw syscalls so there is nothing to link against. Where io_uring is
+// missing, turned off or too old to have IORING_OP_READ (before 5.6) a few
+// threads doing pread stand in for it, and the calls behave the same either
+// way.
+//
+// The reader is not thread safe. Queue, submit and wait from one thread.
+enum AsyncBackend {
+    // io_uring if the kernel allows it and threads if it doesn't
+    ASYNC_BACKEND_ANY,
+    ASYNC_BACKEND_IO_URING,
+    ASYNC_BACKEND_THREADS,
+};
+
+// reads are I/O bound so this is more threads than there are cores
+#define ASYNC_READER_THREADS 8
+#define ASYNC_READER_MAX_DEPTH 4096
+// a single read is capped like read() is
+#define ASYNC_READ_MAX 0x7ffff000
+
+struct AsyncCompletion {
+    void *userData;
+    char *buffer;
+    // bytes read or -errno. A read can come back short like read() and 0 is
+    // the end of the file
+    int64_t result;
+};
+
+typedef BUFFER(struct AsyncCompletion) AsyncCompletionBuffer;
+
+struct AsyncReader;
+
+// depth is how many reads can be in flight. Returns null on failure or if
+// io_uring was asked for and isn't there
+struct AsyncReader *createAsyncReader(struct Arena **arena, uint32_t depth,
+                                      enum AsyncBackend backend);
+
+// waits for the reads still in flight and throws their results away, so the
+// buffers are safe to reuse after. The reader pointer will be returned as null
+void destroyAsyncReader(struct AsyncReader **reader);
+
+enum AsyncBackend asyncReaderBackend(const struct AsyncReader *reader);
+// queued and not yet posted by waitForReads
+size_t readsInFlight(const struct AsyncReader *reader);
+
+// Register count buffers of bufferSize bytes for queueFixedRead. io_uring pins
+// them once here instead of on every read. Nothing can be in flight
+int registerReadBuffers(struct AsyncReader *reader, char *const *buffers,
+                        size_t bufferSize, uint32_t count);
+
+// queue a read of size bytes at offset into buffer. The buffer has to stay put
+// until the completion is posted. status is BUFFERFULL at the depth
+int queueRead(struct AsyncReader *reader, int fd, char *buffer, size_t size,
+              uint64_t offset, void *userData);
+// same as queueRead but into a buffer from registerReadBuffers
+int queueFixedRead(struct AsyncReader *reader, int fd, uint32_t bufferIndex,
+                   size_t size, uint64_t offset, void *userData);
+
+// hand everything queued to the kernel or the threads. waitForReads does this
+// too, so this is only needed to start reads early
+int submitReads(struct AsyncReader *reader);
+
+// Submit anything queued, wait until at least minimum reads are done and post
+// every finished read there is room for into completions. minimum is capped to
+// the reads in flight and the free room in completions, so 0 just polls
+int waitForReads(struct AsyncReader *reader, size_t minimum,
+                 AsyncCompletionBuffer *completions);
+
+// Read whole files into null terminated strings in the arena, keeping the
+// reader's depth of reads going. A string is appended to files for each path
+// in the same order. A file that can't be opened or read is left empty and the
+// status is INVALIDARGS once the rest are done. Nothing else can be in flight
+// on the reader, that is INVALIDARGS too
+int readFiles(struct AsyncReader *reader, const char *const *paths,
+              size_t count, struct Arena *arena, StringArray *files);
+#endif
@@ -0,0 +1,160 @@
+#include "bitset.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "simd.h"
+#include <stdint.h>
+#include <string.h>
+
+static inline size_t wordsForBits(size_t size) {
+    return (size + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+}
+
+// clear the bits past size in the last word
+static inline void trimLastWord(struct Bitset *bitset) {
+    size_t used = bitset->size % BITSET_WORD_BITS;
+    if (used != 0) {
+        bitset->words[bitset->wordCount - 1] &= (1ULL << used) - 1;
+    }
+}
+
+int initBitset(struct Bitset *bitset, struct Arena *arena, size_t size) {
+    if (bitset == NULL || arena == NULL) {
+        DEBUG_ERROR("`initBitset` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    bitset->words = NULL;
+    bitset->wordCount = 0;
+    bitset->allocWords = 0;
+    bitset->size = 0;
+    bitset->arena = arena;
+    return resizeBitset(bitset, size);
+}
+
+int resizeBitset(struct Bitset *bitset, size_t size) {
+    if (bitset == NULL || bitset->arena == NULL) {
+        DEBUG_ERROR("`resizeBitset` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    size_t wordCount = wordsForBits(size);
+    if (wordCount > bitset->allocWords) {
+        size_t allocWords = bitset->allocWords;
+        while (allocWords < wordCount) {
+            allocWords = nextArrayAllocSize(allocWords);
+        }
+        uint64_t *words = reallocArray(bitset->arena, bitset->words,
+                                       bitset->wordCount * sizeof(uint64_t),
+                                       allocWords * sizeof(uint64_t));
+        if (words == NULL) {
+            DEBUG_ERROR("`resizeBitset` failed to grow the bitset");
+            return FAILEDALLOC;
+        }
+        bitset->words = words;
+        bitset->allocWords = allocWords;
+    }
+    // words past the old count may still hold bits from before a shrink
+    if (wordCount > bitset->wordCount) {
+        memset(bitset->words + bitset->wordCount, 0,
+               (wordCount - bitset->wordCount) * sizeof(uint64_t));
+    }
+    // the dropped bits in the last word have to be cleared when shrinking
+    bitset->wordCount = wordCount;
+    bitset->size = size;
+    if (wordCount != 0) {
+        trimLastWord(bitset);
+    }
+    return OK;
+}
+
+void setAllBits(struct Bitset *bitset) {
+    if (bitset == NULL || bitset->wordCount == 0) {
+        return;
+    }
+    memset(bitset->words, 0xFF, bitset->wordCount * sizeof(uint64_t));
+    trimLastWord(bitset);
+}
+
+void clearAllBits(struct Bitset *bitset) {
+    if (bitset == NULL || bitset->wordCount == 0) {
+        return;
+    }
+    memset(bitset->words, 0, bitset->wordCount * sizeof(uint64_t));
+}
+
+static int combineBitsets(struct Bitset *destination,
+                          const struct Bitset *first,
+                          const struct Bitset *second, int operation) {
+    if (destination == NULL || first == NULL || second == NULL) {
+        DEBUG_ERROR("a bitset operation was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (destination->size != first->size || first->size != second->size) {
+        DEBUG_ERROR("a bitset operation was called with mismatched sizes");
+        return INVALIDARGS;
+    }
+    combineWords(destination->words, first->words, second->words,
+                 first->wordCount, operation);
+    return OK;
+}
+
+int bitsetAnd(struct Bitset *destination, const struct Bitset *first,
+              const struct Bitset *second) {
+    return combineBitsets(destination, first, second, SIMD_WORD_AND);
+}
+
+int bitsetOr(struct Bitset *destination, const struct Bitset *first,
+             const struct Bitset *second) {
+    return combineBitsets(destination, first, second, SIMD_WORD_OR);
+}
+
+int bitsetXor(struct Bitset *destination, const struct Bitset *first,
+              const struct Bitset *second) {
+    return combineBitsets(destination, first, second, SIMD_WORD_XOR);
+}
+
+int bitsetAndNot(struct Bitset *destination, const struct Bitset *first,
+                 const struct Bitset *second) {
+    return combineBitsets(destination, first, second, SIMD_WORD_ANDNOT);
+}
+
+size_t bitsetCount(const struct Bitset *bitset) {
+    if (bitset == NULL) {
+        return 0;
+    }
+    return popcountWords(bitset->words, bitset->wordCount);
+}
+
+size_t nextSetBit(const struct Bitset *bitset, size_t start) {
+    if (bitset == NULL || start >= bitset->size) {
+        return BITSET_NOT_FOUND;
+    }
+    size_t wordIndex = start / BITSET_WORD_BITS;
+    // the first word is masked so bits before start are ignored
+    uint64_t word = bitset->words[wordIndex] &
+                    (~0ULL << (start % BITSET_WORD_BITS));
+    if (word == 0) {
+        size_t skipped = findWordNotEqual(bitset->words + wordIndex + 1,
+                                          bitset->wordCount - wordIndex - 1, 0);
+        if (skipped == SIMD_NOT_FOUND) {
+            return BITSET_NOT_FOUND;
+        }
+        wordIndex += skipped + 1;
+        word = bitset->words[wordIndex];
+    }
+    return (wordIndex * BITSET_WORD_BITS) + (size_t)__builtin_ctzll(word);
+}
+
+size_t findFirstZero(const struct Bitset *bitset) {
+    if (bitset == NULL) {
+        return BITSET_NOT_FOUND;
+    }
+    size_t wordIndex =
+        findWordNotEqual(bitset->words, bitset->wordCount, ~0ULL);
+    if (wordIndex == SIMD_NOT_FOUND) {
+        return BITSET_NOT_FOUND;
+    }
+    size_t index = (wordIndex * BITSET_WORD_BITS) +
+                   (size_t)__builtin_ctzll(~bitset->words[wordIndex]);
+    // the zero might be one of the padding bits in the last word
+    return index < bitset->size ? index : BITSET_NOT_FOUND;
+}
@@ -0,0 +1,71 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include "arena.h"
+#include "simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define BITSET_NOT_FOUND ((size_t)-1)
+#define BITSET_WORD_BITS 64
+
+// A packed set of bits on the arena. Bits past `size` in the last word are
+// always kept at 0 so the word kernels never have to mask them off.
+struct Bitset {
+    uint64_t *words;
+    size_t wordCount;
+    // words allocated. Grows geometrically and never shrinks
+    size_t allocWords;
+    // number of bits
+    size_t size;
+    struct Arena *arena;
+};
+
+// every bit starts cleared
+int initBitset(struct Bitset *bitset, struct Arena *arena, size_t size);
+// grow or shrink to size bits. New bits are cleared
+int resizeBitset(struct Bitset *bitset, size_t size);
+
+// the single bit calls don't check the index. It has to be less than size
+static inline void setBit(struct Bitset *bitset, size_t index) {
+    bitset->words[index / BITSET_WORD_BITS] |=
+        1ULL << (index % BITSET_WORD_BITS);
+}
+
+static inline void clearBit(struct Bitset *bitset, size_t index) {
+    bitset->words[index / BITSET_WORD_BITS] &=
+        ~(1ULL << (index % BITSET_WORD_BITS));
+}
+
+static inline int testBit(const struct Bitset *bitset, size_t index) {
+    uint64_t word = bitset->words[index / BITSET_WORD_BITS];
+    return (int)((word >> (index % BITSET_WORD_BITS)) & 1ULL);
+}
+
+void setAllBits(struct Bitset *bitset);
+void clearAllBits(struct Bitset *bitset);
+
+// destination = first op second. All three need the same size and destination
+// can be one of the sources. INVALIDARGS is returned if the sizes differ
+int bitsetAnd(struct Bitset *destination, const struct Bitset *first,
+              const struct Bitset *second);
+int bitsetOr(struct Bitset *destination, const struct Bitset *first,
+             const struct Bitset *second);
+int bitsetXor(struct Bitset *destination, const struct Bitset *first,
+              const struct Bitset *second);
+// first & ~second
+int bitsetAndNot(struct Bitset *destination, const struct Bitset *first,
+                 const struct Bitset *second);
+
+// number of set bits
+size_t bitsetCount(const struct Bitset *bitset);
+// index of the first set bit at or after start or BITSET_NOT_FOUND
+size_t nextSetBit(const struct Bitset *bitset, size_t start);
+// index of the first cleared bit or BITSET_NOT_FOUND when every bit is set
+size_t findFirstZero(const struct Bitset *bitset);
+
+// loop over the index of every set bit
+#define FOR_EACH_SET_BIT(bitset, index)                                        \
+    for (size_t index = nextSetBit(bitset, 0); index != BITSET_NOT_FOUND;      \
+         index = nextSetBit(bitset, index + 1))
+#endif
@@ -0,0 +1,88 @@
+#include "blockingbuffer.h"
+#include "array.h"
+#include "debug.h"
+#include <linux/futex.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NANOSECONDS_PER_SECOND 1000000000LL
+
+static int64_t monotonicNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * NANOSECONDS_PER_SECOND) + now.tv_nsec;
+}
+
+// the kernel only sleeps if the word still holds expected, so a push that
+// lands between the check and the syscall makes this return right away
+static long futexWait(_Atomic uint32_t *word, uint32_t expected,
+                      int64_t timeoutNanoseconds) {
+    struct timespec timeout;
+    struct timespec *timeoutPointer = NULL;
+    if (timeoutNanoseconds >= 0) {
+        timeout.tv_sec = (time_t)(timeoutNanoseconds / NANOSECONDS_PER_SECOND);
+        timeout.tv_nsec = (long)(timeoutNanoseconds % NANOSECONDS_PER_SECOND);
+        timeoutPointer = &timeout;
+    }
+    return syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT_PRIVATE, expected,
+                   timeoutPointer, NULL, 0);
+}
+
+int waitForTail(_Atomic uint32_t *tail, uint32_t head,
+                _Atomic uint32_t *sleeping, uint32_t spinCount,
+                int64_t timeoutNanoseconds) {
+    if (tail == NULL || sleeping == NULL) {
+        DEBUG_ERROR("`waitForTail` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    // the deadline covers the spinning too so a short timeout isn't
+    // stretched out by a run of yields
+    int64_t deadline = 0;
+    if (timeoutNanoseconds >= 0) {
+        deadline = monotonicNanoseconds() + timeoutNanoseconds;
+    }
+    for (uint32_t i = 0; i < spinCount; i++) {
+        if (atomic_load_explicit(tail, memory_order_acquire) != head) {
+            return OK;
+        }
+        if (timeoutNanoseconds >= 0 && monotonicNanoseconds() >= deadline) {
+            return TIMEDOUT;
+        }
+        sched_yield();
+    }
+    for (;;) {
+        // say we are going to sleep before the last look at the tail. The
+        // producer stores the tail before it checks this flag, so either we
+        // see its item or it sees the flag and wakes us
+        atomic_store_explicit(sleeping, 1, memory_order_seq_cst);
+        uint32_t current = atomic_load_explicit(tail, memory_order_seq_cst);
+        if (current != head) {
+            atomic_store_explicit(sleeping, 0, memory_order_relaxed);
+            return OK;
+        }
+        int64_t remaining = BLOCKING_BUFFER_FOREVER;
+        if (timeoutNanoseconds >= 0) {
+            remaining = deadline - monotonicNanoseconds();
+            if (remaining <= 0) {
+                atomic_store_explicit(sleeping, 0, memory_order_relaxed);
+                return TIMEDOUT;
+            }
+        }
+        // EINTR and EAGAIN and spurious wakeups all just go around again
+        futexWait(tail, current, remaining);
+    }
+}
+
+void wakeTail(_Atomic uint32_t *tail, _Atomic uint32_t *sleeping) {
+    // the plain load keeps the common case free of a locked instruction and
+    // the exchange makes sure only one push pays for the syscall
+    if (atomic_load_explicit(sleeping, memory_order_seq_cst) == 0 ||
+        atomic_exchange_explicit(sleeping, 0, memory_order_seq_cst) == 0) {
+        return;
+    }
+    syscall(SYS_futex, (uint32_t *)tail, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
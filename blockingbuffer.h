@@ -0,0 +1,154 @@
+#ifndef BLOCKINGBUFFER_H
+#define BLOCKINGBUFFER_H
+
+#include "arena.h" // NOLINT
+#include "array.h" // NOLINT
+#include "debug.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define BLOCKING_CACHE_LINE 64
+// pass as the timeout to wait until an item shows up
+#define BLOCKING_BUFFER_FOREVER (-1)
+#define BLOCKING_BUFFER_DEFAULT_SPINS 64
+
+// Single producer, single consumer ring buffer like SPSC_BUFFER where the
+// consumer can sleep until there is something to pop instead of polling. The
+// consumer checks the buffer spinCount times, yielding between checks, and
+// then parks on a futex on the tail. The producer only makes the wake syscall
+// when the consumer has said it is parked, which only happens when the buffer
+// was empty. A producer that never finds anyone parked never leaves user space.
+//
+// tail and head are 32 bits because that is what a futex can wait on. They
+// count up and wrap, and the capacity is capped at 2^31 so tail - head still
+// gives the size.
+#define BLOCKING_BUFFER(type)                                                  \
+    struct {                                                                   \
+        /* set at init and only read after that */                             \
+        type *items;                                                           \
+        uint32_t mask;                                                         \
+        uint32_t spinCount;                                                    \
+        char sharedPadding[BLOCKING_CACHE_LINE];                               \
+        /* producer side */                                                    \
+        _Atomic uint32_t tail;                                                 \
+        uint32_t cachedHead;                                                   \
+        char tailPadding[BLOCKING_CACHE_LINE];                                 \
+        /* consumer side */                                                    \
+        _Atomic uint32_t head;                                                 \
+        uint32_t cachedTail;                                                   \
+        /* set while the consumer is parked or about to park */                \
+        _Atomic uint32_t sleeping;                                             \
+        char headPadding[BLOCKING_CACHE_LINE];                                 \
+    }
+
+// wait until *tail is not head. Spins spinCount times before parking.
+// Returns OK or TIMEDOUT. The timeout counts the spinning as well and a
+// negative timeout waits forever
+int waitForTail(_Atomic uint32_t *tail, uint32_t head,
+                _Atomic uint32_t *sleeping, uint32_t spinCount,
+                int64_t timeoutNanoseconds);
+
+// wake the thread parked on tail if there is one
+void wakeTail(_Atomic uint32_t *tail, _Atomic uint32_t *sleeping);
+
+// set up the buffer before it is shared with the other thread. spinCount is
+// how many times a pop checks the buffer before it parks
+#define INIT_BLOCKING_BUFFER(buffer, arena, buffer_size, spins, status)        \
+    do {                                                                       \
+        struct Arena *blockingArena = (arena);                                 \
+        if (blockingArena == NULL) {                                           \
+            DEBUG_ERROR("called INIT_BLOCKING_BUFFER with a null arena "       \
+                        "pointer");                                            \
+            (status) = NULLPOINTER;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((buffer_size) <= 1 || (buffer_size) > (1u << 31)) {                \
+            DEBUG_ERROR("called INIT_BLOCKING_BUFFER with a size that is "     \
+                        "<= 1 or > 2^31");                                     \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        size_t blockingCapacity = nextPowerOfTwo(buffer_size);                 \
+        (buffer).items = mallocArena(                                          \
+            &blockingArena, blockingCapacity * sizeof(*(buffer).items));       \
+        if ((buffer).items == NULL) {                                          \
+            DEBUG_ERROR("INIT_BLOCKING_BUFFER failed to allocate the buffer"); \
+            (status) = FAILEDALLOC;                                            \
+            break;                                                             \
+        }                                                                      \
+        (buffer).mask = (uint32_t)(blockingCapacity - 1);                      \
+        (buffer).spinCount = (spins);                                          \
+        atomic_init(&(buffer).tail, 0);                                        \
+        (buffer).cachedHead = 0;                                               \
+        atomic_init(&(buffer).head, 0);                                        \
+        (buffer).cachedTail = 0;                                               \
+        atomic_init(&(buffer).sleeping, 0);                                    \
+        (status) = OK;                                                         \
+    } while (0)
+
+#define BLOCKING_BUFFER_CAPACITY(buffer) ((size_t)(buffer).mask + 1)
+
+// producer only. status is BUFFERFULL if there was no room
+#define TRY_PUSH_BLOCKING_BUFFER(buffer, item, status)                         \
+    do {                                                                       \
+        uint32_t blockingTail =                                                \
+            atomic_load_explicit(&(buffer).tail, memory_order_relaxed);        \
+        if (blockingTail - (buffer).cachedHead > (buffer).mask) {              \
+            (buffer).cachedHead =                                              \
+                atomic_load_explicit(&(buffer).head, memory_order_acquire);    \
+            if (blockingTail - (buffer).cachedHead > (buffer).mask) {          \
+                (status) = BUFFERFULL;                                         \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        (buffer).items[blockingTail & (buffer).mask] = (item);                 \
+        /* seq_cst so the store can't pass the check of the sleeping flag */   \
+        atomic_store_explicit(&(buffer).tail, blockingTail + 1,                \
+                              memory_order_seq_cst);                           \
+        wakeTail(&(buffer).tail, &(buffer).sleeping);                          \
+        (status) = OK;                                                         \
+    } while (0)
+
+// consumer only. status is BUFFEREMPTY if there was nothing to pop
+#define TRY_POP_BLOCKING_BUFFER(buffer, item, status)                          \
+    do {                                                                       \
+        uint32_t blockingHead =                                                \
+            atomic_load_explicit(&(buffer).head, memory_order_relaxed);        \
+        if (blockingHead == (buffer).cachedTail) {                             \
+            (buffer).cachedTail =                                              \
+                atomic_load_explicit(&(buffer).tail, memory_order_acquire);    \
+            if (blockingHead == (buffer).cachedTail) {                         \
+                (status) = BUFFEREMPTY;                                        \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        (item) = (buffer).items[blockingHead & (buffer).mask];                 \
+        atomic_store_explicit(&(buffer).head, blockingHead + 1,                \
+                              memory_order_release);                           \
+        (status) = OK;                                                         \
+    } while (0)
+
+// consumer only. Wait until there is something to pop without popping it.
+// status is TIMEDOUT if nothing showed up in time
+#define WAIT_BLOCKING_BUFFER(buffer, timeoutNanoseconds, status)               \
+    do {                                                                       \
+        (status) = waitForTail(                                                \
+            &(buffer).tail,                                                    \
+            atomic_load_explicit(&(buffer).head, memory_order_relaxed),        \
+            &(buffer).sleeping, (buffer).spinCount, timeoutNanoseconds);       \
+    } while (0)
+
+// consumer only. Pop an item, waiting for one if the buffer is empty
+#define POP_BLOCKING_BUFFER(buffer, item, timeoutNanoseconds, status)          \
+    do {                                                                       \
+        TRY_POP_BLOCKING_BUFFER(buffer, item, status);                         \
+        if ((status) != BUFFEREMPTY) {                                         \
+            break;                                                             \
+        }                                                                      \
+        WAIT_BLOCKING_BUFFER(buffer, timeoutNanoseconds, status);              \
+        if ((status) == OK) {                                                  \
+            TRY_POP_BLOCKING_BUFFER(buffer, item, status);                     \
+        }                                                                      \
+    } while (0)
+
+#endif
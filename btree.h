@@ -0,0 +1,749 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// nodes are sized to about 4 cache lines
+#define BTREE_NODE_BYTES 256
+#define BTREE_CAPACITY(entrySize)                                              \
+    ((BTREE_NODE_BYTES / (entrySize)) < 4 ? 4                                  \
+                                          : (BTREE_NODE_BYTES / (entrySize)))
+// with at least 3 children per branch this is far more than memory allows
+#define BTREE_MAX_HEIGHT 48
+
+// Creates an ordered map called `name` from keyType to valueType. It is a B+
+// tree so every key and value lives in the leaves, and the leaves are chained
+// together so a range scan is a walk along that chain. Nodes come from the
+// arena and are put on a free list when a delete empties them. lessThan is
+// called with two `const keyType *` and can be a macro.
+//
+//   int name##Init(name *tree, struct Arena *arena)
+//   size_t name##Size(const name *tree)
+//   int name##Insert(name *tree, keyType key, valueType value)
+//   valueType *name##Find(name *tree, const keyType *key)
+//   int name##Remove(name *tree, const keyType *key, valueType *value)
+//   int name##BulkLoad(name *tree, const keyType *keys,
+//                      const valueType *values, size_t count)
+//   void name##Clear(name *tree)
+//
+// Iterators are invalidated by any insert or remove.
+//
+//   name##Iterator name##Begin(name *tree)
+//   name##Iterator name##LowerBound(name *tree, const keyType *key)
+//   int name##IteratorValid(const name##Iterator *iterator)
+//   int name##IteratorBefore(const name##Iterator *iterator,
+//                            const keyType *end)
+//   void name##IteratorNext(name##Iterator *iterator)
+//   keyType *name##IteratorKey(const name##Iterator *iterator)
+//   valueType *name##IteratorValue(const name##Iterator *iterator)
+//
+// A range scan over [low, high) looks like
+//   for (name##Iterator it = name##LowerBound(&tree, &low);
+//        name##IteratorBefore(&it, &high); name##IteratorNext(&it))
+#define BTREE_DEFINE(keyType, valueType, name, lessThan)                       \
+    enum {                                                                     \
+        name##LeafCapacity =                                                   \
+            BTREE_CAPACITY(sizeof(keyType) + sizeof(valueType)),               \
+        name##BranchCapacity =                                                 \
+            BTREE_CAPACITY(sizeof(keyType) + sizeof(void *)),                  \
+        name##LeafMinimum = name##LeafCapacity / 2,                            \
+        name##BranchMinimum = (name##BranchCapacity - 1) / 2,                  \
+    };                                                                         \
+                                                                               \
+    typedef struct name##Leaf {                                                \
+        /* leaves are chained in key order for range scans */                  \
+        struct name##Leaf *next;                                               \
+        uint32_t count;                                                        \
+        keyType keys[name##LeafCapacity];                                      \
+        valueType values[name##LeafCapacity];                                  \
+    } name##Leaf;                                                              \
+                                                                               \
+    typedef struct name##Branch {                                              \
+        uint32_t count;                                                        \
+        /* keys[i] is the smallest key under children[i + 1] */                \
+        keyType keys[name##BranchCapacity];                                    \
+        /* these are leaves on the last branch level */                        \
+        void *children[name##BranchCapacity + 1];                              \
+    } name##Branch;                                                            \
+                                                                               \
+    typedef struct {                                                           \
+        void *root;                                                            \
+        /* 0 when empty and 1 when the root is a leaf */                       \
+        uint32_t height;                                                       \
+        size_t size;                                                           \
+        struct Arena *arena;                                                   \
+        name##Leaf *freeLeaves;                                                \
+        name##Branch *freeBranches;                                            \
+    } name;                                                                    \
+                                                                               \
+    typedef struct {                                                           \
+        /* NULL once the iterator runs off the end */                          \
+        name##Leaf *leaf;                                                      \
+        uint32_t index;                                                        \
+    } name##Iterator;                                                          \
+                                                                               \
+    static inline int name##Init(name *tree, struct Arena *arena) {            \
+        if (tree == NULL || arena == NULL) {                                   \
+            DEBUG_ERROR("Init was called with a null pointer");                \
+            return NULLPOINTER;                                                \
+        }                                                                      \
+        tree->root = NULL;                                                     \
+        tree->height = 0;                                                      \
+        tree->size = 0;                                                        \
+        tree->arena = arena;                                                   \
+        tree->freeLeaves = NULL;                                               \
+        tree->freeBranches = NULL;                                             \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    static inline size_t name##Size(const name *tree) { return tree->size; }   \
+                                                                               \
+    /* freed nodes go on a list so deletes and inserts can trade them */       \
+    static inline void name##FreeLeaf(name *tree, name##Leaf *leaf) {          \
+        leaf->next = tree->freeLeaves;                                         \
+        tree->freeLeaves = leaf;                                               \
+    }                                                                          \
+                                                                               \
+    static inline void name##FreeBranch(name *tree, name##Branch *branch) {    \
+        branch->children[0] = tree->freeBranches;                              \
+        tree->freeBranches = branch;                                           \
+    }                                                                          \
+                                                                               \
+    static inline name##Leaf *name##NewLeaf(name *tree) {                      \
+        name##Leaf *leaf = tree->freeLeaves;                                   \
+        if (leaf != NULL) {                                                    \
+            tree->freeLeaves = leaf->next;                                     \
+        }                                                                      \
+        else {                                                                 \
+            leaf = mallocArena(&tree->arena, sizeof(name##Leaf));              \
+            if (leaf == NULL) {                                                \
+                DEBUG_ERROR("BTree was unable to allocate a leaf");            \
+                return NULL;                                                   \
+            }                                                                  \
+        }                                                                      \
+        leaf->next = NULL;                                                     \
+        leaf->count = 0;                                                       \
+        return leaf;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline name##Branch *name##NewBranch(name *tree) {                  \
+        name##Branch *branch = tree->freeBranches;                             \
+        if (branch != NULL) {                                                  \
+            tree->freeBranches = (name##Branch *)branch->children[0];          \
+        }                                                                      \
+        else {                                                                 \
+            branch = mallocArena(&tree->arena, sizeof(name##Branch));          \
+            if (branch == NULL) {                                              \
+                DEBUG_ERROR("BTree was unable to allocate a branch");          \
+                return NULL;                                                   \
+            }                                                                  \
+        }                                                                      \
+        branch->count = 0;                                                     \
+        return branch;                                                         \
+    }                                                                          \
+                                                                               \
+    /* make sure the free lists hold enough nodes so a split can't fail */     \
+    /* half way through and leave the tree broken */                           \
+    static inline int name##Reserve(name *tree, size_t leaves,                 \
+                                    size_t branches) {                         \
+        size_t have = 0;                                                       \
+        for (name##Leaf *leaf = tree->freeLeaves;                              \
+             leaf != NULL && have < leaves; leaf = leaf->next) {               \
+            have++;                                                            \
+        }                                                                      \
+        for (; have < leaves; have++) {                                        \
+            name##Leaf *leaf = mallocArena(&tree->arena, sizeof(name##Leaf));  \
+            if (leaf == NULL) {                                                \
+                DEBUG_ERROR("BTree was unable to allocate a leaf");            \
+                return FAILEDALLOC;                                            \
+            }                                                                  \
+            name##FreeLeaf(tree, leaf);                                        \
+        }                                                                      \
+        have = 0;                                                              \
+        for (name##Branch *branch = tree->freeBranches;                        \
+             branch != NULL && have < branches;                                \
+             branch = (name##Branch *)branch->children[0]) {                   \
+            have++;                                                            \
+        }                                                                      \
+        for (; have < branches; have++) {                                      \
+            name##Branch *branch =                                             \
+                mallocArena(&tree->arena, sizeof(name##Branch));               \
+            if (branch == NULL) {                                              \
+                DEBUG_ERROR("BTree was unable to allocate a branch");          \
+                return FAILEDALLOC;                                            \
+            }                                                                  \
+            name##FreeBranch(tree, branch);                                    \
+        }                                                                      \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    /* first index whose key is not less than key */                           \
+    static inline uint32_t name##LeafLowerBound(const name##Leaf *leaf,        \
+                                                const keyType *key) {          \
+        uint32_t low = 0;                                                      \
+        uint32_t high = leaf->count;                                           \
+        while (low < high) {                                                   \
+            uint32_t middle = (low + high) / 2;                                \
+            if (lessThan(&leaf->keys[middle], key)) {                          \
+                low = middle + 1;                                              \
+            }                                                                  \
+            else {                                                             \
+                high = middle;                                                 \
+            }                                                                  \
+        }                                                                      \
+        return low;                                                            \
+    }                                                                          \
+                                                                               \
+    /* index of the child that could hold key */                               \
+    static inline uint32_t name##BranchChild(const name##Branch *branch,       \
+                                             const keyType *key) {             \
+        uint32_t low = 0;                                                      \
+        uint32_t high = branch->count;                                         \
+        while (low < high) {                                                   \
+            uint32_t middle = (low + high) / 2;                                \
+            if (lessThan(key, &branch->keys[middle])) {                        \
+                high = middle;                                                 \
+            }                                                                  \
+            else {                                                             \
+                low = middle + 1;                                              \
+            }                                                                  \
+        }                                                                      \
+        return low;                                                            \
+    }                                                                          \
+                                                                               \
+    static inline void name##LeafInsertAt(name##Leaf *leaf, uint32_t index,    \
+                                          const keyType *key,                  \
+                                          const valueType *value) {            \
+        memmove(&leaf->keys[index + 1], &leaf->keys[index],                    \
+                (leaf->count - index) * sizeof(keyType));                      \
+        memmove(&leaf->values[index + 1], &leaf->values[index],                \
+                (leaf->count - index) * sizeof(valueType));                    \
+        leaf->keys[index] = *key;                                              \
+        leaf->values[index] = *value;                                          \
+        leaf->count++;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline void name##LeafRemoveAt(name##Leaf *leaf, uint32_t index) {  \
+        memmove(&leaf->keys[index], &leaf->keys[index + 1],                    \
+                (leaf->count - index - 1) * sizeof(keyType));                  \
+        memmove(&leaf->values[index], &leaf->values[index + 1],                \
+                (leaf->count - index - 1) * sizeof(valueType));                \
+        leaf->count--;                                                         \
+    }                                                                          \
+                                                                               \
+    /* insert key at keys[index] and child at children[index + 1] */           \
+    static inline void name##BranchInsertAt(name##Branch *branch,              \
+                                            uint32_t index,                    \
+                                            const keyType *key, void *child) { \
+        memmove(&branch->keys[index + 1], &branch->keys[index],                \
+                (branch->count - index) * sizeof(keyType));                    \
+        memmove(&branch->children[index + 2], &branch->children[index + 1],    \
+                (branch->count - index) * sizeof(void *));                     \
+        branch->keys[index] = *key;                                            \
+        branch->children[index + 1] = child;                                   \
+        branch->count++;                                                       \
+    }                                                                          \
+                                                                               \
+    /* remove keys[index] and children[index + 1] */                           \
+    static inline void name##BranchRemoveAt(name##Branch *branch,              \
+                                            uint32_t index) {                  \
+        memmove(&branch->keys[index], &branch->keys[index + 1],                \
+                (branch->count - index - 1) * sizeof(keyType));                \
+        memmove(&branch->children[index + 1], &branch->children[index + 2],    \
+                (branch->count - index - 1) * sizeof(void *));                 \
+        branch->count--;                                                       \
+    }                                                                          \
+                                                                               \
+    static inline name##Leaf *name##FindLeaf(const name *tree,                 \
+                                             const keyType *key) {             \
+        void *node = tree->root;                                               \
+        for (uint32_t level = 1; level < tree->height; level++) {              \
+            name##Branch *branch = node;                                       \
+            node = branch->children[name##BranchChild(branch, key)];           \
+        }                                                                      \
+        return node;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline valueType *name##Find(name *tree, const keyType *key) {      \
+        if (tree->root == NULL) {                                              \
+            return NULL;                                                       \
+        }                                                                      \
+        name##Leaf *leaf = name##FindLeaf(tree, key);                          \
+        uint32_t index = name##LeafLowerBound(leaf, key);                      \
+        if (index < leaf->count && !lessThan(key, &leaf->keys[index])) {       \
+            return &leaf->values[index];                                       \
+        }                                                                      \
+        return NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline int name##IteratorValid(const name##Iterator *iterator) {    \
+        return iterator->leaf != NULL;                                         \
+    }                                                                          \
+                                                                               \
+    /* true while the iterator is valid and its key is less than end */        \
+    static inline int name##IteratorBefore(const name##Iterator *iterator,     \
+                                           const keyType *end) {               \
+        return iterator->leaf != NULL &&                                       \
+               lessThan(&iterator->leaf->keys[iterator->index], end);          \
+    }                                                                          \
+                                                                               \
+    static inline keyType *name##IteratorKey(const name##Iterator *iterator) { \
+        return &iterator->leaf->keys[iterator->index];                         \
+    }                                                                          \
+                                                                               \
+    static inline valueType *name##IteratorValue(                              \
+        const name##Iterator *iterator) {                                      \
+        return &iterator->leaf->values[iterator->index];                       \
+    }                                                                          \
+                                                                               \
+    static inline void name##IteratorNext(name##Iterator *iterator) {          \
+        if (iterator->leaf == NULL) {                                          \
+            return;                                                            \
+        }                                                                      \
+        iterator->index++;                                                     \
+        if (iterator->index >= iterator->leaf->count) {                        \
+            iterator->leaf = iterator->leaf->next;                             \
+            iterator->index = 0;                                               \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline name##Iterator name##Begin(name *tree) {                     \
+        name##Iterator iterator = {NULL, 0};                                   \
+        void *node = tree->root;                                               \
+        for (uint32_t level = 1; level < tree->height; level++) {              \
+            node = ((name##Branch *)node)->children[0];                        \
+        }                                                                      \
+        iterator.leaf = node;                                                  \
+        return iterator;                                                       \
+    }                                                                          \
+                                                                               \
+    /* iterator at the first key that is not less than key */                  \
+    static inline name##Iterator name##LowerBound(name *tree,                  \
+                                                  const keyType *key) {        \
+        name##Iterator iterator = {NULL, 0};                                   \
+        if (tree->root == NULL) {                                              \
+            return iterator;                                                   \
+        }                                                                      \
+        name##Leaf *leaf = name##FindLeaf(tree, key);                          \
+        uint32_t index = name##LeafLowerBound(leaf, key);                      \
+        if (index >= leaf->count) {                                            \
+            leaf = leaf->next;                                                 \
+            index = 0;                                                         \
+        }                                                                      \
+        iterator.leaf = leaf;                                                  \
+        iterator.index = index;                                                \
+        return iterator;                                                       \
+    }                                                                          \
+                                                                               \
+    /* add or replace the value for key */                                     \
+    static inline int name##Insert(name *tree, keyType key, valueType value) { \
+        if (tree->arena == NULL) {                                             \
+            DEBUG_ERROR("Insert was called on an uninitialized tree");         \
+            return UNINITARRAY;                                                \
+        }                                                                      \
+        if (tree->root == NULL) {                                              \
+            name##Leaf *leaf = name##NewLeaf(tree);                            \
+            if (leaf == NULL) {                                                \
+                return FAILEDALLOC;                                            \
+            }                                                                  \
+            name##LeafInsertAt(leaf, 0, &key, &value);                         \
+            tree->root = leaf;                                                 \
+            tree->height = 1;                                                  \
+            tree->size = 1;                                                    \
+            return OK;                                                         \
+        }                                                                      \
+        name##Branch *path[BTREE_MAX_HEIGHT];                                  \
+        uint32_t pathIndex[BTREE_MAX_HEIGHT];                                  \
+        void *node = tree->root;                                               \
+        uint32_t depth = 0;                                                    \
+        for (; depth + 1 < tree->height; depth++) {                            \
+            name##Branch *branch = node;                                       \
+            pathIndex[depth] = name##BranchChild(branch, &key);                \
+            path[depth] = branch;                                              \
+            node = branch->children[pathIndex[depth]];                         \
+        }                                                                      \
+        name##Leaf *leaf = node;                                               \
+        uint32_t index = name##LeafLowerBound(leaf, &key);                     \
+        if (index < leaf->count && !lessThan(&key, &leaf->keys[index])) {      \
+            leaf->values[index] = value;                                       \
+            return OK;                                                         \
+        }                                                                      \
+        if (leaf->count < name##LeafCapacity) {                                \
+            name##LeafInsertAt(leaf, index, &key, &value);                     \
+            tree->size++;                                                      \
+            return OK;                                                         \
+        }                                                                      \
+        /* every full branch above the leaf splits too and a new root is */    \
+        /* needed when the split reaches the top */                            \
+        size_t branchesNeeded = 0;                                             \
+        for (uint32_t level = depth;                                           \
+             level > 0 && path[level - 1]->count == name##BranchCapacity;      \
+             level--) {                                                        \
+            branchesNeeded++;                                                  \
+        }                                                                      \
+        if (branchesNeeded == depth) {                                         \
+            if (tree->height >= BTREE_MAX_HEIGHT) {                            \
+                DEBUG_ERROR("Insert would make the tree too tall");            \
+                return INVALIDARGS;                                            \
+            }                                                                  \
+            branchesNeeded++;                                                  \
+        }                                                                      \
+        int status = name##Reserve(tree, 1, branchesNeeded);                   \
+        if (status != OK) {                                                    \
+            return status;                                                     \
+        }                                                                      \
+        name##Leaf *right = name##NewLeaf(tree);                               \
+        uint32_t split = name##LeafCapacity / 2;                               \
+        right->count = name##LeafCapacity - split;                             \
+        memcpy(right->keys, &leaf->keys[split],                                \
+               right->count * sizeof(keyType));                                \
+        memcpy(right->values, &leaf->values[split],                            \
+               right->count * sizeof(valueType));                              \
+        leaf->count = split;                                                   \
+        if (index <= split) {                                                  \
+            name##LeafInsertAt(leaf, index, &key, &value);                     \
+        }                                                                      \
+        else {                                                                 \
+            name##LeafInsertAt(right, index - split, &key, &value);            \
+        }                                                                      \
+        right->next = leaf->next;                                              \
+        leaf->next = right;                                                    \
+        tree->size++;                                                          \
+                                                                               \
+        keyType separator = right->keys[0];                                    \
+        void *newChild = right;                                                \
+        while (depth > 0) {                                                    \
+            depth--;                                                           \
+            name##Branch *branch = path[depth];                                \
+            uint32_t child = pathIndex[depth];                                 \
+            if (branch->count < name##BranchCapacity) {                        \
+                name##BranchInsertAt(branch, child, &separator, newChild);     \
+                return OK;                                                     \
+            }                                                                  \
+            /* lay out all of the keys with the new one and cut them in */     \
+            /* half. The middle key moves up to the parent */                  \
+            keyType keys[name##BranchCapacity + 1];                            \
+            void *children[name##BranchCapacity + 2];                          \
+            memcpy(keys, branch->keys, child * sizeof(keyType));               \
+            keys[child] = separator;                                           \
+            memcpy(&keys[child + 1], &branch->keys[child],                     \
+                   (branch->count - child) * sizeof(keyType));                 \
+            memcpy(children, branch->children, (child + 1) * sizeof(void *));  \
+            children[child + 1] = newChild;                                    \
+            memcpy(&children[child + 2], &branch->children[child + 1],         \
+                   (branch->count - child) * sizeof(void *));                  \
+            uint32_t total = name##BranchCapacity + 1;                         \
+            uint32_t leftCount = total / 2;                                    \
+            name##Branch *sibling = name##NewBranch(tree);                     \
+            branch->count = leftCount;                                         \
+            memcpy(branch->keys, keys, leftCount * sizeof(keyType));           \
+            memcpy(branch->children, children,                                 \
+                   (leftCount + 1) * sizeof(void *));                          \
+            sibling->count = total - leftCount - 1;                            \
+            memcpy(sibling->keys, &keys[leftCount + 1],                        \
+                   sibling->count * sizeof(keyType));                          \
+            memcpy(sibling->children, &children[leftCount + 1],                \
+                   (sibling->count + 1) * sizeof(void *));                     \
+            separator = keys[leftCount];                                       \
+            newChild = sibling;                                                \
+        }                                                                      \
+        name##Branch *root = name##NewBranch(tree);                            \
+        root->count = 1;                                                       \
+        root->keys[0] = separator;                                             \
+        root->children[0] = tree->root;                                        \
+        root->children[1] = newChild;                                          \
+        tree->root = root;                                                     \
+        tree->height++;                                                        \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    /* rebalance a branch below the minimum by borrowing from or merging */    \
+    /* with a sibling. Returns 1 if the parent lost a key */                   \
+    static inline int name##FixBranch(name *tree, name##Branch *branch,        \
+                                      name##Branch *parent, uint32_t child) {  \
+        name##Branch *left =                                                   \
+            child > 0 ? (name##Branch *)parent->children[child - 1] : NULL;    \
+        name##Branch *right = NULL;                                            \
+        if (child < parent->count) {                                           \
+            right = parent->children[child + 1];                               \
+        }                                                                      \
+        if (left != NULL && left->count > name##BranchMinimum) {               \
+            memmove(&branch->keys[1], branch->keys,                            \
+                    branch->count * sizeof(keyType));                          \
+            memmove(&branch->children[1], branch->children,                    \
+                    (branch->count + 1) * sizeof(void *));                     \
+            branch->keys[0] = parent->keys[child - 1];                         \
+            branch->children[0] = left->children[left->count];                 \
+            parent->keys[child - 1] = left->keys[left->count - 1];             \
+            left->count--;                                                     \
+            branch->count++;                                                   \
+            return 0;                                                          \
+        }                                                                      \
+        if (right != NULL && right->count > name##BranchMinimum) {             \
+            branch->keys[branch->count] = parent->keys[child];                 \
+            branch->children[branch->count + 1] = right->children[0];          \
+            branch->count++;                                                   \
+            parent->keys[child] = right->keys[0];                              \
+            memmove(right->keys, &right->keys[1],                              \
+                    (right->count - 1) * sizeof(keyType));                     \
+            memmove(right->children, &right->children[1],                      \
+                    right->count * sizeof(void *));                            \
+            right->count--;                                                    \
+            return 0;                                                          \
+        }                                                                      \
+        /* merge the right one of the pair into the left one */                \
+        if (left == NULL) {                                                    \
+            left = branch;                                                     \
+            branch = right;                                                    \
+            child++;                                                           \
+        }                                                                      \
+        left->keys[left->count] = parent->keys[child - 1];                     \
+        memcpy(&left->keys[left->count + 1], branch->keys,                     \
+               branch->count * sizeof(keyType));                               \
+        memcpy(&left->children[left->count + 1], branch->children,             \
+               (branch->count + 1) * sizeof(void *));                          \
+        left->count += branch->count + 1;                                      \
+        name##FreeBranch(tree, branch);                                        \
+        name##BranchRemoveAt(parent, child - 1);                               \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    /* remove key from the tree. value gets the removed value if it isn't */   \
+    /* NULL. INVALIDARGS is returned when the key isn't in the tree */         \
+    static inline int name##Remove(name *tree, const keyType *key,             \
+                                   valueType *value) {                         \
+        if (tree->root == NULL) {                                              \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        name##Branch *path[BTREE_MAX_HEIGHT];                                  \
+        uint32_t pathIndex[BTREE_MAX_HEIGHT];                                  \
+        void *node = tree->root;                                               \
+        uint32_t depth = 0;                                                    \
+        for (; depth + 1 < tree->height; depth++) {                            \
+            name##Branch *branch = node;                                       \
+            pathIndex[depth] = name##BranchChild(branch, key);                 \
+            path[depth] = branch;                                              \
+            node = branch->children[pathIndex[depth]];                         \
+        }                                                                      \
+        name##Leaf *leaf = node;                                               \
+        uint32_t index = name##LeafLowerBound(leaf, key);                      \
+        if (index >= leaf->count || lessThan(key, &leaf->keys[index])) {       \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        if (value != NULL) {                                                   \
+            *value = leaf->values[index];                                      \
+        }                                                                      \
+        name##LeafRemoveAt(leaf, index);                                       \
+        tree->size--;                                                          \
+        if (depth == 0) {                                                      \
+            if (leaf->count == 0) {                                            \
+                name##FreeLeaf(tree, leaf);                                    \
+                tree->root = NULL;                                             \
+                tree->height = 0;                                              \
+            }                                                                  \
+            return OK;                                                         \
+        }                                                                      \
+        if (leaf->count >= name##LeafMinimum) {                                \
+            return OK;                                                         \
+        }                                                                      \
+        name##Branch *parent = path[depth - 1];                                \
+        uint32_t child = pathIndex[depth - 1];                                 \
+        name##Leaf *left =                                                     \
+            child > 0 ? (name##Leaf *)parent->children[child - 1] : NULL;      \
+        name##Leaf *right = child < parent->count                              \
+                                ? (name##Leaf *)parent->children[child + 1]    \
+                                : NULL;                                        \
+        if (left != NULL && left->count > name##LeafMinimum) {                 \
+            name##LeafInsertAt(leaf, 0, &left->keys[left->count - 1],          \
+                               &left->values[left->count - 1]);                \
+            left->count--;                                                     \
+            parent->keys[child - 1] = leaf->keys[0];                           \
+            return OK;                                                         \
+        }                                                                      \
+        if (right != NULL && right->count > name##LeafMinimum) {               \
+            leaf->keys[leaf->count] = right->keys[0];                          \
+            leaf->values[leaf->count] = right->values[0];                      \
+            leaf->count++;                                                     \
+            name##LeafRemoveAt(right, 0);                                      \
+            parent->keys[child] = right->keys[0];                              \
+            return OK;                                                         \
+        }                                                                      \
+        /* merge the right one of the pair into the left one */                \
+        if (left == NULL) {                                                    \
+            left = leaf;                                                       \
+            leaf = right;                                                      \
+            child++;                                                           \
+        }                                                                      \
+        memcpy(&left->keys[left->count], leaf->keys,                           \
+               leaf->count * sizeof(keyType));                                 \
+        memcpy(&left->values[left->count], leaf->values,                       \
+               leaf->count * sizeof(valueType));                               \
+        left->count += leaf->count;                                            \
+        left->next = leaf->next;                                               \
+        name##FreeLeaf(tree, leaf);                                            \
+        name##BranchRemoveAt(parent, child - 1);                               \
+                                                                               \
+        /* walk back up fixing any branch that dropped below the minimum */    \
+        uint32_t level = depth - 1;                                            \
+        while (level > 0 && path[level]->count < name##BranchMinimum) {        \
+            if (!name##FixBranch(tree, path[level], path[level - 1],           \
+                                 pathIndex[level - 1])) {                      \
+                break;                                                         \
+            }                                                                  \
+            level--;                                                           \
+        }                                                                      \
+        name##Branch *root = tree->root;                                       \
+        if (root->count == 0) {                                                \
+            tree->root = root->children[0];                                    \
+            tree->height--;                                                    \
+            name##FreeBranch(tree, root);                                      \
+        }                                                                      \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    static void name##ClearNode(name *tree, void *node, uint32_t level) {      \
+        if (level + 1 == tree->height) {                                       \
+            name##FreeLeaf(tree, node);                                        \
+            return;                                                            \
+        }                                                                      \
+        name##Branch *branch = node;                                           \
+        for (uint32_t i = 0; i <= branch->count; i++) {                        \
+            name##ClearNode(tree, branch->children[i], level + 1);             \
+        }                                                                      \
+        name##FreeBranch(tree, branch);                                        \
+    }                                                                          \
+                                                                               \
+    /* count the nodes under node that a Clear would put on the free lists */  \
+    static void name##CountNodes(const name *tree, void *node, uint32_t level, \
+                                 size_t *leaves, size_t *branches) {           \
+        if (level + 1 == tree->height) {                                       \
+            (*leaves)++;                                                       \
+            return;                                                            \
+        }                                                                      \
+        name##Branch *branch = node;                                           \
+        for (uint32_t i = 0; i <= branch->count; i++) {                        \
+            name##CountNodes(tree, branch->children[i], level + 1, leaves,     \
+                             branches);                                        \
+        }                                                                      \
+        (*branches)++;                                                         \
+    }                                                                          \
+                                                                               \
+    /* empty the tree. The nodes are kept for reuse */                         \
+    static inline void name##Clear(name *tree) {                               \
+        if (tree->root != NULL) {                                              \
+            name##ClearNode(tree, tree->root, 0);                              \
+        }                                                                      \
+        tree->root = NULL;                                                     \
+        tree->height = 0;                                                      \
+        tree->size = 0;                                                        \
+    }                                                                          \
+                                                                               \
+    /* replace the contents with count sorted keys. The keys must be */        \
+    /* strictly increasing. The nodes are built bottom up and packed */        \
+    /* evenly so this is much faster than inserting one at a time */           \
+    static inline int name##BulkLoad(name *tree, const keyType *keys,          \
+                                     const valueType *values, size_t count) {  \
+        if (tree->arena == NULL || (count != 0 && (keys == NULL ||             \
+                                                   values == NULL))) {         \
+            DEBUG_ERROR("BulkLoad was called with a null pointer");            \
+            return NULLPOINTER;                                                \
+        }                                                                      \
+        for (size_t i = 1; i < count; i++) {                                   \
+            if (!lessThan(&keys[i - 1], &keys[i])) {                           \
+                DEBUG_ERROR("BulkLoad was called with unsorted keys");         \
+                return INVALIDARGS;                                            \
+            }                                                                  \
+        }                                                                      \
+        if (count == 0) {                                                      \
+            name##Clear(tree);                                                 \
+            return OK;                                                         \
+        }                                                                      \
+        size_t leafCount =                                                     \
+            (count + name##LeafCapacity - 1) / name##LeafCapacity;             \
+        size_t branchCount = 0;                                                \
+        for (size_t nodes = leafCount; nodes > 1;) {                           \
+            nodes = (nodes + name##BranchCapacity) /                           \
+                    (name##BranchCapacity + 1);                                \
+            branchCount += nodes;                                              \
+        }                                                                      \
+        /* everything that can fail happens before the old tree is cleared */  \
+        /* so a failure leaves it as it was. Its nodes count towards what */   \
+        /* has to be reserved since the clear gives them back */               \
+        size_t oldLeaves = 0;                                                  \
+        size_t oldBranches = 0;                                                \
+        if (tree->root != NULL) {                                              \
+            name##CountNodes(tree, tree->root, 0, &oldLeaves, &oldBranches);   \
+        }                                                                      \
+        int status = name##Reserve(                                            \
+            tree, leafCount > oldLeaves ? leafCount - oldLeaves : 0,           \
+            branchCount > oldBranches ? branchCount - oldBranches : 0);        \
+        if (status != OK) {                                                    \
+            return status;                                                     \
+        }                                                                      \
+        /* every level is built from the list of nodes below it and the */     \
+        /* smallest key under each of those nodes */                           \
+        tree->arena = getLastArenaNode(tree->arena);                           \
+        void *restorePoint = startScratchPad(tree->arena);                     \
+        void **level = mallocArena(&tree->arena, leafCount * sizeof(void *));  \
+        const keyType **lowest =                                               \
+            mallocArena(&tree->arena, leafCount * sizeof(keyType *));          \
+        if (level == NULL || lowest == NULL) {                                 \
+            DEBUG_ERROR("BulkLoad was unable to get scratch memory");          \
+            restoreSratchPad(&tree->arena, restorePoint);                      \
+            return FAILEDALLOC;                                                \
+        }                                                                      \
+        name##Clear(tree);                                                     \
+        size_t offset = 0;                                                     \
+        name##Leaf *previous = NULL;                                           \
+        for (size_t i = 0; i < leafCount; i++) {                               \
+            name##Leaf *leaf = name##NewLeaf(tree);                            \
+            leaf->count =                                                      \
+                (uint32_t)((count / leafCount) + (i < count % leafCount));     \
+            memcpy(leaf->keys, &keys[offset], leaf->count * sizeof(keyType));  \
+            memcpy(leaf->values, &values[offset],                              \
+                   leaf->count * sizeof(valueType));                           \
+            offset += leaf->count;                                             \
+            if (previous != NULL) {                                            \
+                previous->next = leaf;                                         \
+            }                                                                  \
+            previous = leaf;                                                   \
+            level[i] = leaf;                                                   \
+            lowest[i] = &leaf->keys[0];                                        \
+        }                                                                      \
+        size_t nodes = leafCount;                                              \
+        uint32_t height = 1;                                                   \
+        while (nodes > 1) {                                                    \
+            size_t parents = (nodes + name##BranchCapacity) /                  \
+                             (name##BranchCapacity + 1);                       \
+            size_t next = 0;                                                   \
+            for (size_t i = 0; i < parents; i++) {                             \
+                size_t childCount = (nodes / parents) + (i < nodes % parents); \
+                name##Branch *branch = name##NewBranch(tree);                  \
+                branch->count = (uint32_t)childCount - 1;                      \
+                for (size_t j = 0; j < childCount; j++) {                      \
+                    branch->children[j] = level[next + j];                     \
+                    if (j > 0) {                                               \
+                        branch->keys[j - 1] = *lowest[next + j];               \
+                    }                                                          \
+                }                                                              \
+                lowest[i] = lowest[next];                                      \
+                level[i] = branch;                                             \
+                next += childCount;                                            \
+            }                                                                  \
+            nodes = parents;                                                   \
+            height++;                                                          \
+        }                                                                      \
+        tree->root = level[0];                                                 \
+        tree->height = height;                                                 \
+        tree->size = count;                                                    \
+        if (restoreSratchPad(&tree->arena, restorePoint) != 0) {               \
+            return FAILEDALLOC;                                                \
+        }                                                                      \
+        return OK;                                                             \
+    }
+#endif
@@ -0,0 +1,144 @@
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include "arena.h" // NOLINT
+#include "array.h" // NOLINT
+#include "debug.h"
+#include <stddef.h>
+#include <string.h>
+
+#define DEQUE_MIN_CAPACITY 8
+
+// Double ended queue that grows instead of eating its oldest items like
+// BUFFER. The items live in an arena array with a power of two capacity and
+// head is the slot of the front item, so item i is at (head + i) & mask.
+//
+// Growing doubles the array with REALLOC_ARRAY, which keeps the old slots where
+// they were. Then the items that had wrapped around to the front of the old
+// block are copied to just past its end so they follow the rest in order
+// again. Only the wrapped part is copied and head never moves. Like the other
+// arena containers the old block isn't given back until the arena is freed.
+#define DEQUE(type)                                                            \
+    struct {                                                                   \
+        ARRAY(type) array;                                                     \
+        size_t head;                                                           \
+    }
+
+#define NEW_DEQUE() {NEW_ARRAY(), 0}
+
+#define INIT_DEQUE(deque, arena, status)                                       \
+    do {                                                                       \
+        INIT_ARRAY((deque).array, arena, status);                              \
+        (deque).head = 0;                                                      \
+    } while (0)
+
+#define DEQUE_SIZE(deque) ((deque).array.size)
+#define DEQUE_CAPACITY(deque) ((deque).array.alloc)
+
+// pointer to the index'th item from the front. index has to be less than the
+// size
+#define GET_DEQUE_ITEM(deque, index)                                           \
+    (&(deque).array                                                            \
+          .items[((deque).head + (index)) & ((deque).array.alloc - 1)])
+
+// make room for at least count items
+#define RESERVE_DEQUE(deque, count, status)                                    \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED((deque).array)) {                               \
+            DEBUG_ERROR("called RESERVE_DEQUE with an unintialized deque");    \
+            (status) = UNINITARRAY;                                            \
+            break;                                                             \
+        }                                                                      \
+        (status) = OK;                                                         \
+        size_t dequeOldCapacity = (deque).array.alloc;                         \
+        if ((count) <= dequeOldCapacity) {                                     \
+            break;                                                             \
+        }                                                                      \
+        size_t dequeCapacity = nextPowerOfTwo(count);                          \
+        if (dequeCapacity < DEQUE_MIN_CAPACITY) {                              \
+            dequeCapacity = DEQUE_MIN_CAPACITY;                                \
+        }                                                                      \
+        REALLOC_ARRAY((deque).array, dequeCapacity, status);                   \
+        if ((status) != OK) {                                                  \
+            break;                                                             \
+        }                                                                      \
+        /* unwrap the items that ran past the end of the old block */          \
+        size_t dequeEnd = (deque).head + (deque).array.size;                   \
+        if (dequeEnd > dequeOldCapacity) {                                     \
+            memcpy((deque).array.items + dequeOldCapacity,                     \
+                   (deque).array.items,                                        \
+                   (dequeEnd - dequeOldCapacity) *                             \
+                       sizeof(*(deque).array.items));                          \
+        }                                                                      \
+    } while (0)
+
+#define PUSH_BACK_DEQUE(deque, item, status)                                   \
+    do {                                                                       \
+        RESERVE_DEQUE(deque, (deque).array.size + 1, status);                  \
+        if ((status) != OK) {                                                  \
+            break;                                                             \
+        }                                                                      \
+        *GET_DEQUE_ITEM(deque, (deque).array.size) = item;                     \
+        (deque).array.size++;                                                  \
+    } while (0)
+
+#define PUSH_FRONT_DEQUE(deque, item, status)                                  \
+    do {                                                                       \
+        RESERVE_DEQUE(deque, (deque).array.size + 1, status);                  \
+        if ((status) != OK) {                                                  \
+            break;                                                             \
+        }                                                                      \
+        (deque).head = ((deque).head - 1) & ((deque).array.alloc - 1);         \
+        (deque).array.items[(deque).head] = item;                              \
+        (deque).array.size++;                                                  \
+    } while (0)
+
+// status is BUFFEREMPTY if there was nothing to pop. The slot is left as is
+#define POP_BACK_DEQUE(deque, item, status)                                    \
+    do {                                                                       \
+        if ((deque).array.size == 0) {                                         \
+            (status) = BUFFEREMPTY;                                            \
+            break;                                                             \
+        }                                                                      \
+        (deque).array.size--;                                                  \
+        (item) = *GET_DEQUE_ITEM(deque, (deque).array.size);                   \
+        (status) = OK;                                                         \
+    } while (0)
+
+#define POP_FRONT_DEQUE(deque, item, status)                                   \
+    do {                                                                       \
+        if ((deque).array.size == 0) {                                         \
+            (status) = BUFFEREMPTY;                                            \
+            break;                                                             \
+        }                                                                      \
+        (item) = (deque).array.items[(deque).head];                            \
+        (deque).head = ((deque).head + 1) & ((deque).array.alloc - 1);         \
+        (deque).array.size--;                                                  \
+        (status) = OK;                                                         \
+    } while (0)
+
+// throw away the item at either end without reading it. Does nothing when the
+// deque is empty
+#define DROP_BACK_DEQUE(deque)                                                 \
+    do {                                                                       \
+        if ((deque).array.size != 0) {                                         \
+            (deque).array.size--;                                              \
+        }                                                                      \
+    } while (0)
+
+#define DROP_FRONT_DEQUE(deque)                                                \
+    do {                                                                       \
+        if ((deque).array.size != 0) {                                         \
+            (deque).head = ((deque).head + 1) & ((deque).array.alloc - 1);     \
+            (deque).array.size--;                                              \
+        }                                                                      \
+    } while (0)
+
+// keeps the memory for reuse
+#define CLEAR_DEQUE(deque)                                                     \
+    do {                                                                       \
+        (deque).array.size = 0;                                                \
+        (deque).head = 0;                                                      \
+    } while (0)
+
+#endif
@@ -0,0 +1,119 @@
+#include "file.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "string.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct StringReturn mapFile(const char *path, struct Arena *arena) {
+    struct StringReturn returnValue = {NEW_ARRAY(), OK};
+    if (path == NULL || arena == NULL) {
+        DEBUG_ERROR("`mapFile` was called with a null pointer");
+        returnValue.status = NULLPOINTER;
+        return returnValue;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        DEBUG_ERROR("`mapFile` was unable to open the file");
+        returnValue.status = INVALIDARGS;
+        return returnValue;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        DEBUG_ERROR("`mapFile` can only map regular files");
+        close(fd);
+        returnValue.status = INVALIDARGS;
+        return returnValue;
+    }
+    size_t size = (size_t)info.st_size;
+    returnValue.string.arena = arena;
+    // mmap can't map zero bytes
+    if (size == 0) {
+        close(fd);
+        return returnValue;
+    }
+    char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file alive
+    close(fd);
+    if (data == MAP_FAILED) {
+        DEBUG_ERROR("`mapFile` was unable to map the file");
+        returnValue.status = FAILEDALLOC;
+        return returnValue;
+    }
+    // only a hint so it failing doesn't matter
+    madvise(data, size, MADV_SEQUENTIAL);
+    returnValue.string.items = data;
+    returnValue.string.size = size;
+    returnValue.string.alloc = size;
+    return returnValue;
+}
+
+void unmapFile(String *file) {
+    if (file == NULL) {
+        DEBUG_ERROR("`unmapFile` was called with a null pointer");
+        return;
+    }
+    if (file->items != NULL && file->alloc != 0) {
+        munmap(file->items, file->alloc);
+    }
+    file->items = NULL;
+    file->size = 0;
+    file->alloc = 0;
+}
+
+void initRecordIterator(struct LineIterator *iterator, const String *string,
+                        char delimiter) {
+    if (iterator == NULL || string == NULL) {
+        DEBUG_ERROR("`initRecordIterator` was called with a null pointer");
+        return;
+    }
+    iterator->rest = *string;
+    iterator->delimiter = delimiter;
+}
+
+void initLineIterator(struct LineIterator *iterator, const String *string) {
+    initRecordIterator(iterator, string, '\n');
+}
+
+int nextLine(struct LineIterator *iterator, String *line) {
+    if (iterator == NULL || line == NULL) {
+        DEBUG_ERROR("`nextLine` was called with a null pointer");
+        return 0;
+    }
+    String *rest = &iterator->rest;
+    if (rest->size == 0) {
+        return 0;
+    }
+    size_t index = findChar(rest, iterator->delimiter);
+    if (index == ARRAY_NOT_FOUND) {
+        *line = *rest;
+        *rest = sliceString(rest, rest->size, 0);
+    }
+    else {
+        *line = sliceString(rest, 0, index);
+        *rest = sliceString(rest, index + 1, rest->size - index - 1);
+    }
+    if (iterator->delimiter == '\n' && line->size != 0 &&
+        line->items[line->size - 1] == '\r') {
+        line->size--;
+        line->alloc--;
+    }
+    return 1;
+}
+
+size_t countLines(const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("`countLines` was called with a null pointer");
+        return 0;
+    }
+    if (string->size == 0) {
+        return 0;
+    }
+    String lines = *string;
+    size_t count = countChar(&lines, '\n');
+    return count + (string->items[string->size - 1] != '\n');
+}
@@ -0,0 +1,37 @@
+#ifndef FILE_H
+#define FILE_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <stddef.h>
+
+// Map a whole file read only and hand it back as a String view, so the bytes
+// go from the page cache to the caller without being copied. The pages are
+// hinted as sequential so the kernel reads ahead. The view's arena is set so
+// it can be used with the other String functions, but the pages are their own
+// mapping and have to be given back with unmapFile. Don't append to the view.
+// An empty file gives an empty string with no mapping.
+struct StringReturn mapFile(const char *path, struct Arena *arena);
+
+// unmap the pages of a string from mapFile and reset it to an empty string
+void unmapFile(String *file);
+
+// Walks the records in a string split on a delimiter, a line at a time by
+// default. The search for the delimiter is the SIMD findChar. A delimiter at
+// the very end doesn't make an empty record after it, and for lines a \r
+// before the \n is dropped so CRLF files give the same lines.
+struct LineIterator {
+    String rest;
+    char delimiter;
+};
+
+void initLineIterator(struct LineIterator *iterator, const String *string);
+void initRecordIterator(struct LineIterator *iterator, const String *string,
+                        char delimiter);
+// puts the next record in line. Returns 0 once there are none left
+int nextLine(struct LineIterator *iterator, String *line);
+
+// the number of records nextLine would give for '\n'
+size_t countLines(const String *string);
+#endif
@@ -0,0 +1,202 @@
+#include "hash.h"
+#include "debug.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const uint64_t hashSecret[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+    0x4d5a2da51de1aa47ULL};
+
+static inline void multiply(uint64_t *low, uint64_t *high) {
+    __uint128_t product = (__uint128_t)*low * *high;
+    *low = (uint64_t)product;
+    *high = (uint64_t)(product >> 64);
+}
+
+static inline uint64_t mix(uint64_t first, uint64_t second) {
+    multiply(&first, &second);
+    return first ^ second;
+}
+
+// little endian reads. memcpy so unaligned keys are fine
+static inline uint64_t read64(const uint8_t *bytes) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static inline uint64_t read32(const uint8_t *bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static inline uint64_t startSeed(uint64_t seed) {
+    return seed ^ mix(seed ^ hashSecret[0], hashSecret[1]);
+}
+
+// keys of 16 bytes or less are read as two possibly overlapping words
+static inline void readShort(const uint8_t *bytes, size_t size, uint64_t *a,
+                             uint64_t *b) {
+    if (size >= 4) {
+        size_t middle = (size >> 3) << 2;
+        *a = (read32(bytes) << 32) | read32(bytes + middle);
+        *b = (read32(bytes + size - 4) << 32) |
+             read32(bytes + size - 4 - middle);
+    }
+    else if (size > 0) {
+        *a = ((uint64_t)bytes[0] << 16) | ((uint64_t)bytes[size >> 1] << 8) |
+             bytes[size - 1];
+        *b = 0;
+    }
+    else {
+        *a = 0;
+        *b = 0;
+    }
+}
+
+static inline void hashBlock(const uint8_t *bytes, uint64_t *seed,
+                             uint64_t *see1, uint64_t *see2) {
+    *seed = mix(read64(bytes) ^ hashSecret[1], read64(bytes + 8) ^ *seed);
+    *see1 = mix(read64(bytes + 16) ^ hashSecret[2], read64(bytes + 24) ^ *see1);
+    *see2 = mix(read64(bytes + 32) ^ hashSecret[3], read64(bytes + 40) ^ *see2);
+}
+
+// bytes points at the last remaining < 48 bytes and the 16 bytes before it
+// have to be readable when the whole key is longer than 16
+static inline uint64_t finishHash(const uint8_t *bytes, size_t remaining,
+                                  uint64_t seed, uint64_t size) {
+    while (remaining > 16) {
+        seed = mix(read64(bytes) ^ hashSecret[1], read64(bytes + 8) ^ seed);
+        bytes += 16;
+        remaining -= 16;
+    }
+    uint64_t a = read64(bytes + remaining - 16) ^ hashSecret[1];
+    uint64_t b = read64(bytes + remaining - 8) ^ seed;
+    multiply(&a, &b);
+    return mix(a ^ hashSecret[0] ^ size, b ^ hashSecret[1]);
+}
+
+static inline uint64_t finishShort(const uint8_t *bytes, size_t size,
+                                   uint64_t seed) {
+    uint64_t a = 0;
+    uint64_t b = 0;
+    readShort(bytes, size, &a, &b);
+    a ^= hashSecret[1];
+    b ^= seed;
+    multiply(&a, &b);
+    return mix(a ^ hashSecret[0] ^ size, b ^ hashSecret[1]);
+}
+
+uint64_t hashBytesSeeded(const void *bytes, size_t size, uint64_t seed) {
+    if (bytes == NULL && size != 0) {
+        DEBUG_ERROR("`hashBytesSeeded` was called with a null pointer");
+        return 0;
+    }
+    const uint8_t *position = bytes;
+    seed = startSeed(seed);
+    if (size <= 16) {
+        return finishShort(position, size, seed);
+    }
+    size_t remaining = size;
+    if (remaining >= 48) {
+        uint64_t see1 = seed;
+        uint64_t see2 = seed;
+        do {
+            hashBlock(position, &seed, &see1, &see2);
+            position += 48;
+            remaining -= 48;
+        } while (remaining >= 48);
+        seed ^= see1 ^ see2;
+    }
+    return finishHash(position, remaining, seed, size);
+}
+
+uint64_t hashBytes(const void *bytes, size_t size) {
+    return hashBytesSeeded(bytes, size, HASH_DEFAULT_SEED);
+}
+
+uint64_t hashStringSeeded(const String *string, uint64_t seed) {
+    if (string == NULL) {
+        DEBUG_ERROR("`hashStringSeeded` was called with a null pointer");
+        return 0;
+    }
+    return hashBytesSeeded(string->items, string->size, seed);
+}
+
+uint64_t hashString(const String *string) {
+    return hashStringSeeded(string, HASH_DEFAULT_SEED);
+}
+
+void initHashState(struct HashState *state, uint64_t seed) {
+    if (state == NULL) {
+        DEBUG_ERROR("`initHashState` was called with a null pointer");
+        return;
+    }
+    memset(state, 0, sizeof(*state));
+    state->seed = startSeed(seed);
+    state->see1 = state->seed;
+    state->see2 = state->seed;
+}
+
+void updateHashState(struct HashState *state, const void *bytes, size_t size) {
+    if (state == NULL || (bytes == NULL && size != 0)) {
+        DEBUG_ERROR("`updateHashState` was called with a null pointer");
+        return;
+    }
+    const uint8_t *position = bytes;
+    state->size += size;
+    // top up a partial block first
+    if (state->buffered != 0) {
+        size_t take = sizeof(state->buffer) - state->buffered;
+        take = take < size ? take : size;
+        memcpy(state->buffer + state->buffered, position, take);
+        state->buffered += take;
+        position += take;
+        size -= take;
+        if (state->buffered < sizeof(state->buffer)) {
+            return;
+        }
+        hashBlock(state->buffer, &state->seed, &state->see1, &state->see2);
+        memcpy(state->previous, state->buffer + 32, 16);
+        state->buffered = 0;
+    }
+    // then whole blocks straight from the input
+    if (size >= 48) {
+        while (size >= 48) {
+            hashBlock(position, &state->seed, &state->see1, &state->see2);
+            position += 48;
+            size -= 48;
+        }
+        memcpy(state->previous, position - 16, 16);
+    }
+    memcpy(state->buffer, position, size);
+    state->buffered = size;
+}
+
+uint64_t finishHashState(const struct HashState *state) {
+    if (state == NULL) {
+        DEBUG_ERROR("`finishHashState` was called with a null pointer");
+        return 0;
+    }
+    if (state->size <= 16) {
+        return finishShort(state->buffer, state->buffered, state->seed);
+    }
+    uint64_t seed = state->seed;
+    if (state->size >= 48) {
+        seed ^= state->see1 ^ state->see2;
+    }
+    // put the end of the last block back in front of the buffered bytes so
+    // the final read can reach back into it
+    uint8_t tail[16 + sizeof(state->buffer)];
+    memcpy(tail, state->previous, 16);
+    memcpy(tail + 16, state->buffer, state->buffered);
+    return finishHash(tail + 16, state->buffered, seed, state->size);
+}
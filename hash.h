@@ -0,0 +1,39 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// 64 bit non-cryptographic hashing based on wyhash. Short keys are a couple of
+// 64x64->128 multiplies and long keys run three independent multiply chains
+// over 48 byte blocks, which keeps the multiplier busy instead of waiting on
+// one long dependency chain. Don't use this for anything where someone could
+// pick the keys to collide on purpose unless the seed is random.
+
+#define HASH_DEFAULT_SEED 0
+
+uint64_t hashBytes(const void *bytes, size_t size);
+uint64_t hashBytesSeeded(const void *bytes, size_t size, uint64_t seed);
+uint64_t hashString(const String *string);
+uint64_t hashStringSeeded(const String *string, uint64_t seed);
+
+// Streaming form for keys that are not in one piece, like the two spans from
+// BUFFER_READ_SPANS. Feeding the same bytes in any number of pieces gives the
+// same hash as hashBytesSeeded on all of them at once.
+struct HashState {
+    uint64_t seed;
+    uint64_t see1;
+    uint64_t see2;
+    uint64_t size;
+    // the end of the last full block. The final mix can read back into it
+    uint8_t previous[16];
+    uint8_t buffer[48];
+    size_t buffered;
+};
+
+void initHashState(struct HashState *state, uint64_t seed);
+void updateHashState(struct HashState *state, const void *bytes, size_t size);
+// the hash of everything so far. The state can keep being updated after this
+uint64_t finishHashState(const struct HashState *state);
+#endif
@@ -0,0 +1,288 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// position of a handle that has been popped
+#define HEAP_NO_POSITION UINT32_MAX
+
+// Creates a priority queue type called `name` that holds `type` items on arena
+// backed arrays. The item for which lessThan is true against every other item
+// is at the top, so a `<` compare makes a min heap. lessThan is called with
+// two `const type *` and can be a macro. arity is the number of children per
+// node. 2 is a plain binary heap and 4 keeps the children of a node on the
+// same cache line for small items.
+//
+// Every push hands back a handle that stays valid until the item is popped.
+// The handle can be used to change the priority of the item in place.
+//
+//   int name##Init(name *heap, struct Arena *arena)
+//   size_t name##Size(const name *heap)
+//   type *name##Peek(name *heap)
+//   int name##Push(name *heap, type item, uint32_t *handle)
+//   int name##Pop(name *heap, type *item)
+//   int name##Heapify(name *heap, const type *items, size_t count)
+//   int name##DecreaseKey(name *heap, uint32_t handle, type item)
+//   type *name##Get(name *heap, uint32_t handle)
+#define HEAP_DEFINE(type, name, lessThan, arity)                               \
+    typedef struct {                                                           \
+        /* items in heap order */                                              \
+        ARRAY(type) items;                                                     \
+        /* heap position -> handle */                                          \
+        ARRAY(uint32_t) handles;                                               \
+        /* handle -> heap position */                                          \
+        ARRAY(uint32_t) positions;                                             \
+        /* handles that can be given out again */                              \
+        ARRAY(uint32_t) freeHandles;                                           \
+    } name;                                                                    \
+                                                                               \
+    static inline int name##Init(name *heap, struct Arena *arena) {            \
+        int status = 0;                                                        \
+        INIT_ARRAY(heap->items, arena, status);                                \
+        if (status != OK) {                                                    \
+            return status;                                                     \
+        }                                                                      \
+        INIT_ARRAY(heap->handles, arena, status);                              \
+        INIT_ARRAY(heap->positions, arena, status);                            \
+        INIT_ARRAY(heap->freeHandles, arena, status);                          \
+        return status;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline size_t name##Size(const name *heap) {                        \
+        return heap->items.size;                                               \
+    }                                                                          \
+                                                                               \
+    static inline type *name##Peek(name *heap) {                               \
+        return heap->items.size == 0 ? NULL : &heap->items.items[0];           \
+    }                                                                          \
+                                                                               \
+    static inline type *name##Get(name *heap, uint32_t handle) {               \
+        if (handle >= heap->positions.size ||                                  \
+            heap->positions.items[handle] == HEAP_NO_POSITION) {               \
+            return NULL;                                                       \
+        }                                                                      \
+        return &heap->items.items[heap->positions.items[handle]];              \
+    }                                                                          \
+                                                                               \
+    /* move the item at position up until its parent is not greater */         \
+    static inline void name##SiftUp(name *heap, size_t position) {             \
+        type item = heap->items.items[position];                               \
+        uint32_t handle = heap->handles.items[position];                       \
+        while (position > 0) {                                                 \
+            size_t parent = (position - 1) / (arity);                          \
+            if (!lessThan(&item, &heap->items.items[parent])) {                \
+                break;                                                         \
+            }                                                                  \
+            heap->items.items[position] = heap->items.items[parent];           \
+            heap->handles.items[position] = heap->handles.items[parent];       \
+            heap->positions.items[heap->handles.items[position]] =             \
+                (uint32_t)position;                                            \
+            position = parent;                                                 \
+        }                                                                      \
+        heap->items.items[position] = item;                                    \
+        heap->handles.items[position] = handle;                                \
+        heap->positions.items[handle] = (uint32_t)position;                    \
+    }                                                                          \
+                                                                               \
+    /* move the item at position down until no child is smaller */             \
+    static inline void name##SiftDown(name *heap, size_t position) {           \
+        size_t size = heap->items.size;                                        \
+        type item = heap->items.items[position];                               \
+        uint32_t handle = heap->handles.items[position];                       \
+        for (;;) {                                                             \
+            size_t firstChild = (position * (arity)) + 1;                      \
+            if (firstChild >= size) {                                          \
+                break;                                                         \
+            }                                                                  \
+            size_t lastChild = firstChild + (arity);                           \
+            lastChild = lastChild < size ? lastChild : size;                   \
+            size_t smallest = firstChild;                                      \
+            for (size_t child = firstChild + 1; child < lastChild; child++) {  \
+                if (lessThan(&heap->items.items[child],                        \
+                             &heap->items.items[smallest])) {                  \
+                    smallest = child;                                          \
+                }                                                              \
+            }                                                                  \
+            if (!lessThan(&heap->items.items[smallest], &item)) {              \
+                break;                                                         \
+            }                                                                  \
+            heap->items.items[position] = heap->items.items[smallest];         \
+            heap->handles.items[position] = heap->handles.items[smallest];     \
+            heap->positions.items[heap->handles.items[position]] =             \
+                (uint32_t)position;                                            \
+            position = smallest;                                               \
+        }                                                                      \
+        heap->items.items[position] = item;                                    \
+        heap->handles.items[position] = handle;                                \
+        heap->positions.items[handle] = (uint32_t)position;                    \
+    }                                                                          \
+                                                                               \
+    static inline int name##NewHandle(name *heap, uint32_t *handle) {          \
+        int status = 0;                                                        \
+        if (heap->freeHandles.size != 0) {                                     \
+            heap->freeHandles.size--;                                          \
+            *handle = heap->freeHandles.items[heap->freeHandles.size];         \
+            return OK;                                                         \
+        }                                                                      \
+        if (heap->positions.size >= HEAP_NO_POSITION) {                        \
+            DEBUG_ERROR("The heap is out of handles");                         \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        *handle = (uint32_t)heap->positions.size;                              \
+        PUSH_ARRAY(heap->positions, HEAP_NO_POSITION, status);                 \
+        return status;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline int name##Push(name *heap, type item, uint32_t *handle) {    \
+        if (!ARRAY_INITIALIZED(heap->items)) {                                 \
+            DEBUG_ERROR("Push was called on an uninitialized heap");           \
+            return UNINITARRAY;                                                \
+        }                                                                      \
+        /* putting these sizes back gives the handle back on failure */        \
+        size_t freeCount = heap->freeHandles.size;                             \
+        size_t positionCount = heap->positions.size;                           \
+        uint32_t newHandle = 0;                                                \
+        int status = name##NewHandle(heap, &newHandle);                        \
+        if (status != OK) {                                                    \
+            return status;                                                     \
+        }                                                                      \
+        PUSH_ARRAY(heap->items, item, status);                                 \
+        if (status == OK) {                                                    \
+            PUSH_ARRAY(heap->handles, newHandle, status);                      \
+            if (status != OK) {                                                \
+                heap->items.size--;                                            \
+            }                                                                  \
+        }                                                                      \
+        if (status != OK) {                                                    \
+            heap->freeHandles.size = freeCount;                                \
+            heap->positions.size = positionCount;                              \
+            return status;                                                     \
+        }                                                                      \
+        name##SiftUp(heap, heap->items.size - 1);                              \
+        if (handle != NULL) {                                                  \
+            *handle = newHandle;                                               \
+        }                                                                      \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    /* INVALIDARGS is returned when the heap is empty */                       \
+    static inline int name##Pop(name *heap, type *item) {                      \
+        if (heap->items.size == 0) {                                           \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        int status = 0;                                                        \
+        uint32_t handle = heap->handles.items[0];                              \
+        /* keep the handle first so a failure leaves the heap as it was */     \
+        PUSH_ARRAY(heap->freeHandles, handle, status);                         \
+        if (status != OK) {                                                    \
+            return status;                                                     \
+        }                                                                      \
+        if (item != NULL) {                                                    \
+            *item = heap->items.items[0];                                      \
+        }                                                                      \
+        heap->positions.items[handle] = HEAP_NO_POSITION;                      \
+        size_t last = heap->items.size - 1;                                    \
+        heap->items.size--;                                                    \
+        heap->handles.size--;                                                  \
+        if (last != 0) {                                                       \
+            heap->items.items[0] = heap->items.items[last];                    \
+            heap->handles.items[0] = heap->handles.items[last];                \
+            name##SiftDown(heap, 0);                                           \
+        }                                                                      \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    /* a failed realloc leaves an array with no items, so empty the heap       \
+     * instead of leaving sizes that point into nothing */                     \
+    static inline void name##Reset(name *heap) {                               \
+        heap->items.size = 0;                                                  \
+        heap->handles.size = 0;                                                \
+        heap->positions.size = 0;                                              \
+        heap->freeHandles.size = 0;                                            \
+        if (heap->items.items == NULL) {                                       \
+            heap->items.alloc = 0;                                             \
+        }                                                                      \
+        if (heap->handles.items == NULL) {                                     \
+            heap->handles.alloc = 0;                                           \
+        }                                                                      \
+        if (heap->positions.items == NULL) {                                   \
+            heap->positions.alloc = 0;                                         \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* replace the heap with items in O(n). Handle i refers to items[i] */     \
+    static inline int name##Heapify(name *heap, const type *items,             \
+                                    size_t count) {                            \
+        if (!ARRAY_INITIALIZED(heap->items) || (items == NULL && count)) {     \
+            DEBUG_ERROR("Heapify was called with a null pointer");             \
+            return NULLPOINTER;                                                \
+        }                                                                      \
+        if (count >= HEAP_NO_POSITION) {                                       \
+            DEBUG_ERROR("Heapify was called with too many items");             \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        int status = 0;                                                        \
+        if (heap->items.alloc < count) {                                       \
+            REALLOC_ARRAY(heap->items, count, status);                         \
+            if (status != OK) {                                                \
+                name##Reset(heap);                                             \
+                return status;                                                 \
+            }                                                                  \
+        }                                                                      \
+        if (heap->handles.alloc < count) {                                     \
+            REALLOC_ARRAY(heap->handles, count, status);                       \
+            if (status != OK) {                                                \
+                name##Reset(heap);                                             \
+                return status;                                                 \
+            }                                                                  \
+        }                                                                      \
+        if (heap->positions.alloc < count) {                                   \
+            REALLOC_ARRAY(heap->positions, count, status);                     \
+            if (status != OK) {                                                \
+                name##Reset(heap);                                             \
+                return status;                                                 \
+            }                                                                  \
+        }                                                                      \
+        if (count != 0) {                                                      \
+            memcpy(heap->items.items, items, count * sizeof(type));            \
+        }                                                                      \
+        for (size_t i = 0; i < count; i++) {                                   \
+            heap->handles.items[i] = (uint32_t)i;                              \
+            heap->positions.items[i] = (uint32_t)i;                            \
+        }                                                                      \
+        heap->items.size = count;                                              \
+        heap->handles.size = count;                                            \
+        heap->positions.size = count;                                          \
+        heap->freeHandles.size = 0;                                            \
+        /* floyd's method. Sift down every parent from the bottom up */        \
+        for (size_t i = count / (arity) + 1; i > 0; i--) {                     \
+            if (i - 1 < count) {                                               \
+                name##SiftDown(heap, i - 1);                                   \
+            }                                                                  \
+        }                                                                      \
+        return OK;                                                             \
+    }                                                                          \
+                                                                               \
+    /* lower the priority value of an item. item must not be greater than */   \
+    /* the one it replaces */                                                  \
+    static inline int name##DecreaseKey(name *heap, uint32_t handle,           \
+                                        type item) {                           \
+        if (handle >= heap->positions.size ||                                  \
+            heap->positions.items[handle] == HEAP_NO_POSITION) {               \
+            DEBUG_ERROR("DecreaseKey was called with a stale handle");         \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        size_t position = heap->positions.items[handle];                       \
+        if (lessThan(&heap->items.items[position], &item)) {                   \
+            DEBUG_ERROR("DecreaseKey was called with a larger item");          \
+            return INVALIDARGS;                                                \
+        }                                                                      \
+        heap->items.items[position] = item;                                    \
+        name##SiftUp(heap, position);                                          \
+        return OK;                                                             \
+    }
+#endif
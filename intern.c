@@ -0,0 +1,217 @@
+#include "intern.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "hash.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#define INTERN_INITIAL_SLOTS 64
+
+static int buildSlots(struct InternTable *table, size_t slotCount) {
+    uint32_t *slots = zmallocArena(&table->arena, slotCount * sizeof(uint32_t));
+    if (slots == NULL) {
+        DEBUG_ERROR("Unable to allocate the intern table slots");
+        return FAILEDALLOC;
+    }
+    // slotCount is always a power of two so the mask can be used to wrap
+    size_t mask = slotCount - 1;
+    for (size_t id = 0; id < table->strings.size; id++) {
+        size_t slot = table->hashes.items[id] & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = (uint32_t)id + 1;
+    }
+    table->slots = slots;
+    table->slotCount = slotCount;
+    return OK;
+}
+
+// find the slot that either holds the string or the empty slot where it should
+// go. The caller has to hold at least the read lock
+static size_t probeSlot(const struct InternTable *table, const String *string,
+                        uint64_t hash) {
+    size_t mask = table->slotCount - 1;
+    size_t slot = hash & mask;
+    while (table->slots[slot] != 0) {
+        uint32_t id = table->slots[slot] - 1;
+        const String *candidate = &table->strings.items[id];
+        if (table->hashes.items[id] == hash &&
+            candidate->size == string->size &&
+            (string->size == 0 ||
+             !memcmp(candidate->items, string->items, string->size))) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+int initInternTable(struct InternTable *table, struct Arena *arena,
+                    int threadSafe) {
+    if (table == NULL || arena == NULL) {
+        DEBUG_ERROR("`initInternTable` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    int status = 0;
+    table->arena = arena;
+    table->threadSafe = threadSafe;
+    INIT_ARRAY(table->strings, arena, status);
+    if (status != OK) {
+        return status;
+    }
+    INIT_ARRAY(table->hashes, arena, status);
+    if (status != OK) {
+        return status;
+    }
+    status = buildSlots(table, INTERN_INITIAL_SLOTS);
+    if (status != OK) {
+        return status;
+    }
+    if (threadSafe && pthread_rwlock_init(&table->lock, NULL) != 0) {
+        DEBUG_ERROR("Unable to create the intern table lock");
+        return FAILEDALLOC;
+    }
+    return OK;
+}
+
+void freeInternTable(struct InternTable *table) {
+    if (table == NULL) {
+        return;
+    }
+    if (table->threadSafe) {
+        pthread_rwlock_destroy(&table->lock);
+    }
+    FREE_ARRAY(table->strings);
+    FREE_ARRAY(table->hashes);
+    table->slots = NULL;
+    table->slotCount = 0;
+}
+
+// add a string to the table. The caller must hold the write lock
+static uint32_t insertString(struct InternTable *table, const String *string,
+                             uint64_t hash) {
+    // keep the load factor under 3/4 so probes stay short
+    if ((table->strings.size + 1) * 4 > table->slotCount * 3) {
+        if (buildSlots(table, table->slotCount * 2) != OK) {
+            return INTERN_INVALID_ID;
+        }
+    }
+    size_t slot = probeSlot(table, string, hash);
+    if (table->slots[slot] != 0) {
+        // someone beat us to it between the read and write lock
+        return table->slots[slot] - 1;
+    }
+    if (table->strings.size >= INTERN_INVALID_ID) {
+        DEBUG_ERROR("The intern table is out of ids");
+        return INTERN_INVALID_ID;
+    }
+
+    String canonical = {NULL, string->size, string->size, table->arena};
+    if (string->size != 0) {
+        canonical.items = mallocArena(&table->arena, string->size);
+        if (canonical.items == NULL) {
+            DEBUG_ERROR("Unable to copy the string into the intern table");
+            return INTERN_INVALID_ID;
+        }
+        memcpy(canonical.items, string->items, string->size);
+    }
+
+    int status = 0;
+    PUSH_ARRAY(table->strings, canonical, status);
+    if (status != OK) {
+        return INTERN_INVALID_ID;
+    }
+    PUSH_ARRAY(table->hashes, hash, status);
+    if (status != OK) {
+        table->strings.size--;
+        return INTERN_INVALID_ID;
+    }
+    uint32_t id = (uint32_t)table->strings.size - 1;
+    table->slots[slot] = id + 1;
+    return id;
+}
+
+uint32_t findInternedString(struct InternTable *table, String *string) {
+    if (table == NULL || string == NULL || table->slots == NULL) {
+        DEBUG_ERROR("`findInternedString` was called with a null pointer");
+        return INTERN_INVALID_ID;
+    }
+    uint64_t hash = hashString(string);
+    if (table->threadSafe) {
+        pthread_rwlock_rdlock(&table->lock);
+    }
+    size_t slot = probeSlot(table, string, hash);
+    uint32_t id = table->slots[slot] - 1;
+    if (table->threadSafe) {
+        pthread_rwlock_unlock(&table->lock);
+    }
+    return id;
+}
+
+uint32_t internString(struct InternTable *table, String *string) {
+    if (table == NULL || string == NULL || table->slots == NULL) {
+        DEBUG_ERROR("`internString` was called with a null pointer");
+        return INTERN_INVALID_ID;
+    }
+    uint64_t hash = hashString(string);
+    if (!table->threadSafe) {
+        size_t slot = probeSlot(table, string, hash);
+        if (table->slots[slot] != 0) {
+            return table->slots[slot] - 1;
+        }
+        return insertString(table, string, hash);
+    }
+
+    // most strings have been seen before so try with only the read lock first
+    pthread_rwlock_rdlock(&table->lock);
+    size_t slot = probeSlot(table, string, hash);
+    uint32_t id = table->slots[slot] - 1;
+    pthread_rwlock_unlock(&table->lock);
+    if (id != INTERN_INVALID_ID) {
+        return id;
+    }
+    pthread_rwlock_wrlock(&table->lock);
+    id = insertString(table, string, hash);
+    pthread_rwlock_unlock(&table->lock);
+    return id;
+}
+
+struct StringReturn getInternedString(struct InternTable *table, uint32_t id) {
+    struct StringReturn returnValue = {NEW_ARRAY(), 0};
+    if (table == NULL) {
+        DEBUG_ERROR("`getInternedString` was called with a null pointer");
+        returnValue.status = NULLPOINTER;
+        return returnValue;
+    }
+    if (table->threadSafe) {
+        pthread_rwlock_rdlock(&table->lock);
+    }
+    if (id < table->strings.size) {
+        returnValue.string = table->strings.items[id];
+    }
+    else {
+        DEBUG_ERROR("`getInternedString` was called with an unknown id");
+        returnValue.status = INVALIDARGS;
+    }
+    if (table->threadSafe) {
+        pthread_rwlock_unlock(&table->lock);
+    }
+    return returnValue;
+}
+
+size_t internTableSize(struct InternTable *table) {
+    if (table == NULL) {
+        return 0;
+    }
+    if (table->threadSafe) {
+        pthread_rwlock_rdlock(&table->lock);
+    }
+    size_t size = table->strings.size;
+    if (table->threadSafe) {
+        pthread_rwlock_unlock(&table->lock);
+    }
+    return size;
+}
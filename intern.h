@@ -0,0 +1,57 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// returned by the intern functions when the string could not be interned or
+// was not found
+#define INTERN_INVALID_ID UINT32_MAX
+
+// The intern table keeps one canonical copy of every string that is passed to
+// it and hands back a dense id. Ids start at zero and go up by one for every
+// new string so they can be used to index into plain arrays. Two strings are
+// equal if and only if their ids are equal.
+struct InternTable {
+    // id -> canonical string. The bytes of the strings live in the arena and
+    // never move
+    ARRAY(String) strings;
+    // id -> hash of the string. Kept around so growing the table doesn't need
+    // to rehash every string
+    ARRAY(uint64_t) hashes;
+    // open addressed hash table that stores id + 1. Zero is an empty slot
+    uint32_t *slots;
+    size_t slotCount;
+    struct Arena *arena;
+    // read mostly mode. Lookups take a read lock and only new strings take the
+    // write lock
+    int threadSafe;
+    pthread_rwlock_t lock;
+};
+
+// set up the table. If threadSafe is non zero the table can be shared between
+// threads
+int initInternTable(struct InternTable *table, struct Arena *arena,
+                    int threadSafe);
+
+// release the lock held by the table. The memory belongs to the arena
+void freeInternTable(struct InternTable *table);
+
+// return the id for the string and copy it into the table if this is the
+// first time it has been seen
+uint32_t internString(struct InternTable *table, String *string);
+
+// the same as internString but it will not add the string to the table
+uint32_t findInternedString(struct InternTable *table, String *string);
+
+// get the canonical string for an id. This is a view into the table so it
+// lives as long as the arena
+struct StringReturn getInternedString(struct InternTable *table, uint32_t id);
+
+// number of unique strings in the table
+size_t internTableSize(struct InternTable *table);
+#endif
@@ -0,0 +1,107 @@
+// memfd_create is a gnu extension
+#define _GNU_SOURCE
+#include "mirrorbuffer.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct MirrorBuffer *createMirrorBuffer(struct Arena **arena, size_t size) {
+    if (arena == NULL || *arena == NULL) {
+        DEBUG_ERROR("`createMirrorBuffer` was called with a bad arena pointer");
+        return NULL;
+    }
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0) {
+        DEBUG_ERROR("`createMirrorBuffer` was unable to get the page size");
+        return NULL;
+    }
+    // page sizes are powers of two so this is still a multiple of the page
+    size_t capacity =
+        nextPowerOfTwo(size < (size_t)pageSize ? (size_t)pageSize : size);
+    struct MirrorBuffer *buffer =
+        zmallocArena(arena, sizeof(struct MirrorBuffer));
+    if (buffer == NULL) {
+        DEBUG_ERROR("`createMirrorBuffer` was unable to allocate the buffer");
+        return NULL;
+    }
+    int fd = memfd_create("mirrorbuffer", MFD_CLOEXEC);
+    if (fd == -1) {
+        DEBUG_ERROR("`createMirrorBuffer` was unable to create a memfd");
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)capacity) != 0) {
+        DEBUG_ERROR("`createMirrorBuffer` was unable to size the memfd");
+        close(fd);
+        return NULL;
+    }
+    // reserve both halves first so nothing else can land in the second one,
+    // then map the file over each half
+    uint8_t *data = mmap(NULL, 2 * capacity, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        DEBUG_ERROR("`createMirrorBuffer` was unable to reserve the pages");
+        close(fd);
+        return NULL;
+    }
+    void *first = mmap(data, capacity, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED, fd, 0);
+    void *second = mmap(data + capacity, capacity, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, fd, 0);
+    // the mappings keep the file alive
+    close(fd);
+    if (first == MAP_FAILED || second == MAP_FAILED) {
+        DEBUG_ERROR("`createMirrorBuffer` was unable to map the pages");
+        munmap(data, 2 * capacity);
+        return NULL;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return buffer;
+}
+
+void destroyMirrorBuffer(struct MirrorBuffer **buffer) {
+    if (buffer == NULL || *buffer == NULL) {
+        return;
+    }
+    munmap((*buffer)->data, 2 * (*buffer)->capacity);
+    (*buffer)->data = NULL;
+    (*buffer)->capacity = 0;
+    *buffer = NULL;
+}
+
+int pushMirrorBuffer(struct MirrorBuffer *buffer, const void *data,
+                     size_t count) {
+    if (buffer == NULL || (data == NULL && count != 0)) {
+        DEBUG_ERROR("`pushMirrorBuffer` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    size_t space = 0;
+    uint8_t *span = mirrorBufferWriteSpan(buffer, &space);
+    if (count > space) {
+        return BUFFERFULL;
+    }
+    if (count != 0) {
+        memcpy(span, data, count);
+    }
+    buffer->tail += count;
+    return OK;
+}
+
+size_t popMirrorBuffer(struct MirrorBuffer *buffer, void *data, size_t count) {
+    if (buffer == NULL || (data == NULL && count != 0)) {
+        DEBUG_ERROR("`popMirrorBuffer` was called with a null pointer");
+        return 0;
+    }
+    size_t size = 0;
+    uint8_t *span = mirrorBufferReadSpan(buffer, &size);
+    count = count < size ? count : size;
+    if (count != 0) {
+        memcpy(data, span, count);
+    }
+    buffer->head += count;
+    return count;
+}
@@ -0,0 +1,72 @@
+#ifndef MIRRORBUFFER_H
+#define MIRRORBUFFER_H
+
+#include "arena.h"
+#include "array.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Byte ring buffer where the pages are mapped twice, back to back. Byte
+// capacity + i is the same memory as byte i, so the readable bytes and the
+// free space are always one contiguous run no matter where the wrap is. A
+// parser can read a message that straddles the end without copying it out
+// first.
+//
+// The capacity is rounded up to a power of two that is at least a page. The
+// struct comes from the arena but the pages are their own mapping and have to
+// be given back with destroyMirrorBuffer.
+struct MirrorBuffer {
+    uint8_t *data;
+    size_t capacity;
+    // bytes read and written so far. These never wrap so the size is
+    // tail - head
+    uint64_t head;
+    uint64_t tail;
+};
+
+struct MirrorBuffer *createMirrorBuffer(struct Arena **arena, size_t size);
+
+// unmap the pages. The buffer pointer will be returned as null
+void destroyMirrorBuffer(struct MirrorBuffer **buffer);
+
+// copy all count bytes in or give BUFFERFULL and copy nothing
+int pushMirrorBuffer(struct MirrorBuffer *buffer, const void *data,
+                     size_t count);
+
+// copy up to count of the oldest bytes out and drop them. Returns how many
+// were copied
+size_t popMirrorBuffer(struct MirrorBuffer *buffer, void *data, size_t count);
+
+static inline size_t mirrorBufferSize(const struct MirrorBuffer *buffer) {
+    return (size_t)(buffer->tail - buffer->head);
+}
+
+// the readable bytes, oldest first. Call consumeMirrorBuffer when done
+static inline uint8_t *mirrorBufferReadSpan(const struct MirrorBuffer *buffer,
+                                            size_t *count) {
+    *count = mirrorBufferSize(buffer);
+    return buffer->data + (buffer->head & (buffer->capacity - 1));
+}
+
+// the free space after the newest byte. Fill it and call commitMirrorBuffer
+static inline uint8_t *mirrorBufferWriteSpan(const struct MirrorBuffer *buffer,
+                                             size_t *count) {
+    *count = buffer->capacity - mirrorBufferSize(buffer);
+    return buffer->data + (buffer->tail & (buffer->capacity - 1));
+}
+
+// count is clamped to the free space
+static inline void commitMirrorBuffer(struct MirrorBuffer *buffer,
+                                      size_t count) {
+    size_t space = buffer->capacity - mirrorBufferSize(buffer);
+    buffer->tail += count < space ? count : space;
+}
+
+// count is clamped to the size
+static inline void consumeMirrorBuffer(struct MirrorBuffer *buffer,
+                                       size_t count) {
+    size_t size = mirrorBufferSize(buffer);
+    buffer->head += count < size ? count : size;
+}
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef MPMCBUFFER_H
+#define MPMCBUFFER_H
+
+#include "arena.h" // NOLINT
+#include "array.h" // NOLINT
+#include "debug.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define MPMC_CACHE_LINE 64
+
+// Bounded queue that any number of threads can push to and pop from without a
+// lock. Every cell has a sequence number that says whose turn it is. A cell at
+// position p is free for the producer that claims p when its sequence is p and
+// holds an item for the consumer that claims p when its sequence is p + 1. A
+// thread claims a position by moving tail or head forward with a compare and
+// swap and then only ever touches its own cells. The capacity is rounded up to
+// a power of two.
+//
+// The batched calls claim a run of ready cells with a single swap so a burst
+// of items only pays for one contended update.
+#define MPMC_BUFFER(type)                                                      \
+    struct {                                                                   \
+        struct {                                                               \
+            _Atomic uint64_t sequence;                                         \
+            type value;                                                        \
+        } *cells;                                                              \
+        uint64_t mask;                                                         \
+        char sharedPadding[MPMC_CACHE_LINE];                                   \
+        /* next position to push to */                                         \
+        _Atomic uint64_t tail;                                                 \
+        char tailPadding[MPMC_CACHE_LINE];                                     \
+        /* next position to pop from */                                        \
+        _Atomic uint64_t head;                                                 \
+        char headPadding[MPMC_CACHE_LINE];                                     \
+    }
+
+// set up the buffer before it is shared with other threads
+#define INIT_MPMC_BUFFER(buffer, arena, buffer_size, status)                   \
+    do {                                                                       \
+        struct Arena *mpmcArena = (arena);                                     \
+        if (mpmcArena == NULL) {                                               \
+            DEBUG_ERROR("called INIT_MPMC_BUFFER with a null arena pointer");  \
+            (status) = NULLPOINTER;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((buffer_size) <= 1) {                                              \
+            DEBUG_ERROR("called INIT_MPMC_BUFFER with a size that is <= 1");   \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        size_t mpmcCapacity = nextPowerOfTwo(buffer_size);                     \
+        (buffer).cells = mallocArena(&mpmcArena,                               \
+                                     mpmcCapacity * sizeof(*(buffer).cells));  \
+        if ((buffer).cells == NULL) {                                          \
+            DEBUG_ERROR("INIT_MPMC_BUFFER failed to allocate the buffer");     \
+            (status) = FAILEDALLOC;                                            \
+            break;                                                             \
+        }                                                                      \
+        for (size_t i = 0; i < mpmcCapacity; i++) {                            \
+            atomic_init(&(buffer).cells[i].sequence, i);                       \
+        }                                                                      \
+        (buffer).mask = mpmcCapacity - 1;                                      \
+        atomic_init(&(buffer).tail, 0);                                        \
+        atomic_init(&(buffer).head, 0);                                        \
+        (status) = OK;                                                         \
+    } while (0)
+
+#define MPMC_BUFFER_CAPACITY(buffer) ((size_t)((buffer).mask + 1))
+
+// status is BUFFERFULL if there was no room
+#define TRY_PUSH_MPMC_BUFFER(buffer, item, status)                             \
+    do {                                                                       \
+        uint64_t mpmcPosition =                                                \
+            atomic_load_explicit(&(buffer).tail, memory_order_relaxed);        \
+        __typeof__((buffer).cells) mpmcCell = NULL;                            \
+        for (;;) {                                                             \
+            mpmcCell = &(buffer).cells[mpmcPosition & (buffer).mask];          \
+            uint64_t mpmcSequence = atomic_load_explicit(                      \
+                &mpmcCell->sequence, memory_order_acquire);                    \
+            int64_t mpmcDifference = (int64_t)(mpmcSequence - mpmcPosition);   \
+            if (mpmcDifference == 0) {                                         \
+                /* a failed swap reloads the position */                       \
+                if (atomic_compare_exchange_weak_explicit(                     \
+                        &(buffer).tail, &mpmcPosition, mpmcPosition + 1,       \
+                        memory_order_relaxed, memory_order_relaxed)) {         \
+                    break;                                                     \
+                }                                                              \
+            }                                                                  \
+            else if (mpmcDifference < 0) {                                     \
+                /* the cell still holds an item from a lap ago */              \
+                mpmcCell = NULL;                                               \
+                break;                                                         \
+            }                                                                  \
+            else {                                                             \
+                mpmcPosition = atomic_load_explicit(&(buffer).tail,            \
+                                                    memory_order_relaxed);     \
+            }                                                                  \
+        }                                                                      \
+        if (mpmcCell == NULL) {                                                \
+            (status) = BUFFERFULL;                                             \
+            break;                                                             \
+        }                                                                      \
+        mpmcCell->value = (item);                                              \
+        atomic_store_explicit(&mpmcCell->sequence, mpmcPosition + 1,           \
+                              memory_order_release);                           \
+        (status) = OK;                                                         \
+    } while (0)
+
+// status is BUFFEREMPTY if there was nothing to pop
+#define TRY_POP_MPMC_BUFFER(buffer, item, status)                              \
+    do {                                                                       \
+        uint64_t mpmcPosition =                                                \
+            atomic_load_explicit(&(buffer).head, memory_order_relaxed);        \
+        __typeof__((buffer).cells) mpmcCell = NULL;                            \
+        for (;;) {                                                             \
+            mpmcCell = &(buffer).cells[mpmcPosition & (buffer).mask];          \
+            uint64_t mpmcSequence = atomic_load_explicit(                      \
+                &mpmcCell->sequence, memory_order_acquire);                    \
+            int64_t mpmcDifference =                                           \
+                (int64_t)(mpmcSequence - (mpmcPosition + 1));                  \
+            if (mpmcDifference == 0) {                                         \
+                if (atomic_compare_exchange_weak_explicit(                     \
+                        &(buffer).head, &mpmcPosition, mpmcPosition + 1,       \
+                        memory_order_relaxed, memory_order_relaxed)) {         \
+                    break;                                                     \
+                }                                                              \
+            }                                                                  \
+            else if (mpmcDifference < 0) {                                     \
+                mpmcCell = NULL;                                               \
+                break;                                                         \
+            }                                                                  \
+            else {                                                             \
+                mpmcPosition = atomic_load_explicit(&(buffer).head,            \
+                                                    memory_order_relaxed);     \
+            }                                                                  \
+        }                                                                      \
+        if (mpmcCell == NULL) {                                                \
+            (status) = BUFFEREMPTY;                                            \
+            break;                                                             \
+        }                                                                      \
+        (item) = mpmcCell->value;                                              \
+        /* hand the cell to the producer one lap ahead */                      \
+        atomic_store_explicit(&mpmcCell->sequence,                             \
+                              mpmcPosition + (buffer).mask + 1,                \
+                              memory_order_release);                           \
+        (status) = OK;                                                         \
+    } while (0)
+
+// push up to count items from the items pointer. pushed is set to how many
+// made it in, which is less than count when the buffer fills up
+#define PUSH_MPMC_BUFFER_N(buffer, items, count, pushed)                       \
+    do {                                                                       \
+        uint64_t mpmcPosition =                                                \
+            atomic_load_explicit(&(buffer).tail, memory_order_relaxed);        \
+        size_t mpmcClaimed = 0;                                                \
+        for (;;) {                                                             \
+            /* count the free cells in a row starting at the position */       \
+            mpmcClaimed = 0;                                                   \
+            int mpmcStale = 0;                                                 \
+            while (mpmcClaimed < (count)) {                                    \
+                uint64_t mpmcSequence = atomic_load_explicit(                  \
+                    &(buffer)                                                  \
+                         .cells[(mpmcPosition + mpmcClaimed) & (buffer).mask]  \
+                         .sequence,                                            \
+                    memory_order_acquire);                                     \
+                int64_t mpmcDifference = (int64_t)(                            \
+                    mpmcSequence - (mpmcPosition + mpmcClaimed));              \
+                if (mpmcDifference != 0) {                                     \
+                    /* another producer already took this cell */              \
+                    mpmcStale = mpmcClaimed == 0 && mpmcDifference > 0;        \
+                    break;                                                     \
+                }                                                              \
+                mpmcClaimed++;                                                 \
+            }                                                                  \
+            if (mpmcStale) {                                                   \
+                mpmcPosition = atomic_load_explicit(&(buffer).tail,            \
+                                                    memory_order_relaxed);     \
+                continue;                                                      \
+            }                                                                  \
+            if (mpmcClaimed == 0 ||                                            \
+                atomic_compare_exchange_weak_explicit(                         \
+                    &(buffer).tail, &mpmcPosition,                             \
+                    mpmcPosition + mpmcClaimed, memory_order_relaxed,          \
+                    memory_order_relaxed)) {                                   \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        for (size_t i = 0; i < mpmcClaimed; i++) {                             \
+            __typeof__((buffer).cells) mpmcCell =                              \
+                &(buffer).cells[(mpmcPosition + i) & (buffer).mask];           \
+            mpmcCell->value = (items)[i];                                      \
+            atomic_store_explicit(&mpmcCell->sequence, mpmcPosition + i + 1,   \
+                                  memory_order_release);                       \
+        }                                                                      \
+        (pushed) = mpmcClaimed;                                                \
+    } while (0)
+
+// pop up to count items into the items pointer. popped is set to how many
+// were taken
+#define POP_MPMC_BUFFER_N(buffer, items, count, popped)                        \
+    do {                                                                       \
+        uint64_t mpmcPosition =                                                \
+            atomic_load_explicit(&(buffer).head, memory_order_relaxed);        \
+        size_t mpmcClaimed = 0;                                                \
+        for (;;) {                                                             \
+            /* count the full cells in a row starting at the position */       \
+            mpmcClaimed = 0;                                                   \
+            int mpmcStale = 0;                                                 \
+            while (mpmcClaimed < (count)) {                                    \
+                uint64_t mpmcSequence = atomic_load_explicit(                  \
+                    &(buffer)                                                  \
+                         .cells[(mpmcPosition + mpmcClaimed) & (buffer).mask]  \
+                         .sequence,                                            \
+                    memory_order_acquire);                                     \
+                int64_t mpmcDifference = (int64_t)(                            \
+                    mpmcSequence - (mpmcPosition + mpmcClaimed + 1));          \
+                if (mpmcDifference != 0) {                                     \
+                    /* another consumer already took this cell */              \
+                    mpmcStale = mpmcClaimed == 0 && mpmcDifference > 0;        \
+                    break;                                                     \
+                }                                                              \
+                mpmcClaimed++;                                                 \
+            }                                                                  \
+            if (mpmcStale) {                                                   \
+                mpmcPosition = atomic_load_explicit(&(buffer).head,            \
+                                                    memory_order_relaxed);     \
+                continue;                                                      \
+            }                                                                  \
+            if (mpmcClaimed == 0 ||                                            \
+                atomic_compare_exchange_weak_explicit(                         \
+                    &(buffer).head, &mpmcPosition,                             \
+                    mpmcPosition + mpmcClaimed, memory_order_relaxed,          \
+                    memory_order_relaxed)) {                                   \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        for (size_t i = 0; i < mpmcClaimed; i++) {                             \
+            __typeof__((buffer).cells) mpmcCell =                              \
+                &(buffer).cells[(mpmcPosition + i) & (buffer).mask];           \
+            (items)[i] = mpmcCell->value;                                      \
+            atomic_store_explicit(&mpmcCell->sequence,                         \
+                                  mpmcPosition + i + (buffer).mask + 1,        \
+                                  memory_order_release);                       \
+        }                                                                      \
+        (popped) = mpmcClaimed;                                                \
+    } while (0)
+
+#endif
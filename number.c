@@ -0,0 +1,676 @@
+// strtod_l and newlocale are gnu extensions
+#define _GNU_SOURCE
+#include "number.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "numbertables.h"
+#include <locale.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline int isDigit(char character) {
+    return (unsigned char)(character - '0') < 10;
+}
+
+static inline uint64_t readWord(const char *chars) {
+    uint64_t word;
+    memcpy(&word, chars, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// SWAR. Check that all eight chars are digits and then combine them pairwise
+// with three multiplies instead of eight multiply adds
+static inline int parseEightDigits(const char *chars, uint64_t *value) {
+    uint64_t word = readWord(chars);
+    // every byte has to be 0x3_ and still be 0x3_ after adding 6
+    if (((word & 0xF0F0F0F0F0F0F0F0ULL) |
+         (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) !=
+        0x3333333333333333ULL) {
+        return 0;
+    }
+    word = ((word & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    word = ((word & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    *value = ((word & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+    return 1;
+}
+
+// every char from start to end has to be a digit
+static int parseDigits(const char *start, const char *end, uint64_t *value) {
+    if (start == end) {
+        return INVALIDARGS;
+    }
+    uint64_t total = 0;
+    int overflow = 0;
+    const char *position = start;
+    uint64_t block = 0;
+    while (end - position >= 8 && parseEightDigits(position, &block)) {
+        overflow |= __builtin_mul_overflow(total, 100000000, &total);
+        overflow |= __builtin_add_overflow(total, block, &total);
+        position += 8;
+    }
+    while (position < end && isDigit(*position)) {
+        overflow |= __builtin_mul_overflow(total, 10, &total);
+        overflow |= __builtin_add_overflow(total, (uint64_t)(*position - '0'),
+                                           &total);
+        position++;
+    }
+    if (position != end) {
+        return INVALIDARGS;
+    }
+    *value = total;
+    return overflow ? OUTOFRANGE : OK;
+}
+
+int parseUint64(const String *string, uint64_t *value) {
+    if (string == NULL || value == NULL) {
+        DEBUG_ERROR("`parseUint64` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (string->size == 0) {
+        return INVALIDARGS;
+    }
+    const char *position = string->items;
+    const char *end = position + string->size;
+    int negative = *position == '-';
+    if (negative || *position == '+') {
+        position++;
+    }
+    uint64_t magnitude = 0;
+    int status = parseDigits(position, end, &magnitude);
+    if (status == INVALIDARGS) {
+        return status;
+    }
+    if (status == OUTOFRANGE) {
+        *value = negative ? 0 : UINT64_MAX;
+        return OUTOFRANGE;
+    }
+    // -0 is fine but nothing else below zero is
+    if (negative && magnitude != 0) {
+        *value = 0;
+        return OUTOFRANGE;
+    }
+    *value = magnitude;
+    return OK;
+}
+
+int parseInt64(const String *string, int64_t *value) {
+    if (string == NULL || value == NULL) {
+        DEBUG_ERROR("`parseInt64` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (string->size == 0) {
+        return INVALIDARGS;
+    }
+    const char *position = string->items;
+    const char *end = position + string->size;
+    int negative = *position == '-';
+    if (negative || *position == '+') {
+        position++;
+    }
+    uint64_t magnitude = 0;
+    int status = parseDigits(position, end, &magnitude);
+    if (status == INVALIDARGS) {
+        return status;
+    }
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (status == OUTOFRANGE || magnitude > limit) {
+        *value = negative ? INT64_MIN : INT64_MAX;
+        return OUTOFRANGE;
+    }
+    if (negative) {
+        *value = magnitude == limit ? INT64_MIN : -(int64_t)magnitude;
+    }
+    else {
+        *value = (int64_t)magnitude;
+    }
+    return OK;
+}
+
+static const double exactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Eisel-Lemire. Multiply the mantissa by a 128 bit approximation of the power
+// of ten and take the top 54 bits. This is exact except when the bits that
+// were cut off could change the rounding, and then it gives up and returns 0.
+// mantissa can't be 0 and exponent has to be in the table
+static int eiselLemire(uint64_t mantissa, int64_t exponent, double *value) {
+    int leadingZeros = __builtin_clzll(mantissa);
+    mantissa <<= leadingZeros;
+    // floor(log2(10) * exponent) + the bias, moved to where the top bit is
+    uint64_t binaryExponent =
+        (uint64_t)(((217706 * exponent) >> 16) + 64 + 1023) -
+        (uint64_t)leadingZeros;
+    const uint64_t *power = powersOfTen[exponent - POWER_OF_TEN_MIN];
+    __uint128_t product = (__uint128_t)mantissa * power[1];
+    uint64_t high = (uint64_t)(product >> 64);
+    uint64_t low = (uint64_t)product;
+    // the low bits are all ones so the rest of the power could carry into them
+    if ((high & 0x1FF) == 0x1FF && low + mantissa < mantissa) {
+        __uint128_t lower = (__uint128_t)mantissa * power[0];
+        uint64_t mergedHigh = high;
+        uint64_t mergedLow = low + (uint64_t)(lower >> 64);
+        if (mergedLow < low) {
+            mergedHigh++;
+        }
+        if ((mergedHigh & 0x1FF) == 0x1FF && mergedLow + 1 == 0 &&
+            (uint64_t)lower + mantissa < mantissa) {
+            return 0;
+        }
+        high = mergedHigh;
+        low = mergedLow;
+    }
+    uint64_t top = high >> 63;
+    uint64_t bits = high >> (top + 9);
+    binaryExponent -= 1 ^ top;
+    // exactly half way between two doubles
+    if (low == 0 && (high & 0x1FF) == 0 && (bits & 3) == 1) {
+        return 0;
+    }
+    bits += bits & 1;
+    bits >>= 1;
+    if (bits >> 53 != 0) {
+        bits >>= 1;
+        binaryExponent++;
+    }
+    // subnormals and overflow are left to strtod
+    if (binaryExponent - 1 >= 0x7FF - 1) {
+        return 0;
+    }
+    uint64_t raw = (binaryExponent << 52) | (bits & 0x000FFFFFFFFFFFFFULL);
+    memcpy(value, &raw, sizeof(raw));
+    return 1;
+}
+
+// strtod follows the global locale and would stop at the '.' under one that
+// uses a ',' so the slow path always parses in the C locale
+static locale_t cLocale = (locale_t)0;
+static pthread_once_t cLocaleOnce = PTHREAD_ONCE_INIT;
+
+static void createCLocale(void) {
+    cLocale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+}
+
+// strtod on a null terminated copy for the few inputs the fast paths can't do
+static int parseSlow(const char *start, const char *end, struct Arena *arena,
+                     double *value) {
+    pthread_once(&cLocaleOnce, createCLocale);
+    if (cLocale == (locale_t)0) {
+        DEBUG_ERROR("`parseDouble` couldn't create the C locale");
+        return FAILEDALLOC;
+    }
+    size_t size = (size_t)(end - start);
+    char local[128];
+    char *copy = local;
+    if (size >= sizeof(local)) {
+        copy = arena == NULL ? NULL : mallocArena(&arena, size + 1);
+        if (copy == NULL) {
+            DEBUG_ERROR("`parseDouble` couldn't copy a long number");
+            return FAILEDALLOC;
+        }
+    }
+    memcpy(copy, start, size);
+    copy[size] = '\0';
+    *value = strtod_l(copy, NULL, cLocale);
+    return OK;
+}
+
+// word has to be lowercase
+static int matchWord(const char *start, const char *end, const char *word) {
+    size_t size = strlen(word);
+    if ((size_t)(end - start) != size) {
+        return 0;
+    }
+    for (size_t i = 0; i < size; i++) {
+        if ((start[i] | 0x20) != word[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int parseDouble(const String *string, double *value) {
+    if (string == NULL || value == NULL) {
+        DEBUG_ERROR("`parseDouble` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (string->size == 0) {
+        return INVALIDARGS;
+    }
+    const char *position = string->items;
+    const char *end = position + string->size;
+    int negative = *position == '-';
+    if (negative || *position == '+') {
+        position++;
+    }
+    if (position == end) {
+        return INVALIDARGS;
+    }
+    if (!isDigit(*position) && *position != '.') {
+        if (matchWord(position, end, "inf") ||
+            matchWord(position, end, "infinity")) {
+            *value = negative ? -HUGE_VAL : HUGE_VAL;
+            return OK;
+        }
+        if (matchWord(position, end, "nan")) {
+            *value = negative ? -NAN : NAN;
+            return OK;
+        }
+        return INVALIDARGS;
+    }
+
+    // only the first 19 significant digits fit in the mantissa. If any digit
+    // after those isn't zero the fast paths can't be used
+    const char *start = position;
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    int significant = 0;
+    int truncated = 0;
+    int sawDigits = 0;
+    uint64_t block = 0;
+    for (int fraction = 0; fraction < 2; fraction++) {
+        if (fraction) {
+            if (position == end || *position != '.') {
+                break;
+            }
+            position++;
+        }
+        for (;;) {
+            if (mantissa != 0 && significant <= 11 && end - position >= 8 &&
+                parseEightDigits(position, &block)) {
+                mantissa = (mantissa * 100000000) + block;
+                significant += 8;
+                exponent -= fraction ? 8 : 0;
+                position += 8;
+                sawDigits = 1;
+                continue;
+            }
+            if (position == end || !isDigit(*position)) {
+                break;
+            }
+            uint64_t digit = (uint64_t)(*position - '0');
+            if (significant < 19) {
+                mantissa = (mantissa * 10) + digit;
+                significant += mantissa != 0;
+                exponent -= fraction;
+            }
+            else {
+                truncated |= digit != 0;
+                exponent += !fraction;
+            }
+            position++;
+            sawDigits = 1;
+        }
+    }
+    if (!sawDigits) {
+        return INVALIDARGS;
+    }
+    if (position != end && (*position == 'e' || *position == 'E')) {
+        position++;
+        int exponentNegative = position != end && *position == '-';
+        if (position != end && (*position == '-' || *position == '+')) {
+            position++;
+        }
+        if (position == end || !isDigit(*position)) {
+            return INVALIDARGS;
+        }
+        int64_t written = 0;
+        while (position != end && isDigit(*position)) {
+            // anything this big is already 0 or infinity
+            if (written < 100000) {
+                written = (written * 10) + (*position - '0');
+            }
+            position++;
+        }
+        exponent += exponentNegative ? -written : written;
+    }
+    if (position != end) {
+        return INVALIDARGS;
+    }
+
+    double result = 0;
+    if (mantissa == 0) {
+        result = 0;
+    }
+    else if (truncated) {
+        int status = parseSlow(start, end, string->arena, &result);
+        if (status != OK) {
+            return status;
+        }
+    }
+    else if (exponent < POWER_OF_TEN_MIN) {
+        result = 0;
+    }
+    else if (exponent > POWER_OF_TEN_MAX) {
+        result = HUGE_VAL;
+    }
+    // both the mantissa and the power are exact doubles so one rounding
+    // gives the right answer
+    else if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        result = (double)mantissa;
+        result = exponent < 0 ? result / exactPowersOfTen[-exponent]
+                              : result * exactPowersOfTen[exponent];
+    }
+    else if (!eiselLemire(mantissa, exponent, &result)) {
+        int status = parseSlow(start, end, string->arena, &result);
+        if (status != OK) {
+            return status;
+        }
+    }
+    *value = negative ? -result : result;
+    return isinf(result) ? OUTOFRANGE : OK;
+}
+
+static const char digitPairs[] = "00010203040506070809"
+                                 "10111213141516171819"
+                                 "20212223242526272829"
+                                 "30313233343536373839"
+                                 "40414243444546474849"
+                                 "50515253545556575859"
+                                 "60616263646566676869"
+                                 "70717273747576777879"
+                                 "80818283848586878889"
+                                 "90919293949596979899";
+
+// write the digits backwards from end two at a time. Returns where they start
+static char *writeDigits(char *end, uint64_t value) {
+    while (value >= 100) {
+        end -= 2;
+        memcpy(end, digitPairs + ((value % 100) * 2), 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        end -= 2;
+        memcpy(end, digitPairs + (value * 2), 2);
+    }
+    else {
+        *--end = (char)('0' + value);
+    }
+    return end;
+}
+
+size_t formatUint64(char *buffer, uint64_t value) {
+    if (buffer == NULL) {
+        DEBUG_ERROR("`formatUint64` was called with a null pointer");
+        return 0;
+    }
+    char digits[20];
+    char *start = writeDigits(digits + sizeof(digits), value);
+    size_t length = (size_t)(digits + sizeof(digits) - start);
+    memcpy(buffer, start, length);
+    return length;
+}
+
+size_t formatInt64(char *buffer, int64_t value) {
+    if (buffer == NULL) {
+        DEBUG_ERROR("`formatInt64` was called with a null pointer");
+        return 0;
+    }
+    if (value >= 0) {
+        return formatUint64(buffer, (uint64_t)value);
+    }
+    // negate as unsigned so INT64_MIN works
+    buffer[0] = '-';
+    return 1 + formatUint64(buffer + 1, 0 - (uint64_t)value);
+}
+
+// Ryu. The double and the halfway points to its neighbours are scaled by the
+// same power of ten with 128 bit multiplies. Then digits are dropped from all
+// three until the neighbours would be crossed, which leaves the shortest
+// digits that still round back to the double
+struct DecimalDouble {
+    uint64_t mantissa;
+    int32_t exponent;
+};
+
+static inline uint32_t log10Pow2(int32_t exponent) {
+    return ((uint32_t)exponent * 78913) >> 18;
+}
+
+static inline uint32_t log10Pow5(int32_t exponent) {
+    return ((uint32_t)exponent * 732923) >> 20;
+}
+
+// bits in 5^exponent
+static inline int32_t pow5Bits(int32_t exponent) {
+    return (int32_t)(((uint32_t)exponent * 1217359) >> 19) + 1;
+}
+
+static inline int multipleOfPowerOf5(uint64_t value, uint32_t power) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= power;
+}
+
+static inline int multipleOfPowerOf2(uint64_t value, uint32_t power) {
+    return (value & ((1ULL << power) - 1)) == 0;
+}
+
+static inline uint64_t mulShift(uint64_t value, const uint64_t *multiplier,
+                                int32_t shift) {
+    __uint128_t low = (__uint128_t)value * multiplier[0];
+    __uint128_t high = (__uint128_t)value * multiplier[1];
+    return (uint64_t)(((low >> 64) + high) >> (shift - 64));
+}
+
+static struct DecimalDouble shortestDecimal(uint64_t ieeeMantissa,
+                                            uint32_t ieeeExponent) {
+    // two extra bits so the halfway points are whole numbers
+    int32_t e2 = 0;
+    uint64_t m2 = 0;
+    if (ieeeExponent == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieeeMantissa;
+    }
+    else {
+        e2 = (int32_t)ieeeExponent - 1023 - 52 - 2;
+        m2 = (1ULL << 52) | ieeeMantissa;
+    }
+    int acceptBounds = (m2 & 1) == 0;
+    uint64_t mv = 4 * m2;
+    // the gap below is half as big at a power of two
+    uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+
+    uint64_t vr = 0;
+    uint64_t vp = 0;
+    uint64_t vm = 0;
+    int32_t e10 = 0;
+    int vmIsTrailingZeros = 0;
+    int vrIsTrailingZeros = 0;
+    if (e2 >= 0) {
+        uint32_t q = log10Pow2(e2) - (e2 > 3);
+        e10 = (int32_t)q;
+        int32_t k = POW5_INV_BITCOUNT + pow5Bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = mulShift(mv, pow5InvSplit[q], i);
+        vp = mulShift(mv + 2, pow5InvSplit[q], i);
+        vm = mulShift(mv - 1 - mmShift, pow5InvSplit[q], i);
+        if (q <= 21) {
+            // only one of mv, mp and mm can be a multiple of 5
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+            }
+            else if (acceptBounds) {
+                vmIsTrailingZeros = multipleOfPowerOf5(mv - 1 - mmShift, q);
+            }
+            else {
+                vp -= multipleOfPowerOf5(mv + 2, q);
+            }
+        }
+    }
+    else {
+        uint32_t q = log10Pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5Bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mulShift(mv, pow5Split[i], j);
+        vp = mulShift(mv + 2, pow5Split[i], j);
+        vm = mulShift(mv - 1 - mmShift, pow5Split[i], j);
+        if (q <= 1) {
+            // mv always has two trailing zero bits
+            vrIsTrailingZeros = 1;
+            if (acceptBounds) {
+                vmIsTrailingZeros = mmShift == 1;
+            }
+            else {
+                vp--;
+            }
+        }
+        else if (q < 63) {
+            vrIsTrailingZeros = multipleOfPowerOf2(mv, q);
+        }
+    }
+
+    int32_t removed = 0;
+    uint32_t lastRemovedDigit = 0;
+    uint64_t output = 0;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        // the rare case where an exact tie has to be handled
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = (uint32_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = (uint32_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        // round half to even
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            lastRemovedDigit = 4;
+        }
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) ||
+                       lastRemovedDigit >= 5);
+    }
+    else {
+        int roundUp = 0;
+        // usually at least two digits go so try that first
+        if (vp / 100 > vm / 100) {
+            roundUp = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            roundUp = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || roundUp);
+    }
+    struct DecimalDouble decimal = {output, e10 + removed};
+    return decimal;
+}
+
+size_t formatDouble(char *buffer, double value) {
+    if (buffer == NULL) {
+        DEBUG_ERROR("`formatDouble` was called with a null pointer");
+        return 0;
+    }
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t ieeeMantissa = bits & ((1ULL << 52) - 1);
+    uint32_t ieeeExponent = (uint32_t)((bits >> 52) & 0x7FF);
+    char *position = buffer;
+    if (ieeeExponent == 0x7FF && ieeeMantissa != 0) {
+        memcpy(position, "nan", 3);
+        return 3;
+    }
+    if (bits >> 63) {
+        *position++ = '-';
+    }
+    if (ieeeExponent == 0x7FF) {
+        memcpy(position, "inf", 3);
+        return (size_t)(position - buffer) + 3;
+    }
+    if (ieeeExponent == 0 && ieeeMantissa == 0) {
+        *position++ = '0';
+        return (size_t)(position - buffer);
+    }
+    struct DecimalDouble decimal = shortestDecimal(ieeeMantissa, ieeeExponent);
+    while (decimal.mantissa % 10 == 0) {
+        decimal.mantissa /= 10;
+        decimal.exponent++;
+    }
+    char digits[20];
+    char *start = writeDigits(digits + sizeof(digits), decimal.mantissa);
+    int32_t count = (int32_t)(digits + sizeof(digits) - start);
+    // where the decimal point goes counting from the first digit
+    int32_t point = count + decimal.exponent;
+    if (count <= point && point <= 21) {
+        memcpy(position, start, (size_t)count);
+        position += count;
+        memset(position, '0', (size_t)(point - count));
+        position += point - count;
+    }
+    else if (0 < point && point <= 21) {
+        memcpy(position, start, (size_t)point);
+        position += point;
+        *position++ = '.';
+        memcpy(position, start + point, (size_t)(count - point));
+        position += count - point;
+    }
+    else if (-6 < point && point <= 0) {
+        *position++ = '0';
+        *position++ = '.';
+        memset(position, '0', (size_t)-point);
+        position += -point;
+        memcpy(position, start, (size_t)count);
+        position += count;
+    }
+    else {
+        *position++ = start[0];
+        if (count > 1) {
+            *position++ = '.';
+            memcpy(position, start + 1, (size_t)(count - 1));
+            position += count - 1;
+        }
+        *position++ = 'e';
+        *position++ = point - 1 < 0 ? '-' : '+';
+        int32_t exponent = point - 1 < 0 ? 1 - point : point - 1;
+        position += formatUint64(position, (uint64_t)exponent);
+    }
+    return (size_t)(position - buffer);
+}
+
+struct StringReturn doubleToString(double value, struct Arena *arena) {
+    struct StringReturn returnValue = {NEW_ARRAY(), 0};
+    if (arena == NULL) {
+        DEBUG_ERROR("`doubleToString` was called with a null pointer");
+        returnValue.status = NULLPOINTER;
+        return returnValue;
+    }
+    char *buffer = mallocArena(&arena, NUMBER_BUFFER_SIZE);
+    if (buffer == NULL) {
+        returnValue.status = FAILEDALLOC;
+        return returnValue;
+    }
+    size_t length = formatDouble(buffer, value);
+    String string = {buffer, length, NUMBER_BUFFER_SIZE, arena};
+    returnValue.string = string;
+    return returnValue;
+}
@@ -0,0 +1,37 @@
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Parsing and formatting numbers straight from and into Strings without making
+// null terminated copies for strtol or snprintf.
+
+// the most any of the format functions will write
+#define NUMBER_BUFFER_SIZE 32
+
+// The parsers take the whole string, so trim it first if it could have spaces.
+// They take an optional + or - sign and then the digits. They return OK,
+// INVALIDARGS if the string is not a number, or OUTOFRANGE if it is a number
+// that doesn't fit. Out of range values are clamped like strtol does
+int parseInt64(const String *string, int64_t *value);
+int parseUint64(const String *string, uint64_t *value);
+// decimal with an optional fraction and exponent, or inf, infinity and nan in
+// any case. Too large is OUTOFRANGE with value set to infinity. Too small
+// rounds to zero or a subnormal and is OK. The result is correctly rounded
+int parseDouble(const String *string, double *value);
+
+// These write into buffer, which needs NUMBER_BUFFER_SIZE bytes, and return
+// the length. The output is not null terminated
+size_t formatUint64(char *buffer, uint64_t value);
+size_t formatInt64(char *buffer, int64_t value);
+// the shortest digits that parse back to the same double. It uses plain
+// notation for values from 1e-6 up to 1e21 and 1.5e+300 style outside that
+size_t formatDouble(char *buffer, double value);
+
+// formatDouble into a new string in the arena
+struct StringReturn doubleToString(double value, struct Arena *arena);
+#endif
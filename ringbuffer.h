@@ -4,9 +4,10 @@
 #include "arena.h" // NOLINT
 #include "array.h" // NOLINT
 #include "debug.h"
+#include <stdint.h>
 
 #define BUFFER(type)                                                           \
-    struct buffer {                                                            \
+    struct {                                                                   \
         ARRAY(type) array;                                                     \
         /*NOLINTNEXTLINE*/                                                     \
         type *head;                                                            \
@@ -50,6 +51,8 @@
 #define PUSH_BUFFER(buffer, item)                                              \
     do {                                                                       \
         if ((buffer).array.size == 0) {                                        \
+            /* the tail is left behind when the buffer is popped empty */      \
+            (buffer).tail = (buffer).head;                                     \
             *((buffer).head) = item;                                           \
             (buffer).array.size += 1;                                          \
         }                                                                      \
@@ -80,13 +83,21 @@
         }                                                                      \
     } while (0)
 
+// popped slots are zeroed unless this is set to 0. POP_BUFFER_N and
+// CONSUME_BUFFER never clear
+#ifndef BUFFER_CLEAR_ON_POP
+#define BUFFER_CLEAR_ON_POP 1
+#endif
+
 #define POP_FRONT_BUFFER(buffer)                                               \
     do {                                                                       \
         if ((buffer).array.size == 0) {                                        \
             break;                                                             \
         }                                                                      \
         else {                                                                 \
-            memset((buffer).head, 0, sizeof(*((buffer).head)));                \
+            if (BUFFER_CLEAR_ON_POP) {                                         \
+                memset((buffer).head, 0, sizeof(*((buffer).head)));            \
+            }                                                                  \
             if ((buffer).head !=                                               \
                 (buffer).array.items + ((buffer).array.alloc - 1)) {           \
                 (buffer).head = (buffer).head + 1;                             \
@@ -118,4 +129,211 @@
         }                                                                      \
     } while (0)
 
+// point head and tail back at the slots that offset_index and size describe.
+// Used by the bulk calls below which move the indexes instead of the pointers
+#define SYNC_BUFFER_POINTERS(buffer)                                           \
+    do {                                                                       \
+        (buffer).head = (buffer).array.items + (buffer).offset_index;          \
+        size_t bufferLast = (buffer).offset_index +                            \
+                            ((buffer).array.size ? (buffer).array.size - 1     \
+                                                 : 0);                         \
+        if (bufferLast >= (buffer).array.alloc) {                              \
+            bufferLast -= (buffer).array.alloc;                                \
+        }                                                                      \
+        (buffer).tail = (buffer).array.items + bufferLast;                     \
+    } while (0)
+
+// copy count items from source onto the end of the buffer with at most two
+// memcpys. Like PUSH_BUFFER the oldest items are dropped to make room, so only
+// the last alloc items of source are kept when count is larger than the buffer
+#define PUSH_BUFFER_N(buffer, source, count)                                   \
+    do {                                                                       \
+        size_t bufferAlloc = (buffer).array.alloc;                             \
+        size_t bufferCount = (count);                                          \
+        const __typeof__(*(buffer).head) *bufferSource = (source);             \
+        if (bufferCount > bufferAlloc) {                                       \
+            bufferSource += bufferCount - bufferAlloc;                         \
+            bufferCount = bufferAlloc;                                         \
+        }                                                                      \
+        if (bufferCount == 0) {                                                \
+            break;                                                             \
+        }                                                                      \
+        size_t bufferStart = (buffer).offset_index + (buffer).array.size;      \
+        if (bufferStart >= bufferAlloc) {                                      \
+            bufferStart -= bufferAlloc;                                        \
+        }                                                                      \
+        size_t bufferFirst = bufferAlloc - bufferStart;                        \
+        bufferFirst = bufferFirst < bufferCount ? bufferFirst : bufferCount;   \
+        memcpy((buffer).array.items + bufferStart, bufferSource,               \
+               bufferFirst * sizeof(*(buffer).head));                          \
+        if (bufferCount != bufferFirst) {                                      \
+            memcpy((buffer).array.items, bufferSource + bufferFirst,           \
+                   (bufferCount - bufferFirst) * sizeof(*(buffer).head));      \
+        }                                                                      \
+        size_t bufferSize = (buffer).array.size + bufferCount;                 \
+        if (bufferSize > bufferAlloc) {                                        \
+            DEBUG_PRINT("Buffer's tail is eating the head");                   \
+            size_t bufferOffset =                                              \
+                (buffer).offset_index + (bufferSize - bufferAlloc);            \
+            if (bufferOffset >= bufferAlloc) {                                 \
+                bufferOffset -= bufferAlloc;                                   \
+            }                                                                  \
+            (buffer).offset_index = (uint32_t)bufferOffset;                    \
+            bufferSize = bufferAlloc;                                          \
+        }                                                                      \
+        (buffer).array.size = bufferSize;                                      \
+        SYNC_BUFFER_POINTERS(buffer);                                          \
+    } while (0)
+
+// drop the count oldest items without clearing them. count is clamped to the
+// size
+#define CONSUME_BUFFER(buffer, count)                                          \
+    do {                                                                       \
+        size_t bufferCount = (count);                                          \
+        if (bufferCount > (buffer).array.size) {                               \
+            bufferCount = (buffer).array.size;                                 \
+        }                                                                      \
+        size_t bufferOffset = (buffer).offset_index + bufferCount;             \
+        if (bufferOffset >= (buffer).array.alloc) {                            \
+            bufferOffset -= (buffer).array.alloc;                              \
+        }                                                                      \
+        (buffer).offset_index = (uint32_t)bufferOffset;                        \
+        (buffer).array.size -= bufferCount;                                    \
+        SYNC_BUFFER_POINTERS(buffer);                                          \
+    } while (0)
+
+// copy up to count of the oldest items into destination with at most two
+// memcpys and drop them. popped is set to how many were copied
+#define POP_BUFFER_N(buffer, destination, count, popped)                       \
+    do {                                                                       \
+        size_t bufferPopped = (count);                                         \
+        if (bufferPopped > (buffer).array.size) {                              \
+            bufferPopped = (buffer).array.size;                                \
+        }                                                                      \
+        size_t bufferFirst = (buffer).array.alloc - (buffer).offset_index;     \
+        bufferFirst = bufferFirst < bufferPopped ? bufferFirst : bufferPopped; \
+        if (bufferFirst != 0) {                                                \
+            memcpy((destination), (buffer).head,                               \
+                   bufferFirst * sizeof(*(buffer).head));                      \
+        }                                                                      \
+        if (bufferPopped != bufferFirst) {                                     \
+            memcpy((destination) + bufferFirst, (buffer).array.items,          \
+                   (bufferPopped - bufferFirst) * sizeof(*(buffer).head));     \
+        }                                                                      \
+        CONSUME_BUFFER(buffer, bufferPopped);                                  \
+        (popped) = bufferPopped;                                               \
+    } while (0)
+
+// The items in the buffer as one or two runs of memory, oldest first, so they
+// can be worked on or handed to write() without copying. second is the part
+// that wrapped to the front and secondCount is 0 when nothing wrapped. Call
+// CONSUME_BUFFER when done with them
+#define BUFFER_READ_SPANS(buffer, first, firstCount, second, secondCount)      \
+    do {                                                                       \
+        size_t bufferFirst = (buffer).array.alloc - (buffer).offset_index;     \
+        bufferFirst = bufferFirst < (buffer).array.size ? bufferFirst          \
+                                                        : (buffer).array.size; \
+        (first) = (buffer).head;                                               \
+        (firstCount) = bufferFirst;                                            \
+        (second) = (buffer).array.items;                                       \
+        (secondCount) = (buffer).array.size - bufferFirst;                     \
+    } while (0)
+
+// The free slots after the newest item as one or two runs of memory. Fill
+// them in order and call COMMIT_BUFFER with how many were written. Pushing
+// this way never drops old items
+#define BUFFER_WRITE_SPANS(buffer, first, firstCount, second, secondCount)     \
+    do {                                                                       \
+        size_t bufferStart = (buffer).offset_index + (buffer).array.size;      \
+        if (bufferStart >= (buffer).array.alloc) {                             \
+            bufferStart -= (buffer).array.alloc;                               \
+        }                                                                      \
+        size_t bufferFree = (buffer).array.alloc - (buffer).array.size;        \
+        size_t bufferFirst = (buffer).array.alloc - bufferStart;               \
+        bufferFirst = bufferFirst < bufferFree ? bufferFirst : bufferFree;     \
+        (first) = (buffer).array.items + bufferStart;                          \
+        (firstCount) = bufferFirst;                                            \
+        (second) = (buffer).array.items;                                       \
+        (secondCount) = bufferFree - bufferFirst;                              \
+    } while (0)
+
+// add count items that were written through BUFFER_WRITE_SPANS. count is
+// clamped to the free space
+#define COMMIT_BUFFER(buffer, count)                                           \
+    do {                                                                       \
+        size_t bufferCount = (count);                                          \
+        size_t bufferFree = (buffer).array.alloc - (buffer).array.size;        \
+        (buffer).array.size += bufferCount < bufferFree ? bufferCount          \
+                                                        : bufferFree;          \
+        SYNC_BUFFER_POINTERS(buffer);                                          \
+    } while (0)
+
+// Ring buffer with a power of two capacity. head and tail are counts of the
+// items that have been popped and pushed and never wrap (64 bits won't run out)
+// so the size is tail - head and the slot of any item is just its count masked
+// by capacity - 1. None of push, pop or get need a branch. Like BUFFER a push
+// into a full buffer drops the oldest item.
+#define POW2_BUFFER(type)                                                      \
+    struct {                                                                   \
+        ARRAY(type) array;                                                     \
+        uint64_t head;                                                         \
+        uint64_t tail;                                                         \
+        uint64_t mask;                                                         \
+    }
+
+#define NEW_POW2_BUFFER() {NEW_ARRAY(), 0, 0, 0}
+
+// buffer_size is rounded up to the next power of two
+#define INIT_POW2_BUFFER(buffer, arena, buffer_size, status)                   \
+    do {                                                                       \
+        if ((arena) == NULL) {                                                 \
+            DEBUG_ERROR("called INIT_POW2_BUFFER with a null arena pointer");  \
+            (status) = NULLPOINTER;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((buffer_size) <= 1) {                                              \
+            DEBUG_ERROR("called INIT_POW2_BUFFER with a size that is <= 1");   \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        INIT_ARRAY((buffer).array, arena, status);                             \
+        REALLOC_ARRAY((buffer).array, nextPowerOfTwo(buffer_size), status);    \
+        if ((buffer).array.items == NULL) {                                    \
+            break;                                                             \
+        }                                                                      \
+        (buffer).array.size = 0;                                               \
+        (buffer).head = 0;                                                     \
+        (buffer).tail = 0;                                                     \
+        (buffer).mask = (buffer).array.alloc - 1;                              \
+    } while (0)
+
+#define POW2_BUFFER_SIZE(buffer) ((size_t)((buffer).tail - (buffer).head))
+#define POW2_BUFFER_CAPACITY(buffer) ((size_t)((buffer).mask + 1))
+
+// the head only moves when the push ran over the oldest item
+#define PUSH_POW2_BUFFER(buffer, item)                                         \
+    do {                                                                       \
+        (buffer).array.items[(buffer).tail & (buffer).mask] = item;            \
+        (buffer).tail++;                                                       \
+        (buffer).head += ((buffer).tail - (buffer).head) > (buffer).mask + 1;  \
+    } while (0)
+
+// copy the oldest item into item and drop it. Popping an empty buffer leaves
+// it empty but item gets whatever was in the slot so check the size first
+#define POP_FRONT_POW2_BUFFER(buffer, item)                                    \
+    do {                                                                       \
+        (item) = (buffer).array.items[(buffer).head & (buffer).mask];          \
+        (buffer).head += (buffer).head != (buffer).tail;                       \
+    } while (0)
+
+// pointer to the index'th oldest item. index has to be less than the size
+#define GET_POW2_ITEM(buffer, index)                                           \
+    (&(buffer).array.items[((buffer).head + (index)) & (buffer).mask])
+
+#define CLEAR_POW2_BUFFER(buffer)                                              \
+    do {                                                                       \
+        (buffer).head = 0;                                                     \
+        (buffer).tail = 0;                                                     \
+    } while (0)
+
 #endif
@@ -0,0 +1,373 @@
+#include "rope.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "string.h"
+#include <stdint.h>
+#include <string.h>
+
+// node building shares one failure flag so the recursive helpers don't need
+// to check every return
+struct RopeEdit {
+    struct Rope *rope;
+    int status;
+};
+
+static inline size_t nodeSize(const struct RopeNode *node) {
+    return node == NULL ? 0 : node->size;
+}
+
+static inline void updateSize(struct RopeNode *node) {
+    node->size = nodeSize(node->left) + node->chunkSize + nodeSize(node->right);
+}
+
+static uint32_t nextPriority(struct Rope *rope) {
+    // xorshift64
+    rope->random ^= rope->random << 13;
+    rope->random ^= rope->random >> 7;
+    rope->random ^= rope->random << 17;
+    return (uint32_t)(rope->random >> 32);
+}
+
+static struct RopeNode *copyNode(struct RopeEdit *edit,
+                                 const struct RopeNode *node) {
+    struct RopeNode *copy =
+        mallocArena(&edit->rope->arena, sizeof(struct RopeNode));
+    if (copy == NULL) {
+        DEBUG_ERROR("The rope was unable to allocate a node");
+        edit->status = FAILEDALLOC;
+        return NULL;
+    }
+    *copy = *node;
+    return copy;
+}
+
+static struct RopeNode *newNode(struct RopeEdit *edit, const char *chunk,
+                                size_t chunkSize) {
+    struct RopeNode node = {NULL, NULL, chunk, chunkSize, chunkSize,
+                            nextPriority(edit->rope)};
+    return copyNode(edit, &node);
+}
+
+// every node in left comes before every node in right
+static struct RopeNode *merge(struct RopeEdit *edit, struct RopeNode *left,
+                              struct RopeNode *right) {
+    if (left == NULL || edit->status != OK) {
+        return right;
+    }
+    if (right == NULL) {
+        return left;
+    }
+    if (left->priority > right->priority) {
+        struct RopeNode *copy = copyNode(edit, left);
+        if (copy == NULL) {
+            return NULL;
+        }
+        copy->right = merge(edit, left->right, right);
+        updateSize(copy);
+        return copy;
+    }
+    struct RopeNode *copy = copyNode(edit, right);
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->left = merge(edit, left, right->left);
+    updateSize(copy);
+    return copy;
+}
+
+// split into the first position bytes and the rest. A chunk that straddles the
+// split becomes two views of the same bytes
+static void split(struct RopeEdit *edit, struct RopeNode *node,
+                  size_t position, struct RopeNode **left,
+                  struct RopeNode **right) {
+    if (node == NULL || position == 0 || edit->status != OK) {
+        *left = NULL;
+        *right = node;
+        return;
+    }
+    if (position >= node->size) {
+        *left = node;
+        *right = NULL;
+        return;
+    }
+    size_t leftSize = nodeSize(node->left);
+    if (position <= leftSize) {
+        struct RopeNode *copy = copyNode(edit, node);
+        if (copy == NULL) {
+            return;
+        }
+        split(edit, node->left, position, left, &copy->left);
+        updateSize(copy);
+        *right = copy;
+        return;
+    }
+    if (position >= leftSize + node->chunkSize) {
+        struct RopeNode *copy = copyNode(edit, node);
+        if (copy == NULL) {
+            return;
+        }
+        split(edit, node->right, position - leftSize - node->chunkSize,
+              &copy->right, right);
+        updateSize(copy);
+        *left = copy;
+        return;
+    }
+    // both halves keep the priority, which is fine since each is the root of
+    // its own side
+    size_t offset = position - leftSize;
+    struct RopeNode *first = copyNode(edit, node);
+    struct RopeNode *second = copyNode(edit, node);
+    if (first == NULL || second == NULL) {
+        return;
+    }
+    first->chunkSize = offset;
+    first->right = NULL;
+    updateSize(first);
+    second->chunk = node->chunk + offset;
+    second->chunkSize = node->chunkSize - offset;
+    second->left = NULL;
+    updateSize(second);
+    *left = first;
+    *right = second;
+}
+
+static const struct RopeNode *lastNode(const struct RopeNode *node) {
+    while (node != NULL && node->right != NULL) {
+        node = node->right;
+    }
+    return node;
+}
+
+int initRope(struct Rope *rope, struct Arena *arena) {
+    if (rope == NULL || arena == NULL) {
+        DEBUG_ERROR("`initRope` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    rope->root = NULL;
+    rope->arena = arena;
+    rope->random = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)rope;
+    return OK;
+}
+
+int appendRopeView(struct Rope *rope, const String *string) {
+    if (rope == NULL || string == NULL) {
+        DEBUG_ERROR("`appendRopeView` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (string->size == 0) {
+        return OK;
+    }
+    struct RopeEdit edit = {rope, OK};
+    struct RopeNode *node = newNode(&edit, string->items, string->size);
+    struct RopeNode *root = merge(&edit, rope->root, node);
+    if (edit.status == OK) {
+        rope->root = root;
+    }
+    return edit.status;
+}
+
+int insertRope(struct Rope *rope, size_t position, const char *text,
+               size_t size) {
+    if (rope == NULL || (text == NULL && size != 0)) {
+        DEBUG_ERROR("`insertRope` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (position > ropeSize(rope)) {
+        DEBUG_ERROR("`insertRope` was given a position past the end");
+        return INVALIDARGS;
+    }
+    if (size == 0) {
+        return OK;
+    }
+    struct RopeEdit edit = {rope, OK};
+    struct RopeNode *left = NULL;
+    struct RopeNode *right = NULL;
+    split(&edit, rope->root, position, &left, &right);
+    // fold a small insert into the chunk in front of it so the node count
+    // doesn't grow with every keystroke
+    const struct RopeNode *previous = lastNode(left);
+    size_t prefix = 0;
+    if (previous != NULL && size <= ROPE_MERGE_SIZE &&
+        previous->chunkSize + size <= ROPE_MERGE_SIZE) {
+        prefix = previous->chunkSize;
+        struct RopeNode *dropped = NULL;
+        split(&edit, left, nodeSize(left) - prefix, &left, &dropped);
+    }
+    char *copy = mallocArena(&rope->arena, prefix + size);
+    if (copy == NULL) {
+        DEBUG_ERROR("`insertRope` was unable to copy the text");
+        return FAILEDALLOC;
+    }
+    if (prefix != 0) {
+        memcpy(copy, previous->chunk, prefix);
+    }
+    memcpy(copy + prefix, text, size);
+    struct RopeNode *node = newNode(&edit, copy, prefix + size);
+    struct RopeNode *root = merge(&edit, merge(&edit, left, node), right);
+    if (edit.status == OK) {
+        rope->root = root;
+    }
+    return edit.status;
+}
+
+int deleteRope(struct Rope *rope, size_t position, size_t count) {
+    if (rope == NULL) {
+        DEBUG_ERROR("`deleteRope` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    size_t size = ropeSize(rope);
+    if (position > size) {
+        DEBUG_ERROR("`deleteRope` was given a position past the end");
+        return INVALIDARGS;
+    }
+    count = count < size - position ? count : size - position;
+    if (count == 0) {
+        return OK;
+    }
+    struct RopeEdit edit = {rope, OK};
+    struct RopeNode *left = NULL;
+    struct RopeNode *middle = NULL;
+    struct RopeNode *right = NULL;
+    split(&edit, rope->root, position, &left, &right);
+    split(&edit, right, count, &middle, &right);
+    struct RopeNode *root = merge(&edit, left, right);
+    if (edit.status == OK) {
+        rope->root = root;
+    }
+    return edit.status;
+}
+
+int concatRope(struct Rope *rope, const struct Rope *other) {
+    if (rope == NULL || other == NULL) {
+        DEBUG_ERROR("`concatRope` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    struct RopeEdit edit = {rope, OK};
+    struct RopeNode *root = merge(&edit, rope->root, other->root);
+    if (edit.status == OK) {
+        rope->root = root;
+    }
+    return edit.status;
+}
+
+int substringRope(const struct Rope *rope, size_t start, size_t count,
+                  struct Rope *result) {
+    if (rope == NULL || result == NULL) {
+        DEBUG_ERROR("`substringRope` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    size_t size = ropeSize(rope);
+    start = start < size ? start : size;
+    count = count < size - start ? count : size - start;
+    struct Rope substring = *rope;
+    // so the two ropes don't hand out the same priorities
+    substring.random ^= (uint64_t)(uintptr_t)result;
+    struct RopeEdit edit = {&substring, OK};
+    struct RopeNode *left = NULL;
+    struct RopeNode *middle = NULL;
+    struct RopeNode *right = NULL;
+    split(&edit, rope->root, start, &left, &right);
+    split(&edit, right, count, &middle, &right);
+    if (edit.status != OK) {
+        return edit.status;
+    }
+    substring.root = middle;
+    *result = substring;
+    return OK;
+}
+
+char ropeCharAt(const struct Rope *rope, size_t index) {
+    if (rope == NULL || index >= ropeSize(rope)) {
+        DEBUG_ERROR("`ropeCharAt` was called with an index past the end");
+        return '\0';
+    }
+    const struct RopeNode *node = rope->root;
+    for (;;) {
+        size_t leftSize = nodeSize(node->left);
+        if (index < leftSize) {
+            node = node->left;
+        }
+        else if (index < leftSize + node->chunkSize) {
+            return node->chunk[index - leftSize];
+        }
+        else {
+            index -= leftSize + node->chunkSize;
+            node = node->right;
+        }
+    }
+}
+
+static int pushLeftSpine(struct RopeIterator *iterator,
+                         struct RopeNode *node) {
+    int status = OK;
+    while (node != NULL) {
+        PUSH_ARRAY(iterator->stack, node, status);
+        if (status != OK) {
+            return status;
+        }
+        node = node->left;
+    }
+    return OK;
+}
+
+int initRopeIterator(struct RopeIterator *iterator, const struct Rope *rope) {
+    if (iterator == NULL || rope == NULL) {
+        DEBUG_ERROR("`initRopeIterator` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    int status = OK;
+    INIT_ARRAY(iterator->stack, rope->arena, status);
+    if (status != OK) {
+        return status;
+    }
+    return pushLeftSpine(iterator, rope->root);
+}
+
+int nextRopeChunk(struct RopeIterator *iterator, String *chunk) {
+    if (iterator == NULL || chunk == NULL) {
+        DEBUG_ERROR("`nextRopeChunk` was called with a null pointer");
+        return 0;
+    }
+    if (iterator->stack.size == 0) {
+        return 0;
+    }
+    struct RopeNode *node = iterator->stack.items[--iterator->stack.size];
+    chunk->items = (char *)node->chunk;
+    chunk->size = node->chunkSize;
+    chunk->alloc = node->chunkSize;
+    chunk->arena = iterator->stack.arena;
+    if (pushLeftSpine(iterator, node->right) != OK) {
+        // stop rather than skip part of the text
+        iterator->stack.size = 0;
+    }
+    return 1;
+}
+
+struct StringReturn flattenRope(const struct Rope *rope) {
+    struct StringReturn returnValue = {NEW_ARRAY(), OK};
+    if (rope == NULL) {
+        DEBUG_ERROR("`flattenRope` was called with a null pointer");
+        returnValue.status = NULLPOINTER;
+        return returnValue;
+    }
+    size_t size = ropeSize(rope);
+    struct Arena *arena = rope->arena;
+    char *text = mallocArena(&arena, size + 1);
+    struct RopeIterator iterator;
+    if (text == NULL || initRopeIterator(&iterator, rope) != OK) {
+        DEBUG_ERROR("`flattenRope` was unable to allocate the string");
+        returnValue.status = FAILEDALLOC;
+        return returnValue;
+    }
+    size_t written = 0;
+    String chunk;
+    while (nextRopeChunk(&iterator, &chunk)) {
+        memcpy(text + written, chunk.items, chunk.size);
+        written += chunk.size;
+    }
+    text[written] = '\0';
+    String string = {text, written, size + 1, arena};
+    returnValue.string = string;
+    return returnValue;
+}
@@ -0,0 +1,76 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Text as a balanced tree of chunks so edits in the middle of a large buffer
+// don't move everything after them. The tree is a treap ordered by position.
+// Each node holds one chunk, which is a view into memory the rope doesn't own
+// or into a copy the rope made in the arena.
+//
+// Nodes are never changed once built. An edit copies the O(log n) nodes on
+// the path it touches and shares the rest, so a substring or an older copy of
+// a rope stays valid while the original keeps being edited. The arena is never
+// given anything back, so long editing sessions should build the final text
+// and start again in a fresh arena from time to time.
+struct RopeNode {
+    struct RopeNode *left;
+    struct RopeNode *right;
+    const char *chunk;
+    size_t chunkSize;
+    // bytes in this whole subtree
+    size_t size;
+    uint32_t priority;
+};
+
+struct Rope {
+    struct RopeNode *root;
+    struct Arena *arena;
+    // state for the node priorities
+    uint64_t random;
+};
+
+// inserts this small or smaller are merged with the chunk before them so
+// typing a character at a time doesn't make a node per character
+#define ROPE_MERGE_SIZE 128
+
+int initRope(struct Rope *rope, struct Arena *arena);
+
+static inline size_t ropeSize(const struct Rope *rope) {
+    return rope->root == NULL ? 0 : rope->root->size;
+}
+
+// add a view of string to the end without copying it. The string has to
+// outlive the rope, which is the point for something like a mapped file
+int appendRopeView(struct Rope *rope, const String *string);
+// copy size bytes of text into the arena and insert them at position
+int insertRope(struct Rope *rope, size_t position, const char *text,
+               size_t size);
+// remove count bytes starting at position. count is clamped to the end
+int deleteRope(struct Rope *rope, size_t position, size_t count);
+// put other on the end of rope. other is not changed and shares its nodes
+int concatRope(struct Rope *rope, const struct Rope *other);
+// set result to count bytes of rope starting at start without copying any
+// text. Both are clamped to the rope like sliceString
+int substringRope(const struct Rope *rope, size_t start, size_t count,
+                  struct Rope *result);
+
+// the byte at index. index has to be less than the size
+char ropeCharAt(const struct Rope *rope, size_t index);
+
+// Hands out the chunks in order as String views
+struct RopeIterator {
+    ARRAY(struct RopeNode *) stack;
+};
+
+int initRopeIterator(struct RopeIterator *iterator, const struct Rope *rope);
+// puts the next chunk in chunk. Returns 0 once there are none left
+int nextRopeChunk(struct RopeIterator *iterator, String *chunk);
+
+// copy the whole rope into one null terminated string in the arena
+struct StringReturn flattenRope(const struct Rope *rope);
+#endif
@@ -0,0 +1,1426 @@
+#include "simd.h"
+#include "array.h"
+#include "debug.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define SIMD_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#endif
+
+static int detectedLevel = SIMD_SCALAR;
+static int currentLevel = SIMD_SCALAR;
+
+// runs before main so the kernels never have to check if the cpu has been
+// looked at yet
+__attribute__((constructor)) static void detectSimdLevel(void) {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        detectedLevel = SIMD_AVX2;
+    }
+    else if (__builtin_cpu_supports("sse4.2")) {
+        detectedLevel = SIMD_SSE42;
+    }
+#endif
+    currentLevel = detectedLevel;
+}
+
+int getSimdLevel(void) { return currentLevel; }
+
+int setSimdLevel(int level) {
+    if (level < SIMD_SCALAR) {
+        level = SIMD_SCALAR;
+    }
+    currentLevel = level > detectedLevel ? detectedLevel : level;
+    return currentLevel;
+}
+
+// only the power of two sizes that fit in a lane get the vector kernels
+static inline int isLaneSize(size_t itemSize) {
+    return itemSize == 1 || itemSize == 2 || itemSize == 4 || itemSize == 8;
+}
+
+// scalar kernels. These are also used for the tails of the vector kernels
+static size_t findScalar(const char *bytes, size_t count, size_t itemSize,
+                         const void *value, size_t start) {
+    if (itemSize == 1) {
+        const char *found =
+            memchr(bytes + start, *(const unsigned char *)value, count - start);
+        return found == NULL ? SIMD_NOT_FOUND : (size_t)(found - bytes);
+    }
+    for (size_t i = start; i < count; i++) {
+        if (!memcmp(bytes + (i * itemSize), value, itemSize)) {
+            return i;
+        }
+    }
+    return SIMD_NOT_FOUND;
+}
+
+static size_t countScalar(const char *bytes, size_t count, size_t itemSize,
+                          const void *value, size_t start) {
+    size_t total = 0;
+    for (size_t i = start; i < count; i++) {
+        total += !memcmp(bytes + (i * itemSize), value, itemSize);
+    }
+    return total;
+}
+
+static void fillScalar(char *bytes, size_t count, size_t itemSize,
+                       const void *value, size_t start) {
+    if (start >= count) {
+        return;
+    }
+    if (itemSize == 1) {
+        memset(bytes + start, *(const unsigned char *)value, count - start);
+        return;
+    }
+    // copy the first item and then keep doubling the filled region
+    char *region = bytes + (start * itemSize);
+    size_t total = (count - start) * itemSize;
+    memcpy(region, value, itemSize);
+    size_t filled = itemSize;
+    while (filled < total) {
+        size_t copySize = filled < total - filled ? filled : total - filled;
+        memcpy(region + filled, region, copySize);
+        filled += copySize;
+    }
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET_AVX2 static inline __m256i broadcastAvx2(const void *value,
+                                                     size_t itemSize) {
+    switch (itemSize) {
+    case 1: {
+        int8_t lane = 0;
+        memcpy(&lane, value, 1);
+        return _mm256_set1_epi8(lane);
+    }
+    case 2: {
+        int16_t lane = 0;
+        memcpy(&lane, value, 2);
+        return _mm256_set1_epi16(lane);
+    }
+    case 4: {
+        int32_t lane = 0;
+        memcpy(&lane, value, 4);
+        return _mm256_set1_epi32(lane);
+    }
+    default: {
+        int64_t lane = 0;
+        memcpy(&lane, value, 8);
+        return _mm256_set1_epi64x(lane);
+    }
+    }
+}
+
+SIMD_TARGET_AVX2 static inline uint32_t matchMaskAvx2(__m256i chunk,
+                                                      __m256i needle,
+                                                      size_t itemSize) {
+    __m256i matches;
+    switch (itemSize) {
+    case 1:
+        matches = _mm256_cmpeq_epi8(chunk, needle);
+        break;
+    case 2:
+        matches = _mm256_cmpeq_epi16(chunk, needle);
+        break;
+    case 4:
+        matches = _mm256_cmpeq_epi32(chunk, needle);
+        break;
+    default:
+        matches = _mm256_cmpeq_epi64(chunk, needle);
+        break;
+    }
+    return (uint32_t)_mm256_movemask_epi8(matches);
+}
+
+SIMD_TARGET_AVX2 static size_t findAvx2(const char *bytes, size_t count,
+                                        size_t itemSize, const void *value) {
+    __m256i needle = broadcastAvx2(value, itemSize);
+    size_t totalBytes = count * itemSize;
+    size_t offset = 0;
+    for (; offset + 32 <= totalBytes; offset += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(bytes + offset));
+        uint32_t mask = matchMaskAvx2(chunk, needle, itemSize);
+        if (mask != 0) {
+            return (offset + __builtin_ctz(mask)) / itemSize;
+        }
+    }
+    return findScalar(bytes, count, itemSize, value, offset / itemSize);
+}
+
+SIMD_TARGET_AVX2 static size_t countAvx2(const char *bytes, size_t count,
+                                         size_t itemSize, const void *value) {
+    __m256i needle = broadcastAvx2(value, itemSize);
+    size_t totalBytes = count * itemSize;
+    size_t offset = 0;
+    size_t matchedBytes = 0;
+    for (; offset + 32 <= totalBytes; offset += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(bytes + offset));
+        matchedBytes +=
+            __builtin_popcount(matchMaskAvx2(chunk, needle, itemSize));
+    }
+    return (matchedBytes / itemSize) +
+           countScalar(bytes, count, itemSize, value, offset / itemSize);
+}
+
+SIMD_TARGET_AVX2 static int equalAvx2(const char *first, const char *second,
+                                      size_t size) {
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(first + offset));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(second + offset));
+        __m256i difference = _mm256_xor_si256(a, b);
+        if (!_mm256_testz_si256(difference, difference)) {
+            return 0;
+        }
+    }
+    return !memcmp(first + offset, second + offset, size - offset);
+}
+
+SIMD_TARGET_AVX2 static void fillAvx2(char *bytes, size_t count,
+                                      size_t itemSize, const void *value) {
+    __m256i pattern = broadcastAvx2(value, itemSize);
+    size_t totalBytes = count * itemSize;
+    size_t offset = 0;
+    for (; offset + 32 <= totalBytes; offset += 32) {
+        _mm256_storeu_si256((__m256i *)(bytes + offset), pattern);
+    }
+    fillScalar(bytes, count, itemSize, value, offset / itemSize);
+}
+
+SIMD_TARGET_AVX2 static void minMaxInt32Avx2(const int32_t *items,
+                                             size_t count, int32_t *min,
+                                             int32_t *max) {
+    __m256i minLanes = _mm256_set1_epi32(items[0]);
+    __m256i maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(items + i));
+        minLanes = _mm256_min_epi32(minLanes, chunk);
+        maxLanes = _mm256_max_epi32(maxLanes, chunk);
+    }
+    int32_t minValues[8];
+    int32_t maxValues[8];
+    _mm256_storeu_si256((__m256i *)minValues, minLanes);
+    _mm256_storeu_si256((__m256i *)maxValues, maxLanes);
+    for (int lane = 0; lane < 8; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+SIMD_TARGET_AVX2 static void minMaxInt64Avx2(const int64_t *items,
+                                             size_t count, int64_t *min,
+                                             int64_t *max) {
+    // there is no 64 bit min/max in avx2 so compare and blend
+    __m256i minLanes = _mm256_set1_epi64x(items[0]);
+    __m256i maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(items + i));
+        minLanes = _mm256_blendv_epi8(minLanes, chunk,
+                                      _mm256_cmpgt_epi64(minLanes, chunk));
+        maxLanes = _mm256_blendv_epi8(maxLanes, chunk,
+                                      _mm256_cmpgt_epi64(chunk, maxLanes));
+    }
+    int64_t minValues[4];
+    int64_t maxValues[4];
+    _mm256_storeu_si256((__m256i *)minValues, minLanes);
+    _mm256_storeu_si256((__m256i *)maxValues, maxLanes);
+    for (int lane = 0; lane < 4; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+// minps/maxps return the second operand when either one is NaN. Keeping the
+// running value second gives the same answer as the scalar `<` loop
+SIMD_TARGET_AVX2 static void minMaxFloatAvx2(const float *items, size_t count,
+                                             float *min, float *max) {
+    __m256 minLanes = _mm256_set1_ps(items[0]);
+    __m256 maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 chunk = _mm256_loadu_ps(items + i);
+        minLanes = _mm256_min_ps(chunk, minLanes);
+        maxLanes = _mm256_max_ps(chunk, maxLanes);
+    }
+    float minValues[8];
+    float maxValues[8];
+    _mm256_storeu_ps(minValues, minLanes);
+    _mm256_storeu_ps(maxValues, maxLanes);
+    for (int lane = 0; lane < 8; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+SIMD_TARGET_AVX2 static void minMaxDoubleAvx2(const double *items,
+                                              size_t count, double *min,
+                                              double *max) {
+    __m256d minLanes = _mm256_set1_pd(items[0]);
+    __m256d maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d chunk = _mm256_loadu_pd(items + i);
+        minLanes = _mm256_min_pd(chunk, minLanes);
+        maxLanes = _mm256_max_pd(chunk, maxLanes);
+    }
+    double minValues[4];
+    double maxValues[4];
+    _mm256_storeu_pd(minValues, minLanes);
+    _mm256_storeu_pd(maxValues, maxLanes);
+    for (int lane = 0; lane < 4; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+SIMD_TARGET_SSE42 static inline __m128i broadcastSse42(const void *value,
+                                                       size_t itemSize) {
+    switch (itemSize) {
+    case 1: {
+        int8_t lane = 0;
+        memcpy(&lane, value, 1);
+        return _mm_set1_epi8(lane);
+    }
+    case 2: {
+        int16_t lane = 0;
+        memcpy(&lane, value, 2);
+        return _mm_set1_epi16(lane);
+    }
+    case 4: {
+        int32_t lane = 0;
+        memcpy(&lane, value, 4);
+        return _mm_set1_epi32(lane);
+    }
+    default: {
+        int64_t lane = 0;
+        memcpy(&lane, value, 8);
+        return _mm_set1_epi64x(lane);
+    }
+    }
+}
+
+SIMD_TARGET_SSE42 static inline uint32_t matchMaskSse42(__m128i chunk,
+                                                        __m128i needle,
+                                                        size_t itemSize) {
+    __m128i matches;
+    switch (itemSize) {
+    case 1:
+        matches = _mm_cmpeq_epi8(chunk, needle);
+        break;
+    case 2:
+        matches = _mm_cmpeq_epi16(chunk, needle);
+        break;
+    case 4:
+        matches = _mm_cmpeq_epi32(chunk, needle);
+        break;
+    default:
+        matches = _mm_cmpeq_epi64(chunk, needle);
+        break;
+    }
+    return (uint32_t)_mm_movemask_epi8(matches);
+}
+
+SIMD_TARGET_SSE42 static size_t findSse42(const char *bytes, size_t count,
+                                          size_t itemSize, const void *value) {
+    __m128i needle = broadcastSse42(value, itemSize);
+    size_t totalBytes = count * itemSize;
+    size_t offset = 0;
+    for (; offset + 16 <= totalBytes; offset += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + offset));
+        uint32_t mask = matchMaskSse42(chunk, needle, itemSize);
+        if (mask != 0) {
+            return (offset + __builtin_ctz(mask)) / itemSize;
+        }
+    }
+    return findScalar(bytes, count, itemSize, value, offset / itemSize);
+}
+
+SIMD_TARGET_SSE42 static size_t countSse42(const char *bytes, size_t count,
+                                           size_t itemSize,
+                                           const void *value) {
+    __m128i needle = broadcastSse42(value, itemSize);
+    size_t totalBytes = count * itemSize;
+    size_t offset = 0;
+    size_t matchedBytes = 0;
+    for (; offset + 16 <= totalBytes; offset += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + offset));
+        matchedBytes +=
+            __builtin_popcount(matchMaskSse42(chunk, needle, itemSize));
+    }
+    return (matchedBytes / itemSize) +
+           countScalar(bytes, count, itemSize, value, offset / itemSize);
+}
+
+SIMD_TARGET_SSE42 static int equalSse42(const char *first, const char *second,
+                                        size_t size) {
+    size_t offset = 0;
+    for (; offset + 16 <= size; offset += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(first + offset));
+        __m128i b = _mm_loadu_si128((const __m128i *)(second + offset));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) {
+            return 0;
+        }
+    }
+    return !memcmp(first + offset, second + offset, size - offset);
+}
+
+SIMD_TARGET_SSE42 static void fillSse42(char *bytes, size_t count,
+                                        size_t itemSize, const void *value) {
+    __m128i pattern = broadcastSse42(value, itemSize);
+    size_t totalBytes = count * itemSize;
+    size_t offset = 0;
+    for (; offset + 16 <= totalBytes; offset += 16) {
+        _mm_storeu_si128((__m128i *)(bytes + offset), pattern);
+    }
+    fillScalar(bytes, count, itemSize, value, offset / itemSize);
+}
+
+SIMD_TARGET_SSE42 static void minMaxInt32Sse42(const int32_t *items,
+                                               size_t count, int32_t *min,
+                                               int32_t *max) {
+    __m128i minLanes = _mm_set1_epi32(items[0]);
+    __m128i maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(items + i));
+        minLanes = _mm_min_epi32(minLanes, chunk);
+        maxLanes = _mm_max_epi32(maxLanes, chunk);
+    }
+    int32_t minValues[4];
+    int32_t maxValues[4];
+    _mm_storeu_si128((__m128i *)minValues, minLanes);
+    _mm_storeu_si128((__m128i *)maxValues, maxLanes);
+    for (int lane = 0; lane < 4; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+SIMD_TARGET_SSE42 static void minMaxInt64Sse42(const int64_t *items,
+                                               size_t count, int64_t *min,
+                                               int64_t *max) {
+    __m128i minLanes = _mm_set1_epi64x(items[0]);
+    __m128i maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(items + i));
+        minLanes =
+            _mm_blendv_epi8(minLanes, chunk, _mm_cmpgt_epi64(minLanes, chunk));
+        maxLanes =
+            _mm_blendv_epi8(maxLanes, chunk, _mm_cmpgt_epi64(chunk, maxLanes));
+    }
+    int64_t minValues[2];
+    int64_t maxValues[2];
+    _mm_storeu_si128((__m128i *)minValues, minLanes);
+    _mm_storeu_si128((__m128i *)maxValues, maxLanes);
+    for (int lane = 0; lane < 2; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+SIMD_TARGET_SSE42 static void minMaxFloatSse42(const float *items,
+                                               size_t count, float *min,
+                                               float *max) {
+    __m128 minLanes = _mm_set1_ps(items[0]);
+    __m128 maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 chunk = _mm_loadu_ps(items + i);
+        minLanes = _mm_min_ps(chunk, minLanes);
+        maxLanes = _mm_max_ps(chunk, maxLanes);
+    }
+    float minValues[4];
+    float maxValues[4];
+    _mm_storeu_ps(minValues, minLanes);
+    _mm_storeu_ps(maxValues, maxLanes);
+    for (int lane = 0; lane < 4; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+
+SIMD_TARGET_SSE42 static void minMaxDoubleSse42(const double *items,
+                                                size_t count, double *min,
+                                                double *max) {
+    __m128d minLanes = _mm_set1_pd(items[0]);
+    __m128d maxLanes = minLanes;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d chunk = _mm_loadu_pd(items + i);
+        minLanes = _mm_min_pd(chunk, minLanes);
+        maxLanes = _mm_max_pd(chunk, maxLanes);
+    }
+    double minValues[2];
+    double maxValues[2];
+    _mm_storeu_pd(minValues, minLanes);
+    _mm_storeu_pd(maxValues, maxLanes);
+    for (int lane = 0; lane < 2; lane++) {
+        *min = minValues[lane] < *min ? minValues[lane] : *min;
+        *max = maxValues[lane] > *max ? maxValues[lane] : *max;
+    }
+    for (; i < count; i++) {
+        *min = items[i] < *min ? items[i] : *min;
+        *max = items[i] > *max ? items[i] : *max;
+    }
+}
+#endif
+
+size_t findItem(const void *items, size_t count, size_t itemSize,
+                const void *value) {
+    if (items == NULL || value == NULL || count == 0 || itemSize == 0) {
+        return SIMD_NOT_FOUND;
+    }
+#ifdef SIMD_X86
+    if (isLaneSize(itemSize)) {
+        if (currentLevel == SIMD_AVX2) {
+            return findAvx2(items, count, itemSize, value);
+        }
+        if (currentLevel == SIMD_SSE42) {
+            return findSse42(items, count, itemSize, value);
+        }
+    }
+#endif
+    return findScalar(items, count, itemSize, value, 0);
+}
+
+size_t countItem(const void *items, size_t count, size_t itemSize,
+                 const void *value) {
+    if (items == NULL || value == NULL || count == 0 || itemSize == 0) {
+        return 0;
+    }
+#ifdef SIMD_X86
+    if (isLaneSize(itemSize)) {
+        if (currentLevel == SIMD_AVX2) {
+            return countAvx2(items, count, itemSize, value);
+        }
+        if (currentLevel == SIMD_SSE42) {
+            return countSse42(items, count, itemSize, value);
+        }
+    }
+#endif
+    return countScalar(items, count, itemSize, value, 0);
+}
+
+int equalBytes(const void *first, const void *second, size_t size) {
+    if (size == 0 || first == second) {
+        return 1;
+    }
+    if (first == NULL || second == NULL) {
+        return 0;
+    }
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        return equalAvx2(first, second, size);
+    }
+    if (currentLevel == SIMD_SSE42) {
+        return equalSse42(first, second, size);
+    }
+#endif
+    return !memcmp(first, second, size);
+}
+
+void fillItems(void *items, size_t count, size_t itemSize, const void *value) {
+    if (items == NULL || value == NULL || count == 0 || itemSize == 0) {
+        return;
+    }
+#ifdef SIMD_X86
+    if (isLaneSize(itemSize) && itemSize != 1) {
+        if (currentLevel == SIMD_AVX2) {
+            fillAvx2(items, count, itemSize, value);
+            return;
+        }
+        if (currentLevel == SIMD_SSE42) {
+            fillSse42(items, count, itemSize, value);
+            return;
+        }
+    }
+#endif
+    fillScalar(items, count, itemSize, value, 0);
+}
+
+// the scalar reductions are all the same loop so stamp them out
+#define MIN_MAX_SCALAR(items, count, min, max)                                 \
+    do {                                                                       \
+        for (size_t i = 1; i < (count); i++) {                                 \
+            *(min) = (items)[i] < *(min) ? (items)[i] : *(min);                \
+            *(max) = (items)[i] > *(max) ? (items)[i] : *(max);                \
+        }                                                                      \
+    } while (0)
+
+int minMaxInt32(const int32_t *items, size_t count, int32_t *min,
+                int32_t *max) {
+    if (items == NULL || min == NULL || max == NULL || count == 0) {
+        DEBUG_ERROR("`minMaxInt32` was called with an empty range");
+        return INVALIDARGS;
+    }
+    *min = items[0];
+    *max = items[0];
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        minMaxInt32Avx2(items, count, min, max);
+        return OK;
+    }
+    if (currentLevel == SIMD_SSE42) {
+        minMaxInt32Sse42(items, count, min, max);
+        return OK;
+    }
+#endif
+    MIN_MAX_SCALAR(items, count, min, max);
+    return OK;
+}
+
+int minMaxInt64(const int64_t *items, size_t count, int64_t *min,
+                int64_t *max) {
+    if (items == NULL || min == NULL || max == NULL || count == 0) {
+        DEBUG_ERROR("`minMaxInt64` was called with an empty range");
+        return INVALIDARGS;
+    }
+    *min = items[0];
+    *max = items[0];
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        minMaxInt64Avx2(items, count, min, max);
+        return OK;
+    }
+    if (currentLevel == SIMD_SSE42) {
+        minMaxInt64Sse42(items, count, min, max);
+        return OK;
+    }
+#endif
+    MIN_MAX_SCALAR(items, count, min, max);
+    return OK;
+}
+
+int minMaxFloat(const float *items, size_t count, float *min, float *max) {
+    if (items == NULL || min == NULL || max == NULL || count == 0) {
+        DEBUG_ERROR("`minMaxFloat` was called with an empty range");
+        return INVALIDARGS;
+    }
+    *min = items[0];
+    *max = items[0];
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        minMaxFloatAvx2(items, count, min, max);
+        return OK;
+    }
+    if (currentLevel == SIMD_SSE42) {
+        minMaxFloatSse42(items, count, min, max);
+        return OK;
+    }
+#endif
+    MIN_MAX_SCALAR(items, count, min, max);
+    return OK;
+}
+
+int minMaxDouble(const double *items, size_t count, double *min,
+                 double *max) {
+    if (items == NULL || min == NULL || max == NULL || count == 0) {
+        DEBUG_ERROR("`minMaxDouble` was called with an empty range");
+        return INVALIDARGS;
+    }
+    *min = items[0];
+    *max = items[0];
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        minMaxDoubleAvx2(items, count, min, max);
+        return OK;
+    }
+    if (currentLevel == SIMD_SSE42) {
+        minMaxDoubleSse42(items, count, min, max);
+        return OK;
+    }
+#endif
+    MIN_MAX_SCALAR(items, count, min, max);
+    return OK;
+}
+
+static inline uint64_t combineWord(uint64_t first, uint64_t second,
+                                   int operation) {
+    switch (operation) {
+    case SIMD_WORD_AND:
+        return first & second;
+    case SIMD_WORD_OR:
+        return first | second;
+    case SIMD_WORD_XOR:
+        return first ^ second;
+    default:
+        return first & ~second;
+    }
+}
+
+#ifdef SIMD_X86
+// the vector kernels return how many words they did and the scalar loop picks
+// up the rest
+SIMD_TARGET_AVX2 static size_t combineWordsAvx2(uint64_t *destination,
+                                                const uint64_t *first,
+                                                const uint64_t *second,
+                                                size_t count, int operation) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(first + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(second + i));
+        __m256i result;
+        switch (operation) {
+        case SIMD_WORD_AND:
+            result = _mm256_and_si256(a, b);
+            break;
+        case SIMD_WORD_OR:
+            result = _mm256_or_si256(a, b);
+            break;
+        case SIMD_WORD_XOR:
+            result = _mm256_xor_si256(a, b);
+            break;
+        default:
+            result = _mm256_andnot_si256(b, a);
+            break;
+        }
+        _mm256_storeu_si256((__m256i *)(destination + i), result);
+    }
+    return i;
+}
+
+SIMD_TARGET_SSE42 static size_t combineWordsSse42(uint64_t *destination,
+                                                  const uint64_t *first,
+                                                  const uint64_t *second,
+                                                  size_t count,
+                                                  int operation) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(first + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(second + i));
+        __m128i result;
+        switch (operation) {
+        case SIMD_WORD_AND:
+            result = _mm_and_si128(a, b);
+            break;
+        case SIMD_WORD_OR:
+            result = _mm_or_si128(a, b);
+            break;
+        case SIMD_WORD_XOR:
+            result = _mm_xor_si128(a, b);
+            break;
+        default:
+            result = _mm_andnot_si128(b, a);
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(destination + i), result);
+    }
+    return i;
+}
+
+// popcount with a nibble lookup table. Each byte lane counts its own bits and
+// the lanes are summed with sad before they can overflow
+SIMD_TARGET_AVX2 static size_t popcountAvx2(const uint64_t *words,
+                                            size_t count, size_t *done) {
+    const __m256i lookup =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i + 4 <= count) {
+        // a byte lane gains at most 8 per vector so flush after 31 vectors
+        __m256i partial = _mm256_setzero_si256();
+        for (int block = 0; block < 31 && i + 4 <= count; block++, i += 4) {
+            __m256i chunk = _mm256_loadu_si256((const __m256i *)(words + i));
+            __m256i low = _mm256_and_si256(chunk, lowMask);
+            __m256i high = _mm256_and_si256(_mm256_srli_epi16(chunk, 4),
+                                            lowMask);
+            partial = _mm256_add_epi8(
+                partial, _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                         _mm256_shuffle_epi8(lookup, high)));
+        }
+        total = _mm256_add_epi64(
+            total, _mm256_sad_epu8(partial, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    *done = i;
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// with the popcnt target this is one instruction per word
+SIMD_TARGET_SSE42 static size_t popcountSse42(const uint64_t *words,
+                                              size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += (size_t)__builtin_popcountll(words[i]);
+    }
+    return total;
+}
+
+SIMD_TARGET_AVX2 static size_t findWordNotEqualAvx2(const uint64_t *words,
+                                                    size_t count,
+                                                    uint64_t value,
+                                                    size_t *done) {
+    __m256i needle = _mm256_set1_epi64x((int64_t)value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(words + i));
+        uint32_t mask =
+            (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi64(chunk, needle));
+        if (mask != 0xFFFFFFFFU) {
+            return i + (__builtin_ctz(~mask) / 8);
+        }
+    }
+    *done = i;
+    return SIMD_NOT_FOUND;
+}
+
+SIMD_TARGET_SSE42 static size_t findWordNotEqualSse42(const uint64_t *words,
+                                                      size_t count,
+                                                      uint64_t value,
+                                                      size_t *done) {
+    __m128i needle = _mm_set1_epi64x((int64_t)value);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(words + i));
+        uint32_t mask =
+            (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi64(chunk, needle));
+        if (mask != 0xFFFFU) {
+            return i + (__builtin_ctz(~mask) / 8);
+        }
+    }
+    *done = i;
+    return SIMD_NOT_FOUND;
+}
+#endif
+
+void combineWords(uint64_t *destination, const uint64_t *first,
+                  const uint64_t *second, size_t count, int operation) {
+    if (destination == NULL || first == NULL || second == NULL) {
+        return;
+    }
+    size_t i = 0;
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        i = combineWordsAvx2(destination, first, second, count, operation);
+    }
+    else if (currentLevel == SIMD_SSE42) {
+        i = combineWordsSse42(destination, first, second, count, operation);
+    }
+#endif
+    for (; i < count; i++) {
+        destination[i] = combineWord(first[i], second[i], operation);
+    }
+}
+
+size_t popcountWords(const uint64_t *words, size_t count) {
+    if (words == NULL) {
+        return 0;
+    }
+    size_t total = 0;
+    size_t i = 0;
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        total = popcountAvx2(words, count, &i);
+    }
+    else if (currentLevel == SIMD_SSE42) {
+        return popcountSse42(words, count);
+    }
+#endif
+    for (; i < count; i++) {
+        total += (size_t)__builtin_popcountll(words[i]);
+    }
+    return total;
+}
+
+size_t findWordNotEqual(const uint64_t *words, size_t count, uint64_t value) {
+    if (words == NULL) {
+        return SIMD_NOT_FOUND;
+    }
+    size_t i = 0;
+#ifdef SIMD_X86
+    size_t found = SIMD_NOT_FOUND;
+    if (currentLevel == SIMD_AVX2) {
+        found = findWordNotEqualAvx2(words, count, value, &i);
+    }
+    else if (currentLevel == SIMD_SSE42) {
+        found = findWordNotEqualSse42(words, count, value, &i);
+    }
+    if (found != SIMD_NOT_FOUND) {
+        return found;
+    }
+#endif
+    for (; i < count; i++) {
+        if (words[i] != value) {
+            return i;
+        }
+    }
+    return SIMD_NOT_FOUND;
+}
+
+// substring and byte set search
+static size_t findBytesScalar(const char *haystack, size_t haystackSize,
+                              const char *needle, size_t needleSize,
+                              size_t start) {
+    while (start + needleSize <= haystackSize) {
+        const char *found =
+            memchr(haystack + start, (unsigned char)needle[0],
+                   haystackSize - needleSize + 1 - start);
+        if (found == NULL) {
+            return SIMD_NOT_FOUND;
+        }
+        if (!memcmp(found + 1, needle + 1, needleSize - 1)) {
+            return (size_t)(found - haystack);
+        }
+        start = (size_t)(found - haystack) + 1;
+    }
+    return SIMD_NOT_FOUND;
+}
+
+// one bit per byte value
+struct ByteSet {
+    uint64_t words[4];
+};
+
+static void buildByteSet(struct ByteSet *byteSet, const unsigned char *set,
+                         size_t setSize) {
+    memset(byteSet, 0, sizeof(*byteSet));
+    for (size_t i = 0; i < setSize; i++) {
+        byteSet->words[set[i] >> 6] |= (uint64_t)1 << (set[i] & 63);
+    }
+}
+
+static size_t findAnyByteScalar(const unsigned char *bytes, size_t count,
+                                const unsigned char *set, size_t setSize,
+                                size_t start) {
+    if (setSize == 1) {
+        return findScalar((const char *)bytes, count, 1, set, start);
+    }
+    struct ByteSet byteSet;
+    buildByteSet(&byteSet, set, setSize);
+    for (size_t i = start; i < count; i++) {
+        if ((byteSet.words[bytes[i] >> 6] >> (bytes[i] & 63)) & 1) {
+            return i;
+        }
+    }
+    return SIMD_NOT_FOUND;
+}
+
+#ifdef SIMD_X86
+// compare the first and the last byte of the needle at 32 positions at once and
+// only memcmp where both of them match. Needles are at least 2 bytes here
+SIMD_TARGET_AVX2 static size_t findBytesAvx2(const char *haystack,
+                                             size_t haystackSize,
+                                             const char *needle,
+                                             size_t needleSize, size_t *done) {
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[needleSize - 1]);
+    size_t offset = 0;
+    // the second load reads up to offset + needleSize + 30
+    for (; offset + needleSize + 31 <= haystackSize; offset += 32) {
+        __m256i firstBlock =
+            _mm256_loadu_si256((const __m256i *)(haystack + offset));
+        __m256i lastBlock = _mm256_loadu_si256(
+            (const __m256i *)(haystack + offset + needleSize - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first),
+                             _mm256_cmpeq_epi8(lastBlock, last)));
+        while (mask != 0) {
+            size_t position = offset + (size_t)__builtin_ctz(mask);
+            if (!memcmp(haystack + position + 1, needle + 1, needleSize - 2)) {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+    *done = offset;
+    return SIMD_NOT_FOUND;
+}
+
+SIMD_TARGET_SSE42 static size_t findBytesSse42(const char *haystack,
+                                               size_t haystackSize,
+                                               const char *needle,
+                                               size_t needleSize,
+                                               size_t *done) {
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needleSize - 1]);
+    size_t offset = 0;
+    for (; offset + needleSize + 15 <= haystackSize; offset += 16) {
+        __m128i firstBlock =
+            _mm_loadu_si128((const __m128i *)(haystack + offset));
+        __m128i lastBlock = _mm_loadu_si128(
+            (const __m128i *)(haystack + offset + needleSize - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(firstBlock, first),
+                          _mm_cmpeq_epi8(lastBlock, last)));
+        while (mask != 0) {
+            size_t position = offset + (size_t)__builtin_ctz(mask);
+            if (!memcmp(haystack + position + 1, needle + 1, needleSize - 2)) {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+    *done = offset;
+    return SIMD_NOT_FOUND;
+}
+
+// one compare per set byte. Only used for sets of up to 16 bytes
+SIMD_TARGET_AVX2 static size_t findAnyByteAvx2(const char *bytes,
+                                               size_t count, const char *set,
+                                               size_t setSize, size_t *done) {
+    __m256i needles[16];
+    for (size_t i = 0; i < setSize; i++) {
+        needles[i] = _mm256_set1_epi8(set[i]);
+    }
+    size_t offset = 0;
+    for (; offset + 32 <= count; offset += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(bytes + offset));
+        __m256i matches = _mm256_cmpeq_epi8(chunk, needles[0]);
+        for (size_t i = 1; i < setSize; i++) {
+            matches = _mm256_or_si256(matches,
+                                      _mm256_cmpeq_epi8(chunk, needles[i]));
+        }
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(matches);
+        if (mask != 0) {
+            return offset + (size_t)__builtin_ctz(mask);
+        }
+    }
+    *done = offset;
+    return SIMD_NOT_FOUND;
+}
+
+// pcmpestri checks a chunk against the whole set in one instruction
+SIMD_TARGET_SSE42 static size_t findAnyByteSse42(const char *bytes,
+                                                 size_t count,
+                                                 const char *set,
+                                                 size_t setSize,
+                                                 size_t *done) {
+    char setBytes[16] = {0};
+    memcpy(setBytes, set, setSize);
+    __m128i setVector = _mm_loadu_si128((const __m128i *)setBytes);
+    size_t offset = 0;
+    for (; offset + 16 <= count; offset += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + offset));
+        int index = _mm_cmpestri(setVector, (int)setSize, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                                     _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16) {
+            return offset + (size_t)index;
+        }
+    }
+    *done = offset;
+    return SIMD_NOT_FOUND;
+}
+#endif
+
+size_t findBytes(const void *haystack, size_t haystackSize, const void *needle,
+                 size_t needleSize) {
+    if (haystack == NULL || (needle == NULL && needleSize != 0) ||
+        needleSize > haystackSize) {
+        return SIMD_NOT_FOUND;
+    }
+    if (needleSize == 0) {
+        return 0;
+    }
+    if (needleSize == 1) {
+        return findItem(haystack, haystackSize, 1, needle);
+    }
+    size_t start = 0;
+#ifdef SIMD_X86
+    size_t found = SIMD_NOT_FOUND;
+    if (currentLevel == SIMD_AVX2) {
+        found = findBytesAvx2(haystack, haystackSize, needle, needleSize,
+                              &start);
+    }
+    else if (currentLevel == SIMD_SSE42) {
+        found = findBytesSse42(haystack, haystackSize, needle, needleSize,
+                               &start);
+    }
+    if (found != SIMD_NOT_FOUND) {
+        return found;
+    }
+#endif
+    return findBytesScalar(haystack, haystackSize, needle, needleSize, start);
+}
+
+size_t findAnyByte(const void *bytes, size_t count, const void *set,
+                   size_t setSize) {
+    if (bytes == NULL || set == NULL || count == 0 || setSize == 0) {
+        return SIMD_NOT_FOUND;
+    }
+    if (setSize == 1) {
+        return findItem(bytes, count, 1, set);
+    }
+    size_t start = 0;
+#ifdef SIMD_X86
+    size_t found = SIMD_NOT_FOUND;
+    if (setSize <= 16) {
+        if (currentLevel == SIMD_AVX2) {
+            found = findAnyByteAvx2(bytes, count, set, setSize, &start);
+        }
+        else if (currentLevel == SIMD_SSE42) {
+            found = findAnyByteSse42(bytes, count, set, setSize, &start);
+        }
+    }
+    if (found != SIMD_NOT_FOUND) {
+        return found;
+    }
+#endif
+    return findAnyByteScalar(bytes, count, set, setSize, start);
+}
+
+// UTF-8 validation with the lookup table method from Keiser and Lemire. Each
+// byte is checked against the one before it with three 16 entry tables, one
+// for the high nibble of the previous byte, one for its low nibble and one for
+// the high nibble of the byte itself. Each bit in the table entries is one kind
+// of error and a pair is bad if the three entries share a bit. Sequences of
+// three and four bytes are checked by looking two and three bytes back
+#define UTF8_TOO_SHORT (1 << 0)
+#define UTF8_TOO_LONG (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE (1 << 3)
+#define UTF8_SURROGATE (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTINUATIONS (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTINUATIONS)
+
+static const int8_t utf8FirstHigh[16] = {
+    // ascii
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    // continuation
+    (int8_t)UTF8_TWO_CONTINUATIONS, (int8_t)UTF8_TWO_CONTINUATIONS,
+    (int8_t)UTF8_TWO_CONTINUATIONS, (int8_t)UTF8_TWO_CONTINUATIONS,
+    // 1100, 1101, 1110 and 1111 leads
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4};
+
+static const int8_t utf8FirstLow[16] = {
+    (int8_t)(UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4),
+    (int8_t)(UTF8_CARRY | UTF8_OVERLONG_2),
+    (int8_t)UTF8_CARRY,
+    (int8_t)UTF8_CARRY,
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 |
+             UTF8_SURROGATE),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (int8_t)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000)};
+
+static const int8_t utf8SecondHigh[16] = {
+    // ascii
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    // 1000, 1001, 1010 and 1011 continuations
+    (int8_t)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS |
+             UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4),
+    (int8_t)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS |
+             UTF8_OVERLONG_3 | UTF8_TOO_LARGE),
+    (int8_t)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS |
+             UTF8_SURROGATE | UTF8_TOO_LARGE),
+    (int8_t)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS |
+             UTF8_SURROGATE | UTF8_TOO_LARGE),
+    // leads
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT};
+
+// checks the ranges from table 3-7 of the unicode standard one sequence at a
+// time, skipping ascii eight bytes at a time
+static int validUtf8Scalar(const unsigned char *bytes, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        uint64_t word;
+        if (i + 8 <= size) {
+            memcpy(&word, bytes + i, sizeof(word));
+            if ((word & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        unsigned char lead = bytes[i];
+        if (lead < 0x80) {
+            i++;
+            continue;
+        }
+        size_t length = 0;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            low = lead == 0xE0 ? 0xA0 : low;
+            high = lead == 0xED ? 0x9F : high;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            low = lead == 0xF0 ? 0x90 : low;
+            high = lead == 0xF4 ? 0x8F : high;
+        }
+        else {
+            return 0;
+        }
+        if (size - i < length || bytes[i + 1] < low || bytes[i + 1] > high) {
+            return 0;
+        }
+        for (size_t k = 2; k < length; k++) {
+            if ((bytes[i + k] & 0xC0) != 0x80) {
+                return 0;
+            }
+        }
+        i += length;
+    }
+    return 1;
+}
+
+// continuation bytes are 0x80 to 0xBF, which is -128 to -65 as signed bytes
+static size_t countUtf8Scalar(const char *bytes, size_t size, size_t start) {
+    size_t total = 0;
+    for (size_t i = start; i < size; i++) {
+        total += (signed char)bytes[i] > -65;
+    }
+    return total;
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET_AVX2 static inline __m256i highNibblesAvx2(__m256i bytes) {
+    return _mm256_and_si256(_mm256_srli_epi16(bytes, 4),
+                            _mm256_set1_epi8(0x0F));
+}
+
+// the bytes of input shifted back by count with the end of previous in front
+#define PREVIOUS_AVX2(input, previous, count)                                  \
+    _mm256_alignr_epi8(                                                        \
+        input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - (count))
+
+SIMD_TARGET_AVX2 static __m256i checkUtf8Avx2(__m256i input,
+                                              __m256i previous) {
+    __m256i firstHigh = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)utf8FirstHigh));
+    __m256i firstLow = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)utf8FirstLow));
+    __m256i secondHigh = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)utf8SecondHigh));
+    __m256i previous1 = PREVIOUS_AVX2(input, previous, 1);
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(firstHigh, highNibblesAvx2(previous1)),
+            _mm256_shuffle_epi8(
+                firstLow, _mm256_and_si256(previous1, _mm256_set1_epi8(0x0F)))),
+        _mm256_shuffle_epi8(secondHigh, highNibblesAvx2(input)));
+    // a byte two after a 111_____ lead or three after a 1111____ lead has to be
+    // a continuation. Those are the only places two continuations in a row
+    // are fine
+    __m256i third = _mm256_subs_epu8(PREVIOUS_AVX2(input, previous, 2),
+                                     _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(PREVIOUS_AVX2(input, previous, 3),
+                                      _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i mustContinue =
+        _mm256_and_si256(_mm256_or_si256(third, fourth),
+                         _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(mustContinue, special);
+}
+
+// nonzero where the last three bytes start a sequence that isn't finished
+SIMD_TARGET_AVX2 static __m256i incompleteUtf8Avx2(__m256i input) {
+    __m256i limit = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1),
+        (char)(0xE0 - 1), (char)(0xC0 - 1));
+    return _mm256_subs_epu8(input, limit);
+}
+
+SIMD_TARGET_AVX2 static int validUtf8Avx2(const char *bytes, size_t size) {
+    __m256i error = _mm256_setzero_si256();
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    size_t offset = 0;
+    for (;;) {
+        __m256i input;
+        if (offset + 32 <= size) {
+            input = _mm256_loadu_si256((const __m256i *)(bytes + offset));
+        }
+        else if (offset < size) {
+            // pad the end with zeros, which are ascii
+            char tail[32] = {0};
+            memcpy(tail, bytes + offset, size - offset);
+            input = _mm256_loadu_si256((const __m256i *)tail);
+        }
+        else {
+            break;
+        }
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, incomplete);
+            incomplete = _mm256_setzero_si256();
+        }
+        else {
+            error = _mm256_or_si256(error, checkUtf8Avx2(input, previous));
+            incomplete = incompleteUtf8Avx2(input);
+        }
+        previous = input;
+        offset += 32;
+    }
+    error = _mm256_or_si256(error, incomplete);
+    return _mm256_testz_si256(error, error);
+}
+
+SIMD_TARGET_AVX2 static size_t countUtf8Avx2(const char *bytes, size_t size) {
+    __m256i continuation = _mm256_set1_epi8(-65);
+    size_t total = 0;
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(bytes + offset));
+        total += (size_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpgt_epi8(chunk, continuation)));
+    }
+    return total + countUtf8Scalar(bytes, size, offset);
+}
+
+SIMD_TARGET_SSE42 static inline __m128i highNibblesSse42(__m128i bytes) {
+    return _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+}
+
+SIMD_TARGET_SSE42 static __m128i checkUtf8Sse42(__m128i input,
+                                                __m128i previous) {
+    __m128i firstHigh = _mm_loadu_si128((const __m128i *)utf8FirstHigh);
+    __m128i firstLow = _mm_loadu_si128((const __m128i *)utf8FirstLow);
+    __m128i secondHigh = _mm_loadu_si128((const __m128i *)utf8SecondHigh);
+    __m128i previous1 = _mm_alignr_epi8(input, previous, 15);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(
+            _mm_shuffle_epi8(firstHigh, highNibblesSse42(previous1)),
+            _mm_shuffle_epi8(firstLow,
+                             _mm_and_si128(previous1, _mm_set1_epi8(0x0F)))),
+        _mm_shuffle_epi8(secondHigh, highNibblesSse42(input)));
+    __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, previous, 14),
+                                  _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, previous, 13),
+                                   _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i mustContinue = _mm_and_si128(_mm_or_si128(third, fourth),
+                                         _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(mustContinue, special);
+}
+
+SIMD_TARGET_SSE42 static int validUtf8Sse42(const char *bytes, size_t size) {
+    __m128i limit = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                  -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1),
+                                  (char)(0xC0 - 1));
+    __m128i error = _mm_setzero_si128();
+    __m128i previous = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+    size_t offset = 0;
+    for (;;) {
+        __m128i input;
+        if (offset + 16 <= size) {
+            input = _mm_loadu_si128((const __m128i *)(bytes + offset));
+        }
+        else if (offset < size) {
+            char tail[16] = {0};
+            memcpy(tail, bytes + offset, size - offset);
+            input = _mm_loadu_si128((const __m128i *)tail);
+        }
+        else {
+            break;
+        }
+        if (_mm_movemask_epi8(input) == 0) {
+            error = _mm_or_si128(error, incomplete);
+            incomplete = _mm_setzero_si128();
+        }
+        else {
+            error = _mm_or_si128(error, checkUtf8Sse42(input, previous));
+            incomplete = _mm_subs_epu8(input, limit);
+        }
+        previous = input;
+        offset += 16;
+    }
+    error = _mm_or_si128(error, incomplete);
+    return _mm_testz_si128(error, error);
+}
+
+SIMD_TARGET_SSE42 static size_t countUtf8Sse42(const char *bytes,
+                                               size_t size) {
+    __m128i continuation = _mm_set1_epi8(-65);
+    size_t total = 0;
+    size_t offset = 0;
+    for (; offset + 16 <= size; offset += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + offset));
+        total += (size_t)__builtin_popcount(
+            (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, continuation)));
+    }
+    return total + countUtf8Scalar(bytes, size, offset);
+}
+#endif
+
+int validUtf8(const void *bytes, size_t size) {
+    if (size == 0) {
+        return 1;
+    }
+    if (bytes == NULL) {
+        return 0;
+    }
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        return validUtf8Avx2(bytes, size);
+    }
+    if (currentLevel == SIMD_SSE42) {
+        return validUtf8Sse42(bytes, size);
+    }
+#endif
+    return validUtf8Scalar(bytes, size);
+}
+
+size_t countUtf8Leads(const void *bytes, size_t size) {
+    if (bytes == NULL) {
+        return 0;
+    }
+#ifdef SIMD_X86
+    if (currentLevel == SIMD_AVX2) {
+        return countUtf8Avx2(bytes, size);
+    }
+    if (currentLevel == SIMD_SSE42) {
+        return countUtf8Sse42(bytes, size);
+    }
+#endif
+    return countUtf8Scalar(bytes, size, 0);
+}
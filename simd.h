@@ -0,0 +1,82 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Kernels for searching, comparing and filling memory. Each kernel has an
+// AVX2, an SSE4.2 and a plain C version and the best one the cpu supports is
+// picked when the program starts. The array and string headers wrap these so
+// most code should not need to call them directly.
+
+#define SIMD_NOT_FOUND ((size_t)-1)
+
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE42 = 1,
+    SIMD_AVX2 = 2,
+};
+
+// the level that is currently being used
+int getSimdLevel(void);
+// force a lower level. Asking for a level the cpu doesn't support will use the
+// highest supported level. Returns the level that is now in use
+int setSimdLevel(int level);
+
+// index of the first item that is bitwise equal to value or SIMD_NOT_FOUND.
+// Items of size 1, 2, 4 and 8 are vectorized and the rest fall back to memcmp
+size_t findItem(const void *items, size_t count, size_t itemSize,
+                const void *value);
+// number of items that are bitwise equal to value
+size_t countItem(const void *items, size_t count, size_t itemSize,
+                 const void *value);
+// returns 1 if both regions hold the same bytes
+int equalBytes(const void *first, const void *second, size_t size);
+// copy value into every one of the count items
+void fillItems(void *items, size_t count, size_t itemSize, const void *value);
+// index of the first place the needle shows up in the haystack or
+// SIMD_NOT_FOUND. An empty needle is found at 0. The vector kernels check the
+// first and last byte of the needle at every position at once and only compare
+// the whole needle where both of those match
+size_t findBytes(const void *haystack, size_t haystackSize, const void *needle,
+                 size_t needleSize);
+// index of the first byte that is any of the setSize bytes in set or
+// SIMD_NOT_FOUND. Sets of more than 16 bytes use a lookup table
+size_t findAnyByte(const void *bytes, size_t count, const void *set,
+                   size_t setSize);
+// returns 1 if the bytes are well formed UTF-8. Overlong forms, surrogates and
+// anything past U+10FFFF are rejected
+int validUtf8(const void *bytes, size_t size);
+// number of bytes that are not UTF-8 continuation bytes. For valid UTF-8 this
+// is the number of codepoints
+size_t countUtf8Leads(const void *bytes, size_t size);
+
+// min and max reductions. These return INVALIDARGS for an empty range. For
+// floats a NaN is skipped unless it is the first item, the same as a plain `<`
+// loop would do
+int minMaxInt32(const int32_t *items, size_t count, int32_t *min,
+                int32_t *max);
+int minMaxInt64(const int64_t *items, size_t count, int64_t *min,
+                int64_t *max);
+int minMaxFloat(const float *items, size_t count, float *min, float *max);
+int minMaxDouble(const double *items, size_t count, double *min,
+                 double *max);
+
+// word kernels for bitsets
+enum SimdWordOperation {
+    SIMD_WORD_AND = 0,
+    SIMD_WORD_OR = 1,
+    SIMD_WORD_XOR = 2,
+    // first & ~second
+    SIMD_WORD_ANDNOT = 3,
+};
+
+// destination[i] = first[i] op second[i]. destination can be first or second
+void combineWords(uint64_t *destination, const uint64_t *first,
+                  const uint64_t *second, size_t count, int operation);
+// number of set bits in the words
+size_t popcountWords(const uint64_t *words, size_t count);
+// index of the first word that is not value or SIMD_NOT_FOUND. Looking for
+// something other than 0 or ~0 skips over empty or full stretches of a bitset
+size_t findWordNotEqual(const uint64_t *words, size_t count, uint64_t value);
+#endif
@@ -0,0 +1,158 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include "arena.h" // NOLINT
+#include "array.h" // NOLINT
+#include "debug.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// A slot map hands out handles instead of pointers so items can move around
+// when the array grows or an item is removed. Live items are packed at the
+// front of `items` so looping over them is just looping over an array. Each
+// handle names a slot, the slot knows where its item is in the dense array and
+// a generation that gets bumped every time the slot is freed. A handle is only
+// good while its generation matches the slot's.
+struct SlotMapHandle {
+    uint32_t index;
+    uint32_t generation;
+};
+
+struct SlotMapSlot {
+    // position of the item in the dense array. Free slots use this to point at
+    // the next free slot
+    uint32_t dense;
+    uint32_t generation;
+};
+
+#define SLOTMAP_NO_SLOT UINT32_MAX
+#define SLOTMAP_NOT_FOUND SIZE_MAX
+// generations start at 1 so a zeroed handle is never valid
+#define NULL_SLOTMAP_HANDLE ((struct SlotMapHandle){0, 0})
+
+#define SLOTMAP(type)                                                          \
+    struct {                                                                   \
+        /* the live items with no gaps */                                      \
+        ARRAY(type) items;                                                     \
+        /* dense index -> slot index */                                        \
+        ARRAY(uint32_t) owners;                                                \
+        ARRAY(struct SlotMapSlot) slots;                                       \
+        uint32_t freeSlot;                                                     \
+    }
+
+#define NEW_SLOTMAP() {NEW_ARRAY(), NEW_ARRAY(), NEW_ARRAY(), SLOTMAP_NO_SLOT}
+
+// returns the dense index of the item or SLOTMAP_NOT_FOUND when the handle is
+// stale
+static inline size_t slotMapIndex(const struct SlotMapSlot *slots,
+                                  size_t slotCount,
+                                  struct SlotMapHandle handle) {
+    if (handle.index >= slotCount ||
+        slots[handle.index].generation != handle.generation) {
+        return SLOTMAP_NOT_FOUND;
+    }
+    return slots[handle.index].dense;
+}
+
+#define INIT_SLOTMAP(map, arena, status)                                       \
+    do {                                                                       \
+        INIT_ARRAY((map).items, arena, status);                                \
+        if ((status) != OK) {                                                  \
+            break;                                                             \
+        }                                                                      \
+        INIT_ARRAY((map).owners, arena, status);                               \
+        INIT_ARRAY((map).slots, arena, status);                                \
+        (map).freeSlot = SLOTMAP_NO_SLOT;                                      \
+    } while (0)
+
+#define SLOTMAP_SIZE(map) ((map).items.size)
+
+// add item to the map and write its handle out
+#define SLOTMAP_INSERT(map, item, handle, status)                              \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED((map).items)) {                                 \
+            DEBUG_ERROR("called SLOTMAP_INSERT with an unintialized map");     \
+            (status) = UNINITARRAY;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((map).items.size >= SLOTMAP_NO_SLOT) {                             \
+            DEBUG_ERROR("SLOTMAP_INSERT ran out of slots");                    \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        (status) = OK;                                                         \
+        PUSH_ARRAY((map).items, item, status);                                 \
+        if ((status) != OK) {                                                  \
+            break;                                                             \
+        }                                                                      \
+        uint32_t slotMapSlotIndex = (map).freeSlot;                            \
+        if (slotMapSlotIndex == SLOTMAP_NO_SLOT) {                             \
+            struct SlotMapSlot slotMapNewSlot = {0, 1};                        \
+            slotMapSlotIndex = (uint32_t)(map).slots.size;                     \
+            PUSH_ARRAY((map).slots, slotMapNewSlot, status);                   \
+        }                                                                      \
+        if ((status) == OK) {                                                  \
+            PUSH_ARRAY((map).owners, slotMapSlotIndex, status);                \
+        }                                                                      \
+        if ((status) != OK) {                                                  \
+            (map).items.size--;                                                \
+            break;                                                             \
+        }                                                                      \
+        if (slotMapSlotIndex == (map).freeSlot) {                              \
+            (map).freeSlot = (map).slots.items[slotMapSlotIndex].dense;        \
+        }                                                                      \
+        (map).slots.items[slotMapSlotIndex].dense =                            \
+            (uint32_t)(map).items.size - 1;                                    \
+        (handle).index = slotMapSlotIndex;                                     \
+        (handle).generation = (map).slots.items[slotMapSlotIndex].generation;  \
+    } while (0)
+
+// item is set to a pointer to the item or NULL if the handle is stale. The
+// pointer is only good until the next insert or remove
+#define SLOTMAP_GET(map, handle, item)                                         \
+    do {                                                                       \
+        size_t slotMapDense =                                                  \
+            slotMapIndex((map).slots.items, (map).slots.size, handle);         \
+        (item) = slotMapDense == SLOTMAP_NOT_FOUND                             \
+                     ? NULL                                                    \
+                     : &(map).items.items[slotMapDense];                       \
+    } while (0)
+
+#define SLOTMAP_CONTAINS(map, handle)                                          \
+    (slotMapIndex((map).slots.items, (map).slots.size, handle) !=              \
+     SLOTMAP_NOT_FOUND)
+
+// remove the item by moving the last item into its place. Removing with a
+// stale handle gives INVALIDARGS
+#define SLOTMAP_REMOVE(map, handle, status)                                    \
+    do {                                                                       \
+        struct SlotMapHandle slotMapRemoved = (handle);                        \
+        size_t slotMapDense =                                                  \
+            slotMapIndex((map).slots.items, (map).slots.size, slotMapRemoved); \
+        if (slotMapDense == SLOTMAP_NOT_FOUND) {                               \
+            DEBUG_ERROR("called SLOTMAP_REMOVE with a stale handle");          \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        size_t slotMapEnd = (map).items.size - 1;                              \
+        if (slotMapDense != slotMapEnd) {                                      \
+            (map).items.items[slotMapDense] = (map).items.items[slotMapEnd];   \
+            (map).owners.items[slotMapDense] = (map).owners.items[slotMapEnd]; \
+            (map).slots.items[(map).owners.items[slotMapDense]].dense =        \
+                (uint32_t)slotMapDense;                                        \
+        }                                                                      \
+        (map).items.size--;                                                    \
+        (map).owners.size--;                                                   \
+        struct SlotMapSlot *slotMapSlot =                                      \
+            &(map).slots.items[slotMapRemoved.index];                          \
+        /* skip 0 when the generation wraps so old handles stay dead */        \
+        slotMapSlot->generation++;                                             \
+        if (slotMapSlot->generation == 0) {                                    \
+            slotMapSlot->generation = 1;                                       \
+        }                                                                      \
+        slotMapSlot->dense = (map).freeSlot;                                   \
+        (map).freeSlot = slotMapRemoved.index;                                 \
+        (status) = OK;                                                         \
+    } while (0)
+
+#endif
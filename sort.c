@@ -0,0 +1,262 @@
+#include "sort.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include <stdint.h>
+#include <string.h>
+
+// below this size the histograms cost more than just sorting in place
+#define RADIX_INSERTION_THRESHOLD 64
+
+// LSD radix sort on unsigned keys one byte at a time. All of the histograms are
+// built in one pass over the keys and any byte that is the same for every key
+// is skipped. The scratch buffer comes from the arena and is handed back before
+// returning.
+#define RADIX_SORT_DEFINE(keyType, name)                                       \
+    static int name(keyType *keys, size_t count, struct Arena **arena) {       \
+        if (count < RADIX_INSERTION_THRESHOLD) {                               \
+            for (size_t i = 1; i < count; i++) {                               \
+                keyType current = keys[i];                                     \
+                size_t j = i;                                                  \
+                while (j > 0 && current < keys[j - 1]) {                       \
+                    keys[j] = keys[j - 1];                                     \
+                    j--;                                                       \
+                }                                                              \
+                keys[j] = current;                                             \
+            }                                                                  \
+            return OK;                                                         \
+        }                                                                      \
+        if (arena == NULL || *arena == NULL) {                                 \
+            DEBUG_ERROR("radix sort was called with a bad arena pointer");     \
+            return NULLPOINTER;                                                \
+        }                                                                      \
+        enum { DIGITS = sizeof(keyType) };                                     \
+        size_t histograms[DIGITS][256];                                        \
+        memset(histograms, 0, sizeof(histograms));                             \
+        for (size_t i = 0; i < count; i++) {                                   \
+            keyType key = keys[i];                                             \
+            for (int digit = 0; digit < DIGITS; digit++) {                     \
+                histograms[digit][(key >> (digit * 8)) & 0xFF]++;              \
+            }                                                                  \
+        }                                                                      \
+        *arena = getLastArenaNode(*arena);                                     \
+        void *restorePoint = startScratchPad(*arena);                          \
+        keyType *scratch = mallocArena(arena, count * sizeof(keyType));        \
+        if (scratch == NULL) {                                                 \
+            DEBUG_ERROR("radix sort was unable to get scratch memory");        \
+            return FAILEDALLOC;                                                \
+        }                                                                      \
+        keyType *source = keys;                                                \
+        keyType *destination = scratch;                                        \
+        for (int digit = 0; digit < DIGITS; digit++) {                         \
+            size_t *histogram = histograms[digit];                             \
+            /* every key has the same byte here so this pass is a no-op */     \
+            if (histogram[(source[0] >> (digit * 8)) & 0xFF] == count) {       \
+                continue;                                                      \
+            }                                                                  \
+            size_t offset = 0;                                                 \
+            for (int bucket = 0; bucket < 256; bucket++) {                     \
+                size_t bucketSize = histogram[bucket];                         \
+                histogram[bucket] = offset;                                    \
+                offset += bucketSize;                                          \
+            }                                                                  \
+            for (size_t i = 0; i < count; i++) {                               \
+                keyType key = source[i];                                       \
+                destination[histogram[(key >> (digit * 8)) & 0xFF]++] = key;   \
+            }                                                                  \
+            keyType *swap = source;                                            \
+            source = destination;                                              \
+            destination = swap;                                                \
+        }                                                                      \
+        if (source != keys) {                                                  \
+            memcpy(keys, source, count * sizeof(keyType));                     \
+        }                                                                      \
+        return restoreSratchPad(arena, restorePoint);                          \
+    }
+
+RADIX_SORT_DEFINE(uint32_t, radixSortKeys32)
+RADIX_SORT_DEFINE(uint64_t, radixSortKeys64)
+
+// The signed and float sorts flip bits so the unsigned order of the key matches
+// the order of the value, sort, and then flip them back
+static inline uint32_t flipSigned32(uint32_t key) { return key ^ 0x80000000U; }
+static inline uint64_t flipSigned64(uint64_t key) {
+    return key ^ 0x8000000000000000ULL;
+}
+// negative floats need every bit flipped so larger magnitudes sort first
+static inline uint32_t flipFloat(uint32_t key) {
+    uint32_t mask = (uint32_t)(-(int32_t)(key >> 31)) | 0x80000000U;
+    return key ^ mask;
+}
+static inline uint32_t unflipFloat(uint32_t key) {
+    uint32_t mask = ((key >> 31) - 1) | 0x80000000U;
+    return key ^ mask;
+}
+static inline uint64_t flipDouble(uint64_t key) {
+    uint64_t mask = (uint64_t)(-(int64_t)(key >> 63)) | 0x8000000000000000ULL;
+    return key ^ mask;
+}
+static inline uint64_t unflipDouble(uint64_t key) {
+    uint64_t mask = ((key >> 63) - 1) | 0x8000000000000000ULL;
+    return key ^ mask;
+}
+
+int radixSortUint32(uint32_t *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`radixSortUint32` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    return radixSortKeys32(items, count, arena);
+}
+
+int radixSortUint64(uint64_t *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`radixSortUint64` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    return radixSortKeys64(items, count, arena);
+}
+
+int radixSortInt32(int32_t *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`radixSortInt32` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    uint32_t *keys = (uint32_t *)items;
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = flipSigned32(keys[i]);
+    }
+    int status = radixSortKeys32(keys, count, arena);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = flipSigned32(keys[i]);
+    }
+    return status;
+}
+
+int radixSortInt64(int64_t *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`radixSortInt64` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    uint64_t *keys = (uint64_t *)items;
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = flipSigned64(keys[i]);
+    }
+    int status = radixSortKeys64(keys, count, arena);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = flipSigned64(keys[i]);
+    }
+    return status;
+}
+
+int radixSortFloat(float *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`radixSortFloat` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    _Static_assert(sizeof(float) == sizeof(uint32_t), "float must be 32 bits");
+    uint32_t *keys = (uint32_t *)items;
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = flipFloat(keys[i]);
+    }
+    int status = radixSortKeys32(keys, count, arena);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = unflipFloat(keys[i]);
+    }
+    return status;
+}
+
+int radixSortDouble(double *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`radixSortDouble` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    _Static_assert(sizeof(double) == sizeof(uint64_t),
+                   "double must be 64 bits");
+    uint64_t *keys = (uint64_t *)items;
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = flipDouble(keys[i]);
+    }
+    int status = radixSortKeys64(keys, count, arena);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = unflipDouble(keys[i]);
+    }
+    return status;
+}
+
+// Strings are sorted as (prefix, string, original index) entries. The prefix
+// is the first 8 bytes packed big endian so comparing two prefixes as integers
+// gives the same answer as memcmp on those bytes. The index breaks ties so the
+// sort is stable even though the introsort isn't.
+struct StringSortEntry {
+    uint64_t prefix;
+    const String *string;
+    size_t index;
+};
+
+static inline uint64_t stringPrefix(const String *string) {
+    uint64_t prefix = 0;
+    size_t size = string->size < 8 ? string->size : 8;
+    for (size_t i = 0; i < size; i++) {
+        prefix |= (uint64_t)(unsigned char)string->items[i] << (56 - (i * 8));
+    }
+    return prefix;
+}
+
+static inline int stringEntryLess(const struct StringSortEntry *first,
+                                  const struct StringSortEntry *second) {
+    if (first->prefix != second->prefix) {
+        return first->prefix < second->prefix;
+    }
+    // the first 8 bytes match so only the rest of the string needs comparing
+    size_t firstSize = first->string->size;
+    size_t secondSize = second->string->size;
+    size_t shared = firstSize < secondSize ? firstSize : secondSize;
+    if (shared > 8) {
+        int compare = memcmp(first->string->items + 8,
+                             second->string->items + 8, shared - 8);
+        if (compare != 0) {
+            return compare < 0;
+        }
+    }
+    if (firstSize != secondSize) {
+        return firstSize < secondSize;
+    }
+    return first->index < second->index;
+}
+
+SORT_DEFINE(struct StringSortEntry, sortStringEntries, stringEntryLess)
+
+int sortStrings(String *items, size_t count, struct Arena **arena) {
+    if (items == NULL && count != 0) {
+        DEBUG_ERROR("`sortStrings` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (count < 2) {
+        return OK;
+    }
+    if (arena == NULL || *arena == NULL) {
+        DEBUG_ERROR("`sortStrings` was called with a bad arena pointer");
+        return NULLPOINTER;
+    }
+    *arena = getLastArenaNode(*arena);
+    void *restorePoint = startScratchPad(*arena);
+    struct StringSortEntry *entries =
+        mallocArena(arena, count * sizeof(struct StringSortEntry));
+    String *sorted = mallocArena(arena, count * sizeof(String));
+    if (entries == NULL || sorted == NULL) {
+        DEBUG_ERROR("`sortStrings` was unable to get scratch memory");
+        return FAILEDALLOC;
+    }
+    for (size_t i = 0; i < count; i++) {
+        entries[i].prefix = stringPrefix(&items[i]);
+        entries[i].string = &items[i];
+        entries[i].index = i;
+    }
+    sortStringEntries(entries, count);
+    for (size_t i = 0; i < count; i++) {
+        sorted[i] = *entries[i].string;
+    }
+    memcpy(items, sorted, count * sizeof(String));
+    return restoreSratchPad(arena, restorePoint);
+}
@@ -0,0 +1,250 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Sorting for arrays. Integer and float keys use an LSD radix sort that borrows
+// a scratch buffer from the arena and gives it back when it is done. Strings
+// sort on a cached 8 byte prefix so most compares never touch the string
+// memory. All of these sorts are stable.
+int radixSortUint32(uint32_t *items, size_t count, struct Arena **arena);
+int radixSortInt32(int32_t *items, size_t count, struct Arena **arena);
+int radixSortUint64(uint64_t *items, size_t count, struct Arena **arena);
+int radixSortInt64(int64_t *items, size_t count, struct Arena **arena);
+// floats are sorted by their bit pattern so -0.0 comes before 0.0 and NaNs go
+// to the ends depending on their sign bit
+int radixSortFloat(float *items, size_t count, struct Arena **arena);
+int radixSortDouble(double *items, size_t count, struct Arena **arena);
+int sortStrings(String *items, size_t count, struct Arena **arena);
+
+// sort an array of any of the types above. This picks the sort based on the
+// type of the items
+#define SORT_ARRAY(array, status)                                              \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED(array)) {                                       \
+            DEBUG_ERROR("called SORT_ARRAY with an unintialized array");       \
+            (status) = UNINITARRAY;                                            \
+            break;                                                             \
+        }                                                                      \
+        (status) = _Generic(*(array).items,                                    \
+            uint32_t: radixSortUint32,                                         \
+            int32_t: radixSortInt32,                                           \
+            uint64_t: radixSortUint64,                                         \
+            int64_t: radixSortInt64,                                           \
+            float: radixSortFloat,                                             \
+            double: radixSortDouble,                                           \
+            String: sortStrings)((array).items, (array).size,                  \
+                                 &(array).arena);                              \
+    } while (0)
+
+// sort records with a sort made by SORT_DEFINE
+#define SORT_ARRAY_BY(array, name) name((array).items, (array).size)
+#define SORT_ARRAY_STABLE_BY(array, name, status)                              \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED(array)) {                                       \
+            DEBUG_ERROR("called SORT_ARRAY_STABLE_BY with an unintialized "    \
+                        "array");                                              \
+            (status) = UNINITARRAY;                                            \
+            break;                                                             \
+        }                                                                      \
+        (status) = name##Stable((array).items, (array).size, &(array).arena);  \
+    } while (0)
+
+#define SORT_INSERTION_THRESHOLD 16
+
+// Creates two sorts for records of `type`:
+//   void name(type *items, size_t count)
+//     introsort. Quick sort that falls back to heap sort when the recursion
+//     gets too deep. Not stable.
+//   int name##Stable(type *items, size_t count, struct Arena **arena)
+//     merge sort that uses the arena for a scratch buffer. Stable.
+// lessThan is called with two `const type *` and can be a macro so the compare
+// is inlined into the sort instead of going through a function pointer
+#define SORT_DEFINE(type, name, lessThan)                                      \
+    static inline void name##Insertion(type *items, size_t count) {            \
+        for (size_t i = 1; i < count; i++) {                                   \
+            type current = items[i];                                           \
+            size_t j = i;                                                      \
+            while (j > 0 && lessThan(&current, &items[j - 1])) {               \
+                items[j] = items[j - 1];                                       \
+                j--;                                                           \
+            }                                                                  \
+            items[j] = current;                                                \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name##SiftDown(type *items, size_t root,                \
+                                      size_t count) {                          \
+        for (;;) {                                                             \
+            size_t child = (2 * root) + 1;                                     \
+            if (child >= count) {                                              \
+                return;                                                        \
+            }                                                                  \
+            if (child + 1 < count &&                                           \
+                lessThan(&items[child], &items[child + 1])) {                  \
+                child++;                                                       \
+            }                                                                  \
+            if (!lessThan(&items[root], &items[child])) {                      \
+                return;                                                        \
+            }                                                                  \
+            type swap = items[root];                                           \
+            items[root] = items[child];                                        \
+            items[child] = swap;                                               \
+            root = child;                                                      \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void name##HeapSort(type *items, size_t count) {             \
+        for (size_t i = count / 2; i > 0; i--) {                               \
+            name##SiftDown(items, i - 1, count);                               \
+        }                                                                      \
+        for (size_t end = count - 1; end > 0; end--) {                         \
+            type swap = items[0];                                              \
+            items[0] = items[end];                                             \
+            items[end] = swap;                                                 \
+            name##SiftDown(items, 0, end);                                     \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static void name##IntroSort(type *items, size_t count, int depth) {        \
+        while (count > SORT_INSERTION_THRESHOLD) {                             \
+            if (depth == 0) {                                                  \
+                name##HeapSort(items, count);                                  \
+                return;                                                        \
+            }                                                                  \
+            depth--;                                                           \
+            /* median of three moves the pivot to the front */                 \
+            size_t middle = count / 2;                                         \
+            type swap;                                                         \
+            if (lessThan(&items[middle], &items[0])) {                         \
+                swap = items[middle];                                          \
+                items[middle] = items[0];                                      \
+                items[0] = swap;                                               \
+            }                                                                  \
+            if (lessThan(&items[count - 1], &items[middle])) {                 \
+                swap = items[count - 1];                                       \
+                items[count - 1] = items[middle];                              \
+                items[middle] = swap;                                          \
+                if (lessThan(&items[middle], &items[0])) {                     \
+                    swap = items[middle];                                      \
+                    items[middle] = items[0];                                  \
+                    items[0] = swap;                                           \
+                }                                                              \
+            }                                                                  \
+            swap = items[middle];                                              \
+            items[middle] = items[0];                                          \
+            items[0] = swap;                                                   \
+            /* hoare partition around items[0] */                              \
+            size_t left = 0;                                                   \
+            size_t right = count;                                              \
+            for (;;) {                                                         \
+                do {                                                           \
+                    left++;                                                    \
+                } while (left < count && lessThan(&items[left], &items[0]));   \
+                do {                                                           \
+                    right--;                                                   \
+                } while (lessThan(&items[0], &items[right]));                  \
+                if (left >= right) {                                           \
+                    break;                                                     \
+                }                                                              \
+                swap = items[left];                                            \
+                items[left] = items[right];                                    \
+                items[right] = swap;                                           \
+            }                                                                  \
+            swap = items[0];                                                   \
+            items[0] = items[right];                                           \
+            items[right] = swap;                                               \
+            /* recurse into the smaller side to bound the stack */             \
+            size_t leftCount = right;                                          \
+            size_t rightCount = count - right - 1;                             \
+            if (leftCount < rightCount) {                                      \
+                name##IntroSort(items, leftCount, depth);                      \
+                items += right + 1;                                            \
+                count = rightCount;                                            \
+            }                                                                  \
+            else {                                                             \
+                name##IntroSort(items + right + 1, rightCount, depth);         \
+                count = leftCount;                                             \
+            }                                                                  \
+        }                                                                      \
+        name##Insertion(items, count);                                         \
+    }                                                                          \
+                                                                               \
+    static inline void name(type *items, size_t count) {                       \
+        if (items == NULL || count < 2) {                                      \
+            return;                                                            \
+        }                                                                      \
+        int depth = 0;                                                         \
+        for (size_t i = count; i > 1; i >>= 1) {                               \
+            depth += 2;                                                        \
+        }                                                                      \
+        name##IntroSort(items, count, depth);                                  \
+    }                                                                          \
+                                                                               \
+    static inline int name##Stable(type *items, size_t count,                  \
+                                   struct Arena **arena) {                     \
+        if (items == NULL || count < 2) {                                      \
+            return OK;                                                         \
+        }                                                                      \
+        if (count <= SORT_INSERTION_THRESHOLD) {                               \
+            name##Insertion(items, count);                                     \
+            return OK;                                                         \
+        }                                                                      \
+        if (arena == NULL || *arena == NULL) {                                 \
+            DEBUG_ERROR("Stable sort was called with a bad arena pointer");    \
+            return NULLPOINTER;                                                \
+        }                                                                      \
+        *arena = getLastArenaNode(*arena);                                     \
+        void *restorePoint = startScratchPad(*arena);                          \
+        type *scratch = mallocArena(arena, count * sizeof(type));              \
+        if (scratch == NULL) {                                                 \
+            DEBUG_ERROR("Stable sort was unable to get scratch memory");       \
+            return FAILEDALLOC;                                                \
+        }                                                                      \
+        for (size_t i = 0; i < count; i += SORT_INSERTION_THRESHOLD) {         \
+            size_t runSize = count - i < SORT_INSERTION_THRESHOLD              \
+                                 ? count - i                                   \
+                                 : SORT_INSERTION_THRESHOLD;                   \
+            name##Insertion(items + i, runSize);                               \
+        }                                                                      \
+        type *source = items;                                                  \
+        type *destination = scratch;                                           \
+        for (size_t width = SORT_INSERTION_THRESHOLD; width < count;           \
+             width *= 2) {                                                     \
+            for (size_t start = 0; start < count; start += 2 * width) {        \
+                size_t middle = start + width < count ? start + width : count; \
+                size_t end =                                                   \
+                    start + (2 * width) < count ? start + (2 * width) : count; \
+                size_t left = start;                                           \
+                size_t right = middle;                                         \
+                size_t out = start;                                            \
+                while (left < middle && right < end) {                         \
+                    /* only take the right item when it is strictly less */    \
+                    if (lessThan(&source[right], &source[left])) {             \
+                        destination[out++] = source[right++];                  \
+                    }                                                          \
+                    else {                                                     \
+                        destination[out++] = source[left++];                   \
+                    }                                                          \
+                }                                                              \
+                while (left < middle) {                                        \
+                    destination[out++] = source[left++];                       \
+                }                                                              \
+                while (right < end) {                                          \
+                    destination[out++] = source[right++];                      \
+                }                                                              \
+            }                                                                  \
+            type *swap = source;                                               \
+            source = destination;                                              \
+            destination = swap;                                                \
+        }                                                                      \
+        if (source != items) {                                                 \
+            memcpy(items, source, count * sizeof(type));                       \
+        }                                                                      \
+        return restoreSratchPad(arena, restorePoint);                          \
+    }
+#endif
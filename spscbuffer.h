@@ -0,0 +1,168 @@
+#ifndef SPSCBUFFER_H
+#define SPSCBUFFER_H
+
+#include "arena.h" // NOLINT
+#include "array.h" // NOLINT
+#include "debug.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define SPSC_CACHE_LINE 64
+
+// Ring buffer for handing items from one producer thread to one consumer
+// thread without locks. The producer only writes tail and the consumer only
+// writes head, and the two live on their own cache lines. Each side keeps a
+// private copy of the other side's index and only reloads it when the buffer
+// looks full or empty, so most calls never touch the other thread's cache
+// line. The capacity is rounded up to a power of two and the indexes count up
+// forever so the slot is the index masked.
+//
+// With overwrite set the producer can use PUSH_OVERWRITE_SPSC_BUFFER to drop
+// the oldest item when the buffer is full, like PUSH_BUFFER does. That means
+// both threads move head so the pop has to use a compare and swap, which is a
+// bit slower than the plain store used otherwise. The pop copies the slot
+// before the swap while the producer may be writing it, so in overwrite mode
+// the item type has to be trivially copyable. The value TRY_POP_SPSC_BUFFER
+// leaves in item is only valid when the swap succeeded and status is OK.
+// After a failed swap or a BUFFEREMPTY it can be a torn copy.
+//
+// The arena only aligns to max_align_t so the groups are kept apart with a
+// full line of padding instead of alignas.
+#define SPSC_BUFFER(type)                                                      \
+    struct {                                                                   \
+        /* set at init and only read after that */                             \
+        type *items;                                                           \
+        uint64_t mask;                                                         \
+        int overwrite;                                                         \
+        char sharedPadding[SPSC_CACHE_LINE];                                   \
+        /* producer side */                                                    \
+        _Atomic uint64_t tail;                                                 \
+        uint64_t cachedHead;                                                   \
+        char tailPadding[SPSC_CACHE_LINE];                                     \
+        /* consumer side */                                                    \
+        _Atomic uint64_t head;                                                 \
+        uint64_t cachedTail;                                                   \
+        char headPadding[SPSC_CACHE_LINE];                                     \
+    }
+
+// set up the buffer before it is shared with the other thread
+#define INIT_SPSC_BUFFER(buffer, arena, buffer_size, allowOverwrite, status)   \
+    do {                                                                       \
+        struct Arena *spscArena = (arena);                                     \
+        if (spscArena == NULL) {                                               \
+            DEBUG_ERROR("called INIT_SPSC_BUFFER with a null arena pointer");  \
+            (status) = NULLPOINTER;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((buffer_size) <= 1) {                                              \
+            DEBUG_ERROR("called INIT_SPSC_BUFFER with a size that is <= 1");   \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        size_t spscCapacity = nextPowerOfTwo(buffer_size);                     \
+        (buffer).items = mallocArena(&spscArena,                               \
+                                     spscCapacity * sizeof(*(buffer).items));  \
+        if ((buffer).items == NULL) {                                          \
+            DEBUG_ERROR("INIT_SPSC_BUFFER failed to allocate the buffer");     \
+            (status) = FAILEDALLOC;                                            \
+            break;                                                             \
+        }                                                                      \
+        (buffer).mask = spscCapacity - 1;                                      \
+        (buffer).overwrite = (allowOverwrite);                                 \
+        atomic_init(&(buffer).tail, 0);                                        \
+        atomic_init(&(buffer).head, 0);                                        \
+        (buffer).cachedHead = 0;                                               \
+        (buffer).cachedTail = 0;                                               \
+        (status) = OK;                                                         \
+    } while (0)
+
+#define SPSC_BUFFER_CAPACITY(buffer) ((size_t)((buffer).mask + 1))
+// only a snapshot since the other thread can be moving
+#define SPSC_BUFFER_SIZE(buffer)                                               \
+    ((size_t)(atomic_load_explicit(&(buffer).tail, memory_order_acquire) -     \
+              atomic_load_explicit(&(buffer).head, memory_order_acquire)))
+
+// producer only. status is BUFFERFULL if there was no room
+#define TRY_PUSH_SPSC_BUFFER(buffer, item, status)                             \
+    do {                                                                       \
+        uint64_t spscTail =                                                    \
+            atomic_load_explicit(&(buffer).tail, memory_order_relaxed);        \
+        if (spscTail - (buffer).cachedHead > (buffer).mask) {                  \
+            (buffer).cachedHead =                                              \
+                atomic_load_explicit(&(buffer).head, memory_order_acquire);    \
+            if (spscTail - (buffer).cachedHead > (buffer).mask) {              \
+                (status) = BUFFERFULL;                                         \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        (buffer).items[spscTail & (buffer).mask] = item;                       \
+        atomic_store_explicit(&(buffer).tail, spscTail + 1,                    \
+                              memory_order_release);                           \
+        (status) = OK;                                                         \
+    } while (0)
+
+// producer only. Drops the oldest item when the buffer is full. The buffer
+// has to have been set up with overwrite on
+#define PUSH_OVERWRITE_SPSC_BUFFER(buffer, item, status)                       \
+    do {                                                                       \
+        if (!(buffer).overwrite) {                                             \
+            DEBUG_ERROR("called PUSH_OVERWRITE_SPSC_BUFFER on a buffer "       \
+                        "without overwrite");                                  \
+            (status) = INVALIDARGS;                                            \
+            break;                                                             \
+        }                                                                      \
+        uint64_t spscTail =                                                    \
+            atomic_load_explicit(&(buffer).tail, memory_order_relaxed);        \
+        if (spscTail - (buffer).cachedHead > (buffer).mask) {                  \
+            (buffer).cachedHead =                                              \
+                atomic_load_explicit(&(buffer).head, memory_order_acquire);    \
+        }                                                                      \
+        /* a failed swap means the consumer took the item first. The swap */   \
+        /* reloads cachedHead so the loop checks again */                      \
+        while (spscTail - (buffer).cachedHead > (buffer).mask) {               \
+            if (atomic_compare_exchange_weak_explicit(                         \
+                    &(buffer).head, &(buffer).cachedHead,                      \
+                    (buffer).cachedHead + 1, memory_order_acq_rel,             \
+                    memory_order_acquire)) {                                   \
+                (buffer).cachedHead++;                                         \
+            }                                                                  \
+        }                                                                      \
+        (buffer).items[spscTail & (buffer).mask] = item;                       \
+        atomic_store_explicit(&(buffer).tail, spscTail + 1,                    \
+                              memory_order_release);                           \
+        (status) = OK;                                                         \
+    } while (0)
+
+// consumer only. status is BUFFEREMPTY if there was nothing to pop
+#define TRY_POP_SPSC_BUFFER(buffer, item, status)                              \
+    do {                                                                       \
+        (status) = BUFFEREMPTY;                                                \
+        uint64_t spscHead =                                                    \
+            atomic_load_explicit(&(buffer).head, memory_order_acquire);        \
+        for (;;) {                                                             \
+            if (spscHead >= (buffer).cachedTail) {                             \
+                (buffer).cachedTail = atomic_load_explicit(                    \
+                    &(buffer).tail, memory_order_acquire);                     \
+                if (spscHead >= (buffer).cachedTail) {                         \
+                    break;                                                     \
+                }                                                              \
+            }                                                                  \
+            (item) = (buffer).items[spscHead & (buffer).mask];                 \
+            if (!(buffer).overwrite) {                                         \
+                atomic_store_explicit(&(buffer).head, spscHead + 1,            \
+                                      memory_order_release);                   \
+                (status) = OK;                                                 \
+                break;                                                         \
+            }                                                                  \
+            /* the producer may have dropped this item while it was being */   \
+            /* read. In that case the swap fails and the next one is tried */  \
+            if (atomic_compare_exchange_strong_explicit(                       \
+                    &(buffer).head, &spscHead, spscHead + 1,                   \
+                    memory_order_acq_rel, memory_order_acquire)) {             \
+                (status) = OK;                                                 \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+#endif
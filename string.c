@@ -82,3 +82,201 @@ struct StringReturn copyStringFromString(String *string) {
     }
     return returnValue;
 }
+
+size_t findChar(String *string, char character) {
+    if (string == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `findChar`");
+        return ARRAY_NOT_FOUND;
+    }
+    return findItem(string->items, string->size, 1, &character);
+}
+
+size_t countChar(String *string, char character) {
+    if (string == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `countChar`");
+        return 0;
+    }
+    return countItem(string->items, string->size, 1, &character);
+}
+
+String sliceString(const String *string, size_t start, size_t size) {
+    String view = NEW_ARRAY();
+    if (string == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `sliceString`");
+        return view;
+    }
+    if (start > string->size) {
+        start = string->size;
+    }
+    if (size > string->size - start) {
+        size = string->size - start;
+    }
+    view.items = string->items == NULL ? NULL : string->items + start;
+    view.size = size;
+    view.alloc = size;
+    view.arena = string->arena;
+    return view;
+}
+
+size_t findString(const String *string, const String *needle) {
+    if (string == NULL || needle == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `findString`");
+        return ARRAY_NOT_FOUND;
+    }
+    if (needle->size == 0) {
+        return 0;
+    }
+    return findBytes(string->items, string->size, needle->items, needle->size);
+}
+
+int startsWith(const String *string, const String *prefix) {
+    if (string == NULL || prefix == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `startsWith`");
+        return 0;
+    }
+    return prefix->size <= string->size &&
+           equalBytes(string->items, prefix->items, prefix->size);
+}
+
+int endsWith(const String *string, const String *suffix) {
+    if (string == NULL || suffix == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `endsWith`");
+        return 0;
+    }
+    return suffix->size <= string->size &&
+           equalBytes(string->items + (string->size - suffix->size),
+                      suffix->items, suffix->size);
+}
+
+int stringsEqual(const String *first, const String *second) {
+    if (first == NULL || second == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `stringsEqual`");
+        return first == second;
+    }
+    return first->size == second->size &&
+           equalBytes(first->items, second->items, first->size);
+}
+
+int compareStrings(const String *first, const String *second) {
+    if (first == NULL || second == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `compareStrings`");
+        return 0;
+    }
+    size_t shared = first->size < second->size ? first->size : second->size;
+    int order = shared == 0 ? 0 : memcmp(first->items, second->items, shared);
+    if (order != 0) {
+        return order < 0 ? -1 : 1;
+    }
+    if (first->size == second->size) {
+        return 0;
+    }
+    return first->size < second->size ? -1 : 1;
+}
+
+static inline int isSpace(char character) {
+    return character == ' ' || character == '\t' || character == '\n' ||
+           character == '\r' || character == '\v' || character == '\f';
+}
+
+String trimLeft(const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `trimLeft`");
+        return (String)NEW_ARRAY();
+    }
+    size_t start = 0;
+    while (start < string->size && isSpace(string->items[start])) {
+        start++;
+    }
+    return sliceString(string, start, string->size - start);
+}
+
+String trimRight(const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `trimRight`");
+        return (String)NEW_ARRAY();
+    }
+    size_t size = string->size;
+    while (size > 0 && isSpace(string->items[size - 1])) {
+        size--;
+    }
+    return sliceString(string, 0, size);
+}
+
+String trimString(const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `trimString`");
+        return (String)NEW_ARRAY();
+    }
+    String left = trimLeft(string);
+    return trimRight(&left);
+}
+
+void initStringSplitter(struct StringSplitter *splitter, const String *string,
+                        const char *separators, size_t separatorCount) {
+    if (splitter == NULL || string == NULL ||
+        (separators == NULL && separatorCount != 0)) {
+        DEBUG_ERROR("NUll pointer has passed to `initStringSplitter`");
+        return;
+    }
+    splitter->rest = *string;
+    splitter->separators = separators;
+    splitter->separatorCount = separatorCount;
+    splitter->done = 0;
+}
+
+int nextSplit(struct StringSplitter *splitter, String *field) {
+    if (splitter == NULL || field == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `nextSplit`");
+        return 0;
+    }
+    if (splitter->done) {
+        return 0;
+    }
+    String *rest = &splitter->rest;
+    size_t index = findAnyByte(rest->items, rest->size, splitter->separators,
+                               splitter->separatorCount);
+    if (index == SIMD_NOT_FOUND) {
+        *field = *rest;
+        splitter->done = 1;
+        return 1;
+    }
+    *field = sliceString(rest, 0, index);
+    *rest = sliceString(rest, index + 1, rest->size - index - 1);
+    return 1;
+}
+
+int nextToken(struct StringSplitter *splitter, String *token) {
+    while (nextSplit(splitter, token)) {
+        if (token->size != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int splitStringAny(const String *string, const char *separators,
+                   size_t separatorCount, StringArray *fields) {
+    if (string == NULL || fields == NULL) {
+        DEBUG_ERROR("NUll pointer has passed to `splitStringAny`");
+        return NULLPOINTER;
+    }
+    if (!ARRAY_INITIALIZED(*fields)) {
+        DEBUG_ERROR("`splitStringAny` was given an uninitialized array");
+        return UNINITARRAY;
+    }
+    struct StringSplitter splitter;
+    initStringSplitter(&splitter, string, separators, separatorCount);
+    String field;
+    int status = OK;
+    while (nextSplit(&splitter, &field)) {
+        PUSH_ARRAY(*fields, field, status);
+        if (status != OK) {
+            return status;
+        }
+    }
+    return OK;
+}
+
+int splitString(const String *string, char separator, StringArray *fields) {
+    return splitStringAny(string, &separator, 1, fields);
+}
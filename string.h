@@ -5,6 +5,7 @@
 #include <stddef.h>
 
 typedef ARRAY(char) String;
+typedef ARRAY(String) StringArray;
 
 struct StringReturn {
     String string;
@@ -29,4 +30,56 @@ struct StringReturn copyStringFromChar(char *string, size_t size,
                                        struct Arena *arena);
 
 struct StringReturn copyStringFromString(String *string);
+
+// index of the first occurrence of the character or ARRAY_NOT_FOUND. This is
+// memchr for strings that are not null terminated
+size_t findChar(String *string, char character);
+
+// number of times the character shows up in the string
+size_t countChar(String *string, char character);
+
+// Views. None of these copy bytes. The returned strings point into the string
+// they were made from so that one has to outlive them. Appending to a view
+// will move it into its own memory since alloc is the same as the size.
+
+// a view of size bytes starting at start. Both are clamped to the string
+String sliceString(const String *string, size_t start, size_t size);
+
+// index of the first occurrence of needle or ARRAY_NOT_FOUND
+size_t findString(const String *string, const String *needle);
+
+int startsWith(const String *string, const String *prefix);
+int endsWith(const String *string, const String *suffix);
+
+// 1 if both strings hold the same bytes
+int stringsEqual(const String *first, const String *second);
+// byte order like memcmp. A string sorts after its own prefixes
+int compareStrings(const String *first, const String *second);
+
+// drop spaces, tabs, and newlines from the ends
+String trimString(const String *string);
+String trimLeft(const String *string);
+String trimRight(const String *string);
+
+// Walks the fields between separators one at a time. Empty fields are kept so
+// "a,,b" gives "a", "", "b" and an empty string gives one empty field. The
+// separators are not copied and have to stay around while splitting.
+struct StringSplitter {
+    String rest;
+    const char *separators;
+    size_t separatorCount;
+    int done;
+};
+
+void initStringSplitter(struct StringSplitter *splitter, const String *string,
+                        const char *separators, size_t separatorCount);
+// puts the next field in field. Returns 0 once there are no fields left
+int nextSplit(struct StringSplitter *splitter, String *field);
+// like nextSplit but skips empty fields, so runs of separators count as one
+int nextToken(struct StringSplitter *splitter, String *token);
+
+// push every field onto fields, which has to be initialized. Returns a status
+int splitString(const String *string, char separator, StringArray *fields);
+int splitStringAny(const String *string, const char *separators,
+                   size_t separatorCount, StringArray *fields);
 #endif
@@ -0,0 +1,184 @@
+#include "stringbuilder.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "number.h"
+#include "string.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STRING_BUILDER_MIN_CAPACITY 64
+
+int initStringBuilder(struct StringBuilder *builder, struct Arena *arena,
+                      size_t capacity) {
+    if (builder == NULL || arena == NULL) {
+        DEBUG_ERROR("`initStringBuilder` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    int status = 0;
+    INIT_ARRAY(builder->string, arena, status);
+    builder->status = OK;
+    if (capacity != 0) {
+        return reserveStringBuilder(builder, capacity);
+    }
+    return status;
+}
+
+int reserveStringBuilder(struct StringBuilder *builder, size_t count) {
+    if (builder == NULL) {
+        DEBUG_ERROR("`reserveStringBuilder` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (builder->status != OK) {
+        return builder->status;
+    }
+    String *string = &builder->string;
+    // one extra for the null finishStringBuilder puts on the end
+    size_t needed = string->size + count + 1;
+    if (needed <= string->alloc) {
+        return OK;
+    }
+    size_t capacity = string->alloc * 2;
+    if (capacity < STRING_BUILDER_MIN_CAPACITY) {
+        capacity = STRING_BUILDER_MIN_CAPACITY;
+    }
+    if (capacity < needed) {
+        capacity = needed;
+    }
+    char *items =
+        reallocArena(&string->arena, string->items, string->alloc, capacity);
+    if (items == NULL) {
+        DEBUG_ERROR("`reserveStringBuilder` was unable to grow the string");
+        builder->status = FAILEDALLOC;
+        return FAILEDALLOC;
+    }
+    string->items = items;
+    string->alloc = capacity;
+    return OK;
+}
+
+int appendChars(struct StringBuilder *builder, const char *chars, size_t size) {
+    if (builder == NULL || (chars == NULL && size != 0)) {
+        DEBUG_ERROR("`appendChars` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    int status = reserveStringBuilder(builder, size);
+    if (status != OK) {
+        return status;
+    }
+    if (size != 0) {
+        memcpy(builder->string.items + builder->string.size, chars, size);
+    }
+    builder->string.size += size;
+    return OK;
+}
+
+int appendCString(struct StringBuilder *builder, const char *chars) {
+    if (chars == NULL) {
+        DEBUG_ERROR("`appendCString` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    return appendChars(builder, chars, strlen(chars));
+}
+
+int appendString(struct StringBuilder *builder, const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("`appendString` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    return appendChars(builder, string->items, string->size);
+}
+
+int appendChar(struct StringBuilder *builder, char character) {
+    return appendChars(builder, &character, 1);
+}
+
+int appendUint(struct StringBuilder *builder, uint64_t value) {
+    char digits[NUMBER_BUFFER_SIZE];
+    return appendChars(builder, digits, formatUint64(digits, value));
+}
+
+int appendInt(struct StringBuilder *builder, int64_t value) {
+    char digits[NUMBER_BUFFER_SIZE];
+    return appendChars(builder, digits, formatInt64(digits, value));
+}
+
+int appendDouble(struct StringBuilder *builder, double value, int precision) {
+    return appendFormat(builder, "%.*f", precision, value);
+}
+
+int appendShortestDouble(struct StringBuilder *builder, double value) {
+    char digits[NUMBER_BUFFER_SIZE];
+    return appendChars(builder, digits, formatDouble(digits, value));
+}
+
+int appendFormat(struct StringBuilder *builder, const char *format, ...) {
+    if (builder == NULL || format == NULL) {
+        DEBUG_ERROR("`appendFormat` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (builder->status != OK) {
+        return builder->status;
+    }
+    // first try to format into the space that is already there. Only when it
+    // doesn't fit do we grow and format a second time
+    String *string = &builder->string;
+    size_t space = string->alloc - string->size;
+    va_list arguments;
+    va_start(arguments, format);
+    va_list retry;
+    va_copy(retry, arguments);
+    int length = vsnprintf(space != 0 ? string->items + string->size : NULL,
+                           space, format, arguments);
+    va_end(arguments);
+    if (length < 0) {
+        va_end(retry);
+        DEBUG_ERROR("`appendFormat` was given a bad format");
+        return INVALIDARGS;
+    }
+    // vsnprintf needs room for its null too
+    if ((size_t)length >= space) {
+        int status = reserveStringBuilder(builder, (size_t)length);
+        if (status != OK) {
+            va_end(retry);
+            return status;
+        }
+        vsnprintf(string->items + string->size, (size_t)length + 1, format,
+                  retry);
+    }
+    va_end(retry);
+    string->size += (size_t)length;
+    return OK;
+}
+
+struct StringReturn finishStringBuilder(struct StringBuilder *builder) {
+    struct StringReturn returnValue = {NEW_ARRAY(), 0};
+    if (builder == NULL) {
+        DEBUG_ERROR("`finishStringBuilder` was called with a null pointer");
+        returnValue.status = NULLPOINTER;
+        return returnValue;
+    }
+    if (builder->status != OK) {
+        returnValue.status = builder->status;
+        return returnValue;
+    }
+    // make sure there is a block to hand back even if nothing was appended
+    int status = reserveStringBuilder(builder, 0);
+    if (status != OK) {
+        returnValue.status = status;
+        return returnValue;
+    }
+    String *string = &builder->string;
+    string->items[string->size] = '\0';
+    // give the spare capacity back. This only does anything when the string
+    // is still the last allocation in the arena
+    string->items = reallocArena(&string->arena, string->items, string->alloc,
+                                 string->size + 1);
+    string->alloc = string->size;
+    returnValue.string = *string;
+    struct Arena *arena = string->arena;
+    INIT_ARRAY(builder->string, arena, status);
+    return returnValue;
+}
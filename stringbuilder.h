@@ -0,0 +1,47 @@
+#ifndef STRINGBUILDER_H
+#define STRINGBUILDER_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Builds a String by appending to one arena block. The block grows with
+// reallocArena, so while the builder owns the last allocation in the arena it
+// grows in place with no copy. Capacity doubles when it has to move so appends
+// are amortized O(1).
+//
+// The first error sticks in status and every append after it does nothing, so
+// a run of appends can be checked once at the end.
+struct StringBuilder {
+    String string;
+    int status;
+};
+
+int initStringBuilder(struct StringBuilder *builder, struct Arena *arena,
+                      size_t capacity);
+
+// make sure count more chars fit without growing
+int reserveStringBuilder(struct StringBuilder *builder, size_t count);
+
+int appendChars(struct StringBuilder *builder, const char *chars, size_t size);
+int appendCString(struct StringBuilder *builder, const char *chars);
+int appendString(struct StringBuilder *builder, const String *string);
+int appendChar(struct StringBuilder *builder, char character);
+int appendInt(struct StringBuilder *builder, int64_t value);
+int appendUint(struct StringBuilder *builder, uint64_t value);
+// printf %.*f
+int appendDouble(struct StringBuilder *builder, double value, int precision);
+// the fewest digits that read back as the same double, see formatDouble
+int appendShortestDouble(struct StringBuilder *builder, double value);
+// printf style formatting written straight into the builder
+int appendFormat(struct StringBuilder *builder, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// hand the built string over. It is null terminated past its size for C
+// functions and the spare capacity is given back to the arena when it can be.
+// The builder is empty afterwards and can be used again
+struct StringReturn finishStringBuilder(struct StringBuilder *builder);
+
+#endif
@@ -2,6 +2,7 @@
 #include "unittest.h"
 #include <stdalign.h> // alignof, max_align_t
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 struct Arena *createArenaNode(struct Arena *prev, int size);
@@ -259,6 +260,55 @@ static void testMemoryAlignment(struct Arena *testArena) {
     burnItDown(&arena);
 }
 
+static void testLastArenaNode(struct Arena *testArena) {
+    (void)testArena;
+    struct Arena *arena = createArena();
+    struct Arena *first = arena;
+    // fill the first node so the next alloc has to make a new one
+    float *x = mallocArena(&arena, arena->size);
+    ASSERT_TRUE(x != NULL, "check malloc'ed pointer status");
+    float *y = mallocArena(&arena, 10 * sizeof(float));
+    ASSERT_TRUE(y != NULL, "check malloc'ed pointer status");
+    ASSERT_TRUE(first->nextNode != NULL, "check a second node was made");
+    ASSERT_TRUE(getLastArenaNode(first) == first->nextNode,
+                "check the last node is found from the first");
+    ASSERT_TRUE(getLastArenaNode(arena) == arena,
+                "check the last node returns itself");
+    ASSERT_TRUE(getLastArenaNode(NULL) == NULL, "Check safe null returns");
+    burnItDown(&arena);
+}
+
+static void testReallocArena(struct Arena *testArena) {
+    (void)testArena;
+    struct Arena *arena = createArena();
+    struct Arena *first = arena;
+    char *a = mallocArena(&arena, 16);
+    memset(a, 'a', 16);
+    // a is the last allocation so it grows where it is
+    char *grown = reallocArena(&arena, a, 16, 64);
+    size_t offset = first->currentOffset;
+    ASSERT_TRUE(grown == a, "check grow in place");
+    ASSERT_TRUE(offset == (size_t)(a - (char *)first->start) + 64,
+                "check the offset moved");
+    grown = reallocArena(&arena, a, 64, 32);
+    offset = first->currentOffset;
+    ASSERT_TRUE(grown == a && offset == (size_t)(a - (char *)first->start) + 32,
+                "check shrink in place");
+
+    // something else after it means it has to be copied
+    char *b = mallocArena(&arena, 8);
+    char *moved = reallocArena(&arena, a, 32, 48);
+    ASSERT_TRUE(b != NULL && moved != a, "check copy when not last");
+    ASSERT_TRUE(moved[0] == 'a' && moved[15] == 'a', "check copied bytes");
+
+    // too big for the node goes to a new node
+    char *large = reallocArena(&arena, moved, 48, first->size * 2);
+    ASSERT_TRUE(large != NULL && large != moved && large[15] == 'a',
+                "check copy to a new node");
+    ASSERT_TRUE(reallocArena(NULL, a, 1, 2) == NULL, "Check safe null returns");
+    burnItDown(&arena);
+}
+
 static void testArenaFaults(struct Arena *testArena) {
     (void)testArena;
     DEBUG_PRINT("`testArenaFaults` will trigger many Error prints. As long as "
@@ -312,6 +362,8 @@ int runArenaTests(void) {
     ADD_TEST(testFreeArena);
     ADD_TEST(testScratchPad);
     ADD_TEST(testMemoryAlignment);
+    ADD_TEST(testLastArenaNode);
+    ADD_TEST(testReallocArena);
     ADD_TEST(testArenaFaults);
     return runTest();
 }
@@ -183,6 +183,153 @@ static void testFaults(struct Arena *arrayArena) {
     ASSERT_TRUE(status == OK, "status check");
 }
 
+// run the check at every simd level the cpu supports so the vector and scalar
+// kernels are held to the same answers
+static void testFindCount(struct Arena *arrayArena) {
+    ARRAY(int16_t) collection = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(collection, arrayArena, status);
+    ASSERT_TRUE(status == OK, "status check");
+    for (int i = 0; i < 100; i++) {
+        PUSH_ARRAY(collection, (int16_t)(i % 10), status);
+    }
+    ARRAY(double) doubles = NEW_ARRAY();
+    INIT_ARRAY(doubles, arrayArena, status);
+    for (int i = 0; i < 37; i++) {
+        PUSH_ARRAY(doubles, (double)i / 2.0, status);
+    }
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        size_t index = 0;
+        size_t count = 0;
+        ARRAY_FIND(collection, 7, index);
+        ASSERT_TRUE(index == 7, "check find");
+        ARRAY_FIND(collection, 11, index);
+        ASSERT_TRUE(index == ARRAY_NOT_FOUND, "check find of a missing item");
+        ARRAY_COUNT(collection, 3, count);
+        ASSERT_TRUE(count == 10, "check count");
+        ARRAY_FIND(doubles, 17.5, index);
+        ASSERT_TRUE(index == 35, "check find in the tail");
+        ARRAY_COUNT(doubles, 0.5, count);
+        ASSERT_TRUE(count == 1, "check count of doubles");
+    }
+    setSimdLevel(maxLevel);
+}
+
+static void testFillEqual(struct Arena *arrayArena) {
+    ARRAY(int) first = NEW_ARRAY();
+    ARRAY(int) second = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(first, arrayArena, status);
+    INIT_ARRAY(second, arrayArena, status);
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        ARRAY_FILL(first, 42, 45, status);
+        ASSERT_TRUE(status == OK, "status check");
+        ASSERT_TRUE(first.size == 45, "check fill size");
+        ASSERT_TRUE(first.items[0] == 42 && first.items[44] == 42,
+                    "check fill values");
+        ARRAY_FILL(second, 42, 45, status);
+        int equal = 0;
+        ARRAY_EQUAL(first, second, equal);
+        ASSERT_TRUE(equal, "check equal arrays");
+        second.items[40] = 7;
+        ARRAY_EQUAL(first, second, equal);
+        ASSERT_FALSE(equal, "check different arrays");
+        second.size = 44;
+        ARRAY_EQUAL(first, second, equal);
+        ASSERT_FALSE(equal, "check different sizes");
+    }
+    setSimdLevel(maxLevel);
+}
+
+static void testMinMax(struct Arena *arrayArena) {
+    ARRAY(int32_t) integers = NEW_ARRAY();
+    ARRAY(int64_t) longs = NEW_ARRAY();
+    ARRAY(float) floats = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(integers, arrayArena, status);
+    INIT_ARRAY(longs, arrayArena, status);
+    INIT_ARRAY(floats, arrayArena, status);
+    for (int i = 0; i < 53; i++) {
+        int value = ((i * 37) % 53) - 20;
+        PUSH_ARRAY(integers, value, status);
+        PUSH_ARRAY(longs, (int64_t)value * 10000000000LL, status);
+        PUSH_ARRAY(floats, (float)value / 4.0f, status);
+    }
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        int32_t intMin = 0;
+        int32_t intMax = 0;
+        ARRAY_MIN_MAX(integers, intMin, intMax, status);
+        ASSERT_TRUE(status == OK, "status check");
+        ASSERT_TRUE(intMin == -20 && intMax == 32, "check int32 min max");
+        int64_t longMin = 0;
+        int64_t longMax = 0;
+        ARRAY_MIN_MAX(longs, longMin, longMax, status);
+        ASSERT_TRUE(longMin == -200000000000LL && longMax == 320000000000LL,
+                    "check int64 min max");
+        float floatMin = 0;
+        float floatMax = 0;
+        ARRAY_MIN_MAX(floats, floatMin, floatMax, status);
+        ASSERT_TRUE(floatMin == -5.0f && floatMax == 8.0f,
+                    "check float min max");
+    }
+    setSimdLevel(maxLevel);
+    integers.size = 0;
+    int32_t intMin = 0;
+    int32_t intMax = 0;
+    ARRAY_MIN_MAX(integers, intMin, intMax, status);
+    ASSERT_TRUE(status == INVALIDARGS, "check empty arrays are rejected");
+}
+
+static void testSmallArray(struct Arena *arrayArena) {
+    SMALL_ARRAY(int, 4) small = NEW_SMALL_ARRAY();
+    int status = 0;
+    size_t arenaOffset = getLastArenaNode(arrayArena)->currentOffset;
+    INIT_SMALL_ARRAY(small, arrayArena, status);
+    for (int i = 0; i < 4; i++) {
+        PUSH_ARRAY(small, i, status);
+    }
+    // the asserts use the arena so check the offset before any of them
+    int untouched =
+        getLastArenaNode(arrayArena)->currentOffset == arenaOffset;
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(SMALL_ARRAY_IS_INLINE(small), "check items stay inline");
+    ASSERT_TRUE(untouched, "check nothing came from the arena");
+    size_t index = 0;
+    ARRAY_FIND(small, 3, index);
+    ASSERT_TRUE(index == 3, "check find on inline items");
+
+    // the fifth push moves everything to the arena
+    PUSH_ARRAY(small, 4, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_FALSE(SMALL_ARRAY_IS_INLINE(small), "check spill to the arena");
+    int kept = 1;
+    for (size_t i = 0; i < small.size; i++) {
+        kept &= small.items[i] == (int)i;
+    }
+    ASSERT_TRUE(kept && small.size == 5, "check items after the spill");
+
+    int more[] = {5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+    APPEND_ARRAY(small, more, 10, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(small.size == 15 && small.items[14] == 14, "check append");
+    CLEAR_ARRAY(small, status);
+    ASSERT_TRUE(small.size == 0, "check clear");
+
+    ARRAY(char) letters = NEW_ARRAY();
+    INIT_ARRAY(letters, arrayArena, status);
+    APPEND_ARRAY(letters, "abc", 3, status);
+    APPEND_ARRAY(letters, "defg", 4, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(letters.size == 7 && !memcmp(letters.items, "abcdefg", 7),
+                "check append to a plain array");
+}
+
 int runArrayTests(void) {
     struct Arena *memory = createArena();
     int status = 0;
@@ -198,5 +345,9 @@ int runArrayTests(void) {
     ADD_TEST(testCopy);
     ADD_TEST(testCopyPointer);
     ADD_TEST(testFaults);
+    ADD_TEST(testFindCount);
+    ADD_TEST(testFillEqual);
+    ADD_TEST(testMinMax);
+    ADD_TEST(testSmallArray);
     return runTest();
 }
@@ -0,0 +1,250 @@
+#include "test_asyncreader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define TEST_FILE_SIZE (64 * 1024)
+#define TEST_FILE_COUNT 40
+
+static const enum AsyncBackend backends[] = {ASYNC_BACKEND_IO_URING,
+                                             ASYNC_BACKEND_THREADS};
+
+static char patternByte(size_t index, size_t seed) {
+    return (char)((index * 31 + seed * 7 + (index >> 9)) & 0xff);
+}
+
+// write size pattern bytes to a new temporary file and put its name in path
+static int writeTempFile(char *path, size_t size, size_t seed) {
+    strcpy(path, "/tmp/cmain_async_XXXXXX");
+    int fd = mkstemp(path);
+    if (fd == -1) {
+        return 0;
+    }
+    char block[4096];
+    int written = 1;
+    for (size_t offset = 0; offset < size; offset += sizeof(block)) {
+        size_t count = size - offset < sizeof(block) ? size - offset
+                                                     : sizeof(block);
+        for (size_t i = 0; i < count; i++) {
+            block[i] = patternByte(offset + i, seed);
+        }
+        written &= write(fd, block, count) == (ssize_t)count;
+    }
+    close(fd);
+    return written;
+}
+
+static int matchesPattern(const char *bytes, size_t offset, size_t size,
+                          size_t seed) {
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != patternByte(offset + i, seed)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// wait for count reads and check each one read its own block
+static int collectBlocks(struct AsyncReader *reader,
+                         AsyncCompletionBuffer *completions, size_t count,
+                         size_t blockSize) {
+    int matches = 1;
+    size_t collected = 0;
+    while (collected < count) {
+        if (waitForReads(reader, 1, completions) != OK) {
+            return 0;
+        }
+        while (completions->array.size != 0) {
+            struct AsyncCompletion completion = *completions->head;
+            POP_FRONT_BUFFER(*completions);
+            size_t block = (size_t)(uintptr_t)completion.userData;
+            matches &= completion.result == (int64_t)blockSize &&
+                       matchesPattern(completion.buffer, block * blockSize,
+                                      blockSize, 1);
+            collected++;
+        }
+    }
+    return matches;
+}
+
+static void testReads(struct Arena *arena) {
+    char path[32];
+    ASSERT_TRUE(writeTempFile(path, TEST_FILE_SIZE, 1),
+                "check the file was written");
+    int fd = open(path, O_RDONLY);
+    unlink(path);
+    const size_t blockSize = 4096;
+    const size_t blockCount = TEST_FILE_SIZE / blockSize;
+    for (size_t b = 0; b < sizeof(backends) / sizeof(*backends); b++) {
+        struct AsyncReader *reader = createAsyncReader(&arena, 8, backends[b]);
+        if (reader == NULL && backends[b] == ASYNC_BACKEND_IO_URING) {
+            printf("io_uring is not available, only testing threads\n");
+            continue;
+        }
+        ASSERT_TRUE(reader != NULL, "check the reader was created");
+        ASSERT_TRUE(asyncReaderBackend(reader) == backends[b],
+                    "check the backend");
+        AsyncCompletionBuffer completions;
+        int status = OK;
+        INIT_BUFFER(completions, arena, 8, status);
+        char *buffer = mallocArena(&arena, TEST_FILE_SIZE);
+
+        // twice the depth so some slots get reused
+        int matches = 1;
+        for (size_t first = 0; first < blockCount; first += 8) {
+            for (size_t i = first; i < first + 8; i++) {
+                status |= queueRead(reader, fd, buffer + i * blockSize,
+                                    blockSize, i * blockSize, (void *)i);
+            }
+            ASSERT_TRUE(readsInFlight(reader) == 8, "check reads in flight");
+            ASSERT_TRUE(queueRead(reader, fd, buffer, 1, 0, NULL) ==
+                            BUFFERFULL,
+                        "check the depth is enforced");
+            status |= submitReads(reader);
+            matches &= collectBlocks(reader, &completions, 8, blockSize);
+        }
+        ASSERT_TRUE(status == OK, "status check");
+        ASSERT_TRUE(matches, "check every block was read");
+        ASSERT_TRUE(readsInFlight(reader) == 0, "check nothing is in flight");
+
+        queueRead(reader, fd, buffer, 16, TEST_FILE_SIZE, NULL);
+        queueRead(reader, -1, buffer, 16, 0, NULL);
+        waitForReads(reader, 2, &completions);
+        ASSERT_TRUE(completions.array.size == 2, "check both were posted");
+        int64_t results[2] = {completions.head->result, 0};
+        POP_FRONT_BUFFER(completions);
+        results[1] = completions.head->result;
+        POP_FRONT_BUFFER(completions);
+        ASSERT_TRUE((results[0] == 0 && results[1] == -EBADF) ||
+                        (results[1] == 0 && results[0] == -EBADF),
+                    "check end of file and a bad descriptor");
+
+        // left in flight on purpose so destroy has to wait on them
+        queueRead(reader, fd, buffer, blockSize, 0, NULL);
+        queueRead(reader, fd, buffer + blockSize, blockSize, blockSize, NULL);
+        destroyAsyncReader(&reader);
+        ASSERT_TRUE(reader == NULL, "check destroy");
+        ASSERT_TRUE(matchesPattern(buffer, 0, 2 * blockSize, 1),
+                    "check destroy waited for the reads");
+    }
+    close(fd);
+}
+
+static void testFixedBuffers(struct Arena *arena) {
+    char path[32];
+    ASSERT_TRUE(writeTempFile(path, TEST_FILE_SIZE, 1),
+                "check the file was written");
+    int fd = open(path, O_RDONLY);
+    unlink(path);
+    const size_t blockSize = 4096;
+    for (size_t b = 0; b < sizeof(backends) / sizeof(*backends); b++) {
+        struct AsyncReader *reader = createAsyncReader(&arena, 4, backends[b]);
+        if (reader == NULL) {
+            continue;
+        }
+        char *buffers[4];
+        for (size_t i = 0; i < 4; i++) {
+            buffers[i] = mallocArena(&arena, blockSize);
+        }
+        int status = registerReadBuffers(reader, buffers, blockSize, 4);
+        ASSERT_TRUE(status == OK, "status check");
+        ASSERT_TRUE(queueFixedRead(reader, fd, 4, blockSize, 0, NULL) ==
+                            INVALIDARGS &&
+                        queueFixedRead(reader, fd, 0, blockSize + 1, 0,
+                                       NULL) == INVALIDARGS,
+                    "check bad fixed reads");
+        for (size_t i = 0; i < 4; i++) {
+            status |= queueFixedRead(reader, fd, (uint32_t)i, blockSize,
+                                     i * blockSize, (void *)i);
+        }
+        ASSERT_TRUE(registerReadBuffers(reader, buffers, blockSize, 4) ==
+                        INVALIDARGS,
+                    "check buffers can't change with reads in flight");
+        AsyncCompletionBuffer completions;
+        INIT_BUFFER(completions, arena, 4, status);
+        ASSERT_TRUE(status == OK, "status check");
+        int matches = collectBlocks(reader, &completions, 4, blockSize);
+        for (size_t i = 0; i < 4; i++) {
+            matches &= matchesPattern(buffers[i], i * blockSize, blockSize, 1);
+        }
+        ASSERT_TRUE(matches, "check the fixed buffers were filled");
+        destroyAsyncReader(&reader);
+    }
+    close(fd);
+}
+
+static void testReadFiles(struct Arena *arena) {
+    char paths[TEST_FILE_COUNT + 1][32];
+    const char *pathList[TEST_FILE_COUNT + 1];
+    size_t sizes[TEST_FILE_COUNT];
+    int written = 1;
+    for (size_t i = 0; i < TEST_FILE_COUNT; i++) {
+        // a mix of empty, small and one file bigger than the rest together
+        sizes[i] = i == 7 ? 3 * 1024 * 1024 : (i * 977) % 20000;
+        written &= writeTempFile(paths[i], sizes[i], i);
+        pathList[i] = paths[i];
+    }
+    ASSERT_TRUE(written, "check the files were written");
+    strcpy(paths[TEST_FILE_COUNT], "/tmp/cmain_async_missing");
+    pathList[TEST_FILE_COUNT] = paths[TEST_FILE_COUNT];
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(*backends); b++) {
+        struct AsyncReader *reader = createAsyncReader(&arena, 6, backends[b]);
+        if (reader == NULL) {
+            continue;
+        }
+        StringArray files;
+        int status = OK;
+        INIT_ARRAY(files, arena, status);
+        status = readFiles(reader, pathList, TEST_FILE_COUNT, arena, &files);
+        ASSERT_TRUE(status == OK, "status check");
+        int matches = files.size == TEST_FILE_COUNT;
+        for (size_t i = 0; matches && i < TEST_FILE_COUNT; i++) {
+            matches &= files.items[i].size == sizes[i] &&
+                       matchesPattern(files.items[i].items, 0, sizes[i], i) &&
+                       files.items[i].items[sizes[i]] == '\0';
+        }
+        ASSERT_TRUE(matches, "check every file was read");
+        ASSERT_TRUE(readsInFlight(reader) == 0, "check nothing is in flight");
+
+        status = readFiles(reader, pathList + TEST_FILE_COUNT - 2, 3, arena,
+                           &files);
+        ASSERT_TRUE(status == INVALIDARGS, "check a missing file");
+        ASSERT_TRUE(files.size == TEST_FILE_COUNT + 3 &&
+                        files.items[TEST_FILE_COUNT + 2].size == 0 &&
+                        files.items[TEST_FILE_COUNT + 1].size ==
+                            sizes[TEST_FILE_COUNT - 1],
+                    "check the other files were still read");
+
+        // a read of our own in flight would be taken for one of the files
+        char byte = 0;
+        int fd = open(pathList[0], O_RDONLY);
+        queueRead(reader, fd, &byte, 1, 0, NULL);
+        size_t before = files.size;
+        ASSERT_TRUE(readFiles(reader, pathList, 1, arena, &files) ==
+                            INVALIDARGS &&
+                        files.size == before,
+                    "check other reads in flight are refused");
+        destroyAsyncReader(&reader);
+        close(fd);
+    }
+    for (size_t i = 0; i < TEST_FILE_COUNT; i++) {
+        unlink(paths[i]);
+    }
+}
+
+int runAsyncReaderTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testReads);
+    ADD_TEST(testFixedBuffers);
+    ADD_TEST(testReadFiles);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_ASYNCREADER_H
+#define TEST_ASYNCREADER_H
+
+#include "../asyncreader.h"
+#include "unittest.h"
+
+int runAsyncReaderTests(void);
+
+#endif
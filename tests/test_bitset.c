@@ -0,0 +1,137 @@
+#include "test_bitset.h"
+#include <stdio.h>
+
+static void testSetClear(struct Arena *arena) {
+    struct Bitset bits;
+    int status = initBitset(&bits, arena, 200);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(bits.wordCount == 4, "check word count");
+    ASSERT_TRUE(bitsetCount(&bits) == 0, "check starts cleared");
+
+    setBit(&bits, 0);
+    setBit(&bits, 63);
+    setBit(&bits, 64);
+    setBit(&bits, 199);
+    ASSERT_TRUE(testBit(&bits, 63) && testBit(&bits, 64), "check set");
+    ASSERT_FALSE(testBit(&bits, 1), "check unset bit");
+    ASSERT_TRUE(bitsetCount(&bits) == 4, "check count");
+    clearBit(&bits, 63);
+    ASSERT_FALSE(testBit(&bits, 63), "check clear");
+
+    setAllBits(&bits);
+    ASSERT_TRUE(bitsetCount(&bits) == 200, "check padding stays clear");
+    ASSERT_TRUE(findFirstZero(&bits) == BITSET_NOT_FOUND, "check full set");
+    clearAllBits(&bits);
+    ASSERT_TRUE(bitsetCount(&bits) == 0, "check clear all");
+
+    // shrinking drops the bits and growing brings them back cleared
+    setAllBits(&bits);
+    status = resizeBitset(&bits, 70);
+    ASSERT_TRUE(status == OK && bitsetCount(&bits) == 70, "check shrink");
+    uint64_t *words = bits.words;
+    status = resizeBitset(&bits, 200);
+    ASSERT_TRUE(status == OK && bitsetCount(&bits) == 70, "check regrow");
+    ASSERT_TRUE(bits.words == words, "check regrow reuses the words");
+    status = resizeBitset(&bits, 1000);
+    ASSERT_TRUE(status == OK && bitsetCount(&bits) == 70, "check grow");
+    ASSERT_FALSE(testBit(&bits, 70), "check grown bits are cleared");
+}
+
+static void testOperations(struct Arena *arena) {
+    struct Bitset evens;
+    struct Bitset threes;
+    struct Bitset result;
+    struct Bitset small;
+    struct Bitset large;
+    int status = 0;
+    status |= initBitset(&evens, arena, 1001);
+    status |= initBitset(&threes, arena, 1001);
+    status |= initBitset(&result, arena, 1001);
+    status |= initBitset(&small, arena, 10);
+    status |= initBitset(&large, arena, 100000);
+    setAllBits(&large);
+    ASSERT_TRUE(status == OK, "status check");
+    for (size_t i = 0; i < 1001; i++) {
+        if (i % 2 == 0) {
+            setBit(&evens, i);
+        }
+        if (i % 3 == 0) {
+            setBit(&threes, i);
+        }
+    }
+
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        ASSERT_TRUE(bitsetCount(&evens) == 501, "check popcount");
+        ASSERT_TRUE(bitsetCount(&large) == 100000, "check large popcount");
+        status = bitsetAnd(&result, &evens, &threes);
+        ASSERT_TRUE(status == OK, "status check");
+        ASSERT_TRUE(bitsetCount(&result) == 167, "check and");
+        bitsetOr(&result, &evens, &threes);
+        ASSERT_TRUE(bitsetCount(&result) == 668, "check or");
+        bitsetXor(&result, &evens, &threes);
+        ASSERT_TRUE(bitsetCount(&result) == 501, "check xor");
+        bitsetAndNot(&result, &evens, &threes);
+        ASSERT_TRUE(bitsetCount(&result) == 334, "check and not");
+        ASSERT_TRUE(testBit(&result, 2) && !testBit(&result, 6),
+                    "check and not bits");
+        // the destination can be one of the sources
+        bitsetAnd(&result, &result, &threes);
+        ASSERT_TRUE(bitsetCount(&result) == 0, "check in place");
+    }
+    setSimdLevel(maxLevel);
+
+    status = bitsetOr(&result, &evens, &small);
+    ASSERT_TRUE(status == INVALIDARGS, "check mismatched sizes");
+}
+
+static void testIteration(struct Arena *arena) {
+    struct Bitset bits;
+    int status = initBitset(&bits, arena, 5000);
+    ASSERT_TRUE(status == OK, "status check");
+    size_t expected[] = {3, 64, 65, 1000, 4095, 4999};
+    for (size_t i = 0; i < 6; i++) {
+        setBit(&bits, expected[i]);
+    }
+
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        size_t seen = 0;
+        int ordered = 1;
+        FOR_EACH_SET_BIT(&bits, index) {
+            ordered &= seen < 6 && index == expected[seen];
+            seen++;
+        }
+        ASSERT_TRUE(ordered && seen == 6, "check set bit iteration");
+        ASSERT_TRUE(nextSetBit(&bits, 66) == 1000, "check next set bit");
+        ASSERT_TRUE(nextSetBit(&bits, 5000) == BITSET_NOT_FOUND,
+                    "check next set bit past the end");
+
+        setAllBits(&bits);
+        clearBit(&bits, 3333);
+        ASSERT_TRUE(findFirstZero(&bits) == 3333, "check first zero");
+        clearBit(&bits, 70);
+        ASSERT_TRUE(findFirstZero(&bits) == 70, "check earlier zero");
+        clearAllBits(&bits);
+        for (size_t i = 0; i < 6; i++) {
+            setBit(&bits, expected[i]);
+        }
+    }
+    setSimdLevel(maxLevel);
+}
+
+int runBitsetTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testSetClear);
+    ADD_TEST(testOperations);
+    ADD_TEST(testIteration);
+    return runTest();
+}
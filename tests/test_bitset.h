@@ -0,0 +1,9 @@
+#ifndef TEST_BITSET_H
+#define TEST_BITSET_H
+
+#include "../bitset.h"
+#include "unittest.h"
+
+int runBitsetTests(void);
+
+#endif
@@ -0,0 +1,165 @@
+#include "test_blockingbuffer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRANSFER_COUNT 20000
+
+typedef BLOCKING_BUFFER(uint64_t) BlockingQueue;
+
+struct Transfer {
+    BlockingQueue queue;
+    // how long the producer sleeps every so often so the consumer parks
+    useconds_t pause;
+};
+
+static int64_t nowNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000000LL) + now.tv_nsec;
+}
+
+// push 1..TRANSFER_COUNT and then a 0 to say that it is done
+static void *producer(void *context) {
+    struct Transfer *transfer = context;
+    int status = 0;
+    for (uint64_t i = 0; i <= TRANSFER_COUNT; i++) {
+        uint64_t item = i == TRANSFER_COUNT ? 0 : i + 1;
+        if (transfer->pause != 0 && i % 1000 == 0) {
+            usleep(transfer->pause);
+        }
+        TRY_PUSH_BLOCKING_BUFFER(transfer->queue, item, status);
+        while (status == BUFFERFULL) {
+            sched_yield();
+            TRY_PUSH_BLOCKING_BUFFER(transfer->queue, item, status);
+        }
+    }
+    return NULL;
+}
+
+static void *delayedPush(void *context) {
+    struct Transfer *transfer = context;
+    int status = 0;
+    usleep(transfer->pause);
+    TRY_PUSH_BLOCKING_BUFFER(transfer->queue, 42, status);
+    // the main thread is parked or joining so nothing else is asserting
+    ASSERT_TRUE(status == OK, "check the delayed push went in");
+    return NULL;
+}
+
+static void testSingleThread(struct Arena *arena) {
+    BlockingQueue queue;
+    int status = 0;
+    INIT_BLOCKING_BUFFER(queue, arena, 3, 4, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(BLOCKING_BUFFER_CAPACITY(queue) == 4, "check round up");
+
+    uint64_t item = 0;
+    TRY_POP_BLOCKING_BUFFER(queue, item, status);
+    ASSERT_TRUE(status == BUFFEREMPTY, "check empty pop");
+    POP_BLOCKING_BUFFER(queue, item, 0, status);
+    ASSERT_TRUE(status == TIMEDOUT, "check zero timeout");
+    for (uint64_t i = 0; i < 4; i++) {
+        TRY_PUSH_BLOCKING_BUFFER(queue, i, status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    TRY_PUSH_BLOCKING_BUFFER(queue, 99, status);
+    ASSERT_TRUE(status == BUFFERFULL, "check full push");
+    WAIT_BLOCKING_BUFFER(queue, 0, status);
+    ASSERT_TRUE(status == OK, "check wait with items");
+    int ordered = 1;
+    for (uint64_t i = 0; i < 4; i++) {
+        POP_BLOCKING_BUFFER(queue, item, BLOCKING_BUFFER_FOREVER, status);
+        ordered &= status == OK && item == i;
+    }
+    ASSERT_TRUE(ordered, "check pop order");
+
+    int64_t start = nowNanoseconds();
+    POP_BLOCKING_BUFFER(queue, item, 20000000, status);
+    int64_t waited = nowNanoseconds() - start;
+    ASSERT_TRUE(status == TIMEDOUT, "check timeout");
+    ASSERT_TRUE(waited >= 20000000, "check the timeout was waited out");
+
+    // a zero timeout gives up straight away instead of spinning first
+    BlockingQueue spinning;
+    INIT_BLOCKING_BUFFER(spinning, arena, 4, UINT32_MAX, status);
+    ASSERT_TRUE(status == OK, "status check");
+    start = nowNanoseconds();
+    POP_BLOCKING_BUFFER(spinning, item, 0, status);
+    waited = nowNanoseconds() - start;
+    ASSERT_TRUE(status == TIMEDOUT, "check zero timeout while spinning");
+    ASSERT_TRUE(waited < 20000000, "check the spins were skipped");
+}
+
+static void testWakeup(struct Arena *arena) {
+    struct Transfer *transfer = mallocArena(&arena, sizeof(struct Transfer));
+    int status = 0;
+    // no spinning so the pop has to park and be woken by the push
+    INIT_BLOCKING_BUFFER(transfer->queue, arena, 8, 0, status);
+    transfer->pause = 20000;
+    ASSERT_TRUE(status == OK, "status check");
+
+    pthread_t thread;
+    ASSERT_TRUE(pthread_create(&thread, NULL, delayedPush, transfer) == 0,
+                "check thread start");
+    uint64_t item = 0;
+    POP_BLOCKING_BUFFER(transfer->queue, item, BLOCKING_BUFFER_FOREVER,
+                        status);
+    pthread_join(thread, NULL);
+    ASSERT_TRUE(status == OK && item == 42, "check parked pop was woken");
+    ASSERT_TRUE(atomic_load(&transfer->queue.sleeping) == 0,
+                "check sleeping flag was cleared");
+}
+
+static void transfer(struct Arena *arena, uint32_t spins, useconds_t pause) {
+    struct Transfer *transfer = mallocArena(&arena, sizeof(struct Transfer));
+    int status = 0;
+    INIT_BLOCKING_BUFFER(transfer->queue, arena, 64, spins, status);
+    transfer->pause = pause;
+    ASSERT_TRUE(status == OK, "status check");
+
+    pthread_t thread;
+    ASSERT_TRUE(pthread_create(&thread, NULL, producer, transfer) == 0,
+                "check thread start");
+    uint64_t expected = 1;
+    int ordered = 1;
+    for (;;) {
+        uint64_t item = 0;
+        POP_BLOCKING_BUFFER(transfer->queue, item, BLOCKING_BUFFER_FOREVER,
+                            status);
+        ordered &= status == OK;
+        if (item == 0) {
+            break;
+        }
+        ordered &= item == expected;
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    ASSERT_TRUE(ordered, "check every item arrived in order");
+    ASSERT_TRUE(expected == TRANSFER_COUNT + 1, "check item count");
+}
+
+static void testTwoThreads(struct Arena *arena) {
+    transfer(arena, BLOCKING_BUFFER_DEFAULT_SPINS, 0);
+}
+
+static void testTwoThreadsParking(struct Arena *arena) {
+    transfer(arena, 0, 500);
+}
+
+int runBlockingBufferTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testSingleThread);
+    ADD_TEST(testWakeup);
+    ADD_TEST(testTwoThreads);
+    ADD_TEST(testTwoThreadsParking);
+    return runTest();
+}
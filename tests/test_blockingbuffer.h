@@ -0,0 +1,9 @@
+#ifndef TEST_BLOCKINGBUFFER_H
+#define TEST_BLOCKINGBUFFER_H
+
+#include "../blockingbuffer.h"
+#include "unittest.h"
+
+int runBlockingBufferTests(void);
+
+#endif
@@ -0,0 +1,213 @@
+#include "test_btree.h"
+#include <stdio.h>
+
+#define INT_LESS(first, second) (*(first) < *(second))
+BTREE_DEFINE(int, int, IntTree, INT_LESS)
+
+// walk the tree checking the key bounds, node sizes and that every leaf is at
+// the same depth. Returns the number of keys or -1 if something is wrong
+static long checkNode(const IntTree *tree, void *node, uint32_t level,
+                      const int *low, const int *high) {
+    int isRoot = level == 0;
+    if (level + 1 == tree->height) {
+        IntTreeLeaf *leaf = node;
+        if (leaf->count > IntTreeLeafCapacity ||
+            (!isRoot && leaf->count < IntTreeLeafMinimum)) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < leaf->count; i++) {
+            if ((i > 0 && leaf->keys[i - 1] >= leaf->keys[i]) ||
+                (low != NULL && leaf->keys[i] < *low) ||
+                (high != NULL && leaf->keys[i] >= *high)) {
+                return -1;
+            }
+        }
+        return leaf->count;
+    }
+    IntTreeBranch *branch = node;
+    if (branch->count > IntTreeBranchCapacity || branch->count == 0 ||
+        (!isRoot && branch->count < IntTreeBranchMinimum)) {
+        return -1;
+    }
+    long total = 0;
+    for (uint32_t i = 0; i <= branch->count; i++) {
+        const int *childLow = i == 0 ? low : &branch->keys[i - 1];
+        const int *childHigh = i == branch->count ? high : &branch->keys[i];
+        long count = checkNode(tree, branch->children[i], level + 1, childLow,
+                               childHigh);
+        if (count < 0) {
+            return -1;
+        }
+        total += count;
+    }
+    return total;
+}
+
+static int treeIsValid(const IntTree *tree) {
+    if (tree->root == NULL) {
+        return tree->size == 0 && tree->height == 0;
+    }
+    long count = checkNode(tree, tree->root, 0, NULL, NULL);
+    return count >= 0 && (size_t)count == tree->size;
+}
+
+static void testInsertFind(struct Arena *arena) {
+    IntTree tree;
+    ASSERT_TRUE(IntTreeInit(&tree, arena) == OK, "status check");
+    ASSERT_TRUE(IntTreeFind(&tree, &(int){1}) == NULL, "check empty find");
+
+    uint32_t state = 5;
+    int status = 0;
+    for (int i = 0; i < 5000; i++) {
+        int key = (int)(nextRandom(&state) % 4000);
+        status |= IntTreeInsert(&tree, key, key * 2);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(treeIsValid(&tree), "check tree after inserts");
+    ASSERT_TRUE(tree.height > 2, "check the tree grew branches");
+
+    // replacing a value doesn't add a key
+    size_t size = IntTreeSize(&tree);
+    int key = IntTreeBegin(&tree).leaf->keys[0];
+    status = IntTreeInsert(&tree, key, -1);
+    ASSERT_TRUE(status == OK && IntTreeSize(&tree) == size, "check replace");
+    ASSERT_TRUE(*IntTreeFind(&tree, &key) == -1, "check replaced value");
+
+    int found = 1;
+    int previous = -1;
+    size_t seen = 0;
+    for (IntTreeIterator it = IntTreeBegin(&tree); IntTreeIteratorValid(&it);
+         IntTreeIteratorNext(&it)) {
+        int current = *IntTreeIteratorKey(&it);
+        found &= previous < current;
+        found &= current == key || *IntTreeIteratorValue(&it) == current * 2;
+        previous = current;
+        seen++;
+    }
+    ASSERT_TRUE(found && seen == size, "check in order iteration");
+}
+
+static void testRange(struct Arena *arena) {
+    IntTree tree;
+    int status = IntTreeInit(&tree, arena);
+    // only multiples of 3 are in the tree
+    for (int i = 3000; i >= 0; i -= 3) {
+        status |= IntTreeInsert(&tree, i, i);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+
+    IntTreeIterator it = IntTreeLowerBound(&tree, &(int){100});
+    ASSERT_TRUE(*IntTreeIteratorKey(&it) == 102, "check lower bound");
+    it = IntTreeLowerBound(&tree, &(int){99});
+    ASSERT_TRUE(*IntTreeIteratorKey(&it) == 99, "check exact lower bound");
+    it = IntTreeLowerBound(&tree, &(int){3001});
+    ASSERT_FALSE(IntTreeIteratorValid(&it), "check lower bound past the end");
+
+    int high = 2000;
+    int count = 0;
+    int inRange = 1;
+    for (it = IntTreeLowerBound(&tree, &(int){1000});
+         IntTreeIteratorBefore(&it, &high); IntTreeIteratorNext(&it)) {
+        int current = *IntTreeIteratorKey(&it);
+        inRange &= current >= 1000 && current < 2000 && current % 3 == 0;
+        count++;
+    }
+    ASSERT_TRUE(inRange, "check range keys");
+    ASSERT_TRUE(count == 333, "check range count");
+}
+
+static void testRemove(struct Arena *arena) {
+    IntTree tree;
+    int status = IntTreeInit(&tree, arena);
+    for (int i = 0; i < 3000; i++) {
+        status |= IntTreeInsert(&tree, i, i);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+
+    int value = 0;
+    status = IntTreeRemove(&tree, &(int){5000}, &value);
+    ASSERT_TRUE(status == INVALIDARGS, "check missing remove");
+
+    // remove in a scattered order so borrows and merges both happen
+    int valid = 1;
+    int removedValues = 1;
+    uint32_t state = 9;
+    for (int i = 0; i < 3000; i++) {
+        int key = (int)((nextRandom(&state) >> 4) % 3000);
+        if (IntTreeFind(&tree, &key) == NULL) {
+            continue;
+        }
+        status = IntTreeRemove(&tree, &key, &value);
+        removedValues &= status == OK && value == key;
+        if (i % 100 == 0) {
+            valid &= treeIsValid(&tree);
+        }
+    }
+    ASSERT_TRUE(removedValues, "check removed values");
+    ASSERT_TRUE(valid && treeIsValid(&tree), "check tree during removes");
+
+    for (int i = 0; i < 3000; i++) {
+        IntTreeRemove(&tree, &i, NULL);
+    }
+    ASSERT_TRUE(IntTreeSize(&tree) == 0 && tree.root == NULL,
+                "check empty after removing everything");
+
+    // the freed nodes get used again
+    size_t arenaOffset = getLastArenaNode(arena)->currentOffset;
+    for (int i = 0; i < 1000; i++) {
+        status |= IntTreeInsert(&tree, i, i);
+    }
+    int reused = getLastArenaNode(arena)->currentOffset == arenaOffset;
+    ASSERT_TRUE(status == OK && treeIsValid(&tree), "check reinsert");
+    ASSERT_TRUE(reused, "check nodes come from the free list");
+}
+
+static void testBulkLoad(struct Arena *arena) {
+    ARRAY(int) keys = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(keys, arena, status);
+    for (int i = 0; i < 10000; i++) {
+        PUSH_ARRAY(keys, i * 2, status);
+    }
+    IntTree tree;
+    status |= IntTreeInit(&tree, arena);
+    status |= IntTreeBulkLoad(&tree, keys.items, keys.items, keys.size);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(IntTreeSize(&tree) == 10000, "check size");
+    ASSERT_TRUE(treeIsValid(&tree), "check bulk loaded tree");
+    ASSERT_TRUE(*IntTreeFind(&tree, &(int){1234}) == 1234, "check find");
+    ASSERT_TRUE(IntTreeFind(&tree, &(int){1235}) == NULL, "check odd key");
+
+    // the loaded tree still takes inserts and removes
+    for (int i = 1; i < 2000; i += 2) {
+        status |= IntTreeInsert(&tree, i, i);
+        status |= IntTreeRemove(&tree, &(int){i + 1}, NULL);
+    }
+    ASSERT_TRUE(status == OK && treeIsValid(&tree), "check after edits");
+
+    for (int small = 0; small < 40; small++) {
+        status |= IntTreeBulkLoad(&tree, keys.items, keys.items, small);
+        ASSERT_TRUE(treeIsValid(&tree) && IntTreeSize(&tree) == (size_t)small,
+                    "check small bulk loads");
+    }
+    ASSERT_TRUE(status == OK, "status check");
+
+    keys.items[10] = keys.items[11];
+    status = IntTreeBulkLoad(&tree, keys.items, keys.items, keys.size);
+    ASSERT_TRUE(status == INVALIDARGS, "check unsorted input");
+}
+
+int runBTreeTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testInsertFind);
+    ADD_TEST(testRange);
+    ADD_TEST(testRemove);
+    ADD_TEST(testBulkLoad);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_BTREE_H
+#define TEST_BTREE_H
+
+#include "../btree.h"
+#include "unittest.h"
+
+int runBTreeTests(void);
+
+#endif
@@ -172,6 +172,159 @@ static void testLargeBuffer(struct Arena *arrayArena) {
     ASSERT_TRUE(collection.array.alloc == 15, "check alloc'ed size");
 }
 
+static void testPushAfterEmpty(struct Arena *arrayArena) {
+    BUFFER(int) collection = NEW_BUFFER();
+    int status = 0;
+    INIT_BUFFER(collection, arrayArena, 5, status);
+    ASSERT_TRUE(status == OK, "status check");
+    PUSH_BUFFER(collection, 5);
+    POP_FRONT_BUFFER(collection);
+    PUSH_BUFFER(collection, 7);
+    PUSH_BUFFER(collection, 9);
+    int *item = NULL;
+    GET_ITEM(collection, 0, item, status);
+    ASSERT_TRUE(*(item) == 7, "check first item");
+    GET_ITEM(collection, 1, item, status);
+    ASSERT_TRUE(*(item) == 9, "check second item");
+    ASSERT_TRUE(collection.array.size == 2, "check size");
+}
+
+static void testBufferBulk(struct Arena *arrayArena) {
+    BUFFER(int) collection = NEW_BUFFER();
+    int status = 0;
+    INIT_BUFFER(collection, arrayArena, 5, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int source[12] = {0};
+    for (int i = 0; i < 12; i++) {
+        source[i] = i + 1;
+    }
+    PUSH_BUFFER_N(collection, source, 3);
+    ASSERT_TRUE(collection.array.size == 3, "check size");
+    int out[12] = {0};
+    size_t popped = 0;
+    POP_BUFFER_N(collection, out, 2, popped);
+    ASSERT_TRUE(popped == 2 && out[0] == 1 && out[1] == 2, "check bulk pop");
+    ASSERT_TRUE(collection.array.items[0] == 1,
+                "check bulk pop doesn't clear");
+
+    // starts at slot 3 so this wraps
+    PUSH_BUFFER_N(collection, source + 3, 4);
+    ASSERT_TRUE(collection.array.size == 5, "check size after wrap");
+    int ordered = 1;
+    int *item = NULL;
+    for (size_t i = 0; i < 5; i++) {
+        GET_ITEM(collection, i, item, status);
+        ordered &= *item == (int)i + 3;
+    }
+    ASSERT_TRUE(ordered, "check wrapped push");
+    PUSH_BUFFER(collection, 8);
+    GET_ITEM(collection, 4, item, status);
+    ASSERT_TRUE(*item == 8, "check single push after bulk push");
+
+    // too many items keeps the newest ones
+    PUSH_BUFFER_N(collection, source, 12);
+    POP_BUFFER_N(collection, out, 12, popped);
+    ordered = popped == 5;
+    for (int i = 0; i < 5; i++) {
+        ordered &= out[i] == i + 8;
+    }
+    ASSERT_TRUE(ordered, "check bulk push drops the oldest items");
+    POP_BUFFER_N(collection, out, 1, popped);
+    ASSERT_TRUE(popped == 0 && collection.array.size == 0,
+                "check pop from empty");
+    PUSH_BUFFER(collection, 42);
+    GET_ITEM(collection, 0, item, status);
+    ASSERT_TRUE(*item == 42, "check push after bulk pop");
+}
+
+static void testBufferSpans(struct Arena *arrayArena) {
+    BUFFER(int) collection = NEW_BUFFER();
+    int status = 0;
+    INIT_BUFFER(collection, arrayArena, 6, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int *first = NULL;
+    int *second = NULL;
+    size_t firstCount = 0;
+    size_t secondCount = 0;
+    BUFFER_WRITE_SPANS(collection, first, firstCount, second, secondCount);
+    ASSERT_TRUE(firstCount == 6 && secondCount == 0, "check empty spans");
+    for (int i = 0; i < 4; i++) {
+        first[i] = i;
+    }
+    COMMIT_BUFFER(collection, 4);
+    CONSUME_BUFFER(collection, 3);
+    ASSERT_TRUE(collection.array.size == 1, "check consume");
+
+    // the free space is now slots 4, 5 and then 0 through 2
+    BUFFER_WRITE_SPANS(collection, first, firstCount, second, secondCount);
+    ASSERT_TRUE(firstCount == 2 && secondCount == 3, "check write spans");
+    ASSERT_TRUE(first == collection.array.items + 4 &&
+                    second == collection.array.items,
+                "check write span pointers");
+    first[0] = 4;
+    first[1] = 5;
+    second[0] = 6;
+    COMMIT_BUFFER(collection, 3);
+
+    BUFFER_READ_SPANS(collection, first, firstCount, second, secondCount);
+    ASSERT_TRUE(firstCount == 3 && secondCount == 1, "check read spans");
+    ASSERT_TRUE(first[0] == 3 && first[2] == 5 && second[0] == 6,
+                "check read span items");
+    int *item = NULL;
+    GET_ITEM(collection, 3, item, status);
+    ASSERT_TRUE(*item == 6, "check get after commit");
+    CONSUME_BUFFER(collection, 10);
+    ASSERT_TRUE(collection.array.size == 0, "check consume is clamped");
+    BUFFER_READ_SPANS(collection, first, firstCount, second, secondCount);
+    ASSERT_TRUE(firstCount == 0 && secondCount == 0, "check empty read");
+}
+
+static void testPow2Buffer(struct Arena *arrayArena) {
+    POW2_BUFFER(int) collection = NEW_POW2_BUFFER();
+    int status = 0;
+    INIT_POW2_BUFFER(collection, arrayArena, 5, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(POW2_BUFFER_CAPACITY(collection) == 8, "check round up");
+    ASSERT_TRUE(POW2_BUFFER_SIZE(collection) == 0, "check empty");
+
+    for (int i = 0; i < 6; i++) {
+        PUSH_POW2_BUFFER(collection, i);
+    }
+    ASSERT_TRUE(POW2_BUFFER_SIZE(collection) == 6, "check size");
+    ASSERT_TRUE(*GET_POW2_ITEM(collection, 0) == 0, "check first item");
+    ASSERT_TRUE(*GET_POW2_ITEM(collection, 5) == 5, "check last item");
+
+    int item = 0;
+    POP_FRONT_POW2_BUFFER(collection, item);
+    ASSERT_TRUE(item == 0, "check pop");
+    POP_FRONT_POW2_BUFFER(collection, item);
+    ASSERT_TRUE(item == 1, "check second pop");
+    ASSERT_TRUE(*GET_POW2_ITEM(collection, 0) == 2, "check get after pop");
+
+    // go around the buffer a few times. Only the newest 8 items are kept
+    for (int i = 6; i < 30; i++) {
+        PUSH_POW2_BUFFER(collection, i);
+    }
+    ASSERT_TRUE(POW2_BUFFER_SIZE(collection) == 8, "check full size");
+    int ordered = 1;
+    for (size_t i = 0; i < 8; i++) {
+        ordered &= *GET_POW2_ITEM(collection, i) == 22 + (int)i;
+    }
+    ASSERT_TRUE(ordered, "check overwritten items");
+
+    for (int i = 0; i < 8; i++) {
+        POP_FRONT_POW2_BUFFER(collection, item);
+    }
+    ASSERT_TRUE(item == 29 && POW2_BUFFER_SIZE(collection) == 0,
+                "check pop to empty");
+    POP_FRONT_POW2_BUFFER(collection, item);
+    ASSERT_TRUE(POW2_BUFFER_SIZE(collection) == 0, "check pop when empty");
+    PUSH_POW2_BUFFER(collection, 100);
+    ASSERT_TRUE(*GET_POW2_ITEM(collection, 0) == 100, "check push after empty");
+    CLEAR_POW2_BUFFER(collection);
+    ASSERT_TRUE(POW2_BUFFER_SIZE(collection) == 0, "check clear");
+}
+
 int runBufferTests(void) {
     struct Arena *memory = createArena();
     int status = 0;
@@ -186,5 +339,9 @@ int runBufferTests(void) {
     ADD_TEST(testPopBufferZeros);
     ADD_TEST(testPopBuffer);
     ADD_TEST(testLargeBuffer);
+    ADD_TEST(testPushAfterEmpty);
+    ADD_TEST(testBufferBulk);
+    ADD_TEST(testBufferSpans);
+    ADD_TEST(testPow2Buffer);
     return runTest();
 }
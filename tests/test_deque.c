@@ -0,0 +1,126 @@
+#include "test_deque.h"
+#include <stdint.h>
+#include <stdio.h>
+
+static void testPushPop(struct Arena *arena) {
+    DEQUE(int) deque = NEW_DEQUE();
+    int status = 0;
+    INIT_DEQUE(deque, arena, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int item = 0;
+    POP_FRONT_DEQUE(deque, item, status);
+    ASSERT_TRUE(status == BUFFEREMPTY, "check empty pop front");
+    POP_BACK_DEQUE(deque, item, status);
+    ASSERT_TRUE(status == BUFFEREMPTY, "check empty pop back");
+
+    PUSH_BACK_DEQUE(deque, 2, status);
+    PUSH_BACK_DEQUE(deque, 3, status);
+    PUSH_FRONT_DEQUE(deque, 1, status);
+    PUSH_FRONT_DEQUE(deque, 0, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(DEQUE_SIZE(deque) == 4, "check size");
+    ASSERT_TRUE(DEQUE_CAPACITY(deque) == DEQUE_MIN_CAPACITY,
+                "check first capacity");
+    int ordered = 1;
+    for (int i = 0; i < 4; i++) {
+        ordered &= *GET_DEQUE_ITEM(deque, i) == i;
+    }
+    ASSERT_TRUE(ordered, "check items in order");
+
+    POP_FRONT_DEQUE(deque, item, status);
+    ASSERT_TRUE(status == OK && item == 0, "check pop front");
+    POP_BACK_DEQUE(deque, item, status);
+    ASSERT_TRUE(status == OK && item == 3, "check pop back");
+    ASSERT_TRUE(DEQUE_SIZE(deque) == 2, "check size after pops");
+    CLEAR_DEQUE(deque);
+    ASSERT_TRUE(DEQUE_SIZE(deque) == 0, "check clear");
+}
+
+static void testGrowWrapped(struct Arena *arena) {
+    DEQUE(int) deque = NEW_DEQUE();
+    int status = 0;
+    INIT_DEQUE(deque, arena, status);
+    // push to the front so the items wrap around the end of the block, then
+    // keep going past the capacity
+    for (int i = 0; i < 100; i++) {
+        PUSH_FRONT_DEQUE(deque, 99 - i, status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(DEQUE_CAPACITY(deque) == 128, "check capacity");
+    int ordered = 1;
+    for (int i = 0; i < 100; i++) {
+        ordered &= *GET_DEQUE_ITEM(deque, i) == i;
+    }
+    ASSERT_TRUE(ordered, "check order after growing");
+
+    RESERVE_DEQUE(deque, 1000, status);
+    ASSERT_TRUE(status == OK && DEQUE_CAPACITY(deque) == 1024,
+                "check reserve");
+    ordered = 1;
+    for (int i = 0; i < 100; i++) {
+        ordered &= *GET_DEQUE_ITEM(deque, i) == i;
+    }
+    ASSERT_TRUE(ordered, "check order after reserve");
+}
+
+// random pushes and pops on both ends checked against a plain array where the
+// front starts in the middle
+static void testAgainstArray(struct Arena *arena) {
+    DEQUE(uint32_t) deque = NEW_DEQUE();
+    int status = 0;
+    INIT_DEQUE(deque, arena, status);
+    uint32_t *model = mallocArena(&arena, 20000 * sizeof(uint32_t));
+    size_t front = 10000;
+    size_t back = 10000;
+    uint32_t random = 12345;
+    int matches = 1;
+    for (uint32_t i = 0; i < 8000; i++) {
+        random = (random * 1103515245) + 12345;
+        uint32_t choice = (random >> 16) % 6;
+        uint32_t item = 0;
+        // pushes are a bit more likely so the deque grows over time
+        if (choice == 0 || choice == 1) {
+            PUSH_BACK_DEQUE(deque, i, status);
+            model[back++] = i;
+        }
+        else if (choice == 2 || choice == 3) {
+            PUSH_FRONT_DEQUE(deque, i, status);
+            model[--front] = i;
+        }
+        else if (choice == 4) {
+            POP_BACK_DEQUE(deque, item, status);
+            if (front == back) {
+                matches &= status == BUFFEREMPTY;
+                continue;
+            }
+            matches &= status == OK && item == model[--back];
+        }
+        else {
+            POP_FRONT_DEQUE(deque, item, status);
+            if (front == back) {
+                matches &= status == BUFFEREMPTY;
+                continue;
+            }
+            matches &= status == OK && item == model[front++];
+        }
+        matches &= DEQUE_SIZE(deque) == back - front;
+    }
+    for (size_t i = 0; i < back - front; i++) {
+        matches &= *GET_DEQUE_ITEM(deque, i) == model[front + i];
+    }
+    ASSERT_TRUE(matches, "check the deque matches the array");
+}
+
+int runDequeTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testPushPop);
+    ADD_TEST(testGrowWrapped);
+    ADD_TEST(testAgainstArray);
+    return runTest();
+}
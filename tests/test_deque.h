@@ -0,0 +1,9 @@
+#ifndef TEST_DEQUE_H
+#define TEST_DEQUE_H
+
+#include "../deque.h"
+#include "unittest.h"
+
+int runDequeTests(void);
+
+#endif
@@ -0,0 +1,109 @@
+#include "test_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static int stringEquals(const String *string, const char *expected) {
+    return string->size == strlen(expected) &&
+           memcmp(string->items, expected, string->size) == 0;
+}
+
+// write contents to a new temporary file and put its name in path
+static int writeTempFile(char *path, const char *contents, size_t size) {
+    strcpy(path, "/tmp/cmain_file_XXXXXX");
+    int fd = mkstemp(path);
+    if (fd == -1) {
+        return 0;
+    }
+    int written = write(fd, contents, size) == (ssize_t)size;
+    close(fd);
+    return written;
+}
+
+static void testMapFile(struct Arena *arena) {
+    char path[32];
+    const char contents[] = "first line\nsecond line\r\n\nlast without end";
+    ASSERT_TRUE(writeTempFile(path, contents, sizeof(contents) - 1),
+                "check the file was written");
+    struct StringReturn result = mapFile(path, arena);
+    unlink(path);
+    ASSERT_TRUE(result.status == OK, "status check");
+    String file = result.string;
+    ASSERT_TRUE(file.size == sizeof(contents) - 1 &&
+                    !memcmp(file.items, contents, file.size),
+                "check the mapped bytes");
+    ASSERT_TRUE(countLines(&file) == 4, "check line count");
+
+    struct LineIterator iterator;
+    initLineIterator(&iterator, &file);
+    String line;
+    const char *expected[] = {"first line", "second line", "",
+                              "last without end"};
+    size_t count = 0;
+    int matches = 1;
+    while (nextLine(&iterator, &line)) {
+        matches &= count < 4 && stringEquals(&line, expected[count]);
+        count++;
+    }
+    ASSERT_TRUE(matches && count == 4, "check the lines");
+    ASSERT_TRUE(line.items >= file.items &&
+                    line.items + line.size == file.items + file.size,
+                "check the lines are views into the mapping");
+    unmapFile(&file);
+    ASSERT_TRUE(file.items == NULL && file.size == 0, "check unmap");
+
+    ASSERT_TRUE(writeTempFile(path, "", 0), "check the file was written");
+    result = mapFile(path, arena);
+    unlink(path);
+    ASSERT_TRUE(result.status == OK && result.string.size == 0,
+                "check an empty file");
+    unmapFile(&result.string);
+    result = mapFile("/tmp/cmain_file_does_not_exist", arena);
+    ASSERT_TRUE(result.status == INVALIDARGS, "check a missing file");
+}
+
+static void testRecords(struct Arena *arena) {
+    char text[] = "a;bb;;ccc;";
+    String string = getStringFromChar(text, sizeof(text) - 1, arena).string;
+    struct LineIterator iterator;
+    initRecordIterator(&iterator, &string, ';');
+    String record;
+    size_t count = 0;
+    size_t total = 0;
+    while (nextLine(&iterator, &record)) {
+        count++;
+        total += record.size;
+    }
+    ASSERT_TRUE(count == 4 && total == 6,
+                "check the trailing delimiter ends the last record");
+
+    // long enough that the newline search runs in vector sized steps
+    char *lines = mallocArena(&arena, 10000);
+    for (size_t i = 0; i < 10000; i++) {
+        lines[i] = i % 97 == 96 ? '\n' : 'x';
+    }
+    String many = getStringFromChar(lines, 10000, arena).string;
+    initLineIterator(&iterator, &many);
+    count = 0;
+    int lengths = 1;
+    while (nextLine(&iterator, &record)) {
+        lengths &= record.size == 96 || count == 103;
+        count++;
+    }
+    ASSERT_TRUE(count == 104 && countLines(&many) == 104,
+                "check a long run of lines");
+    ASSERT_TRUE(lengths, "check the line lengths");
+}
+
+int runFileTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testMapFile);
+    ADD_TEST(testRecords);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_FILE_H
+#define TEST_FILE_H
+
+#include "../file.h"
+#include "unittest.h"
+
+int runFileTests(void);
+
+#endif
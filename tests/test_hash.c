@@ -0,0 +1,119 @@
+#include "test_hash.h"
+#include <stdio.h>
+
+// the published wyhash test vectors, each one hashed with its index as the seed
+static void testKnownValues(struct Arena *arena) {
+    (void)arena;
+    const char *keys[] = {
+        "",
+        "a",
+        "abc",
+        "message digest",
+        "abcdefghijklmnopqrstuvwxyz",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+        "1234567890123456789012345678901234567890123456789012345678901234567"
+        "8901234567890",
+    };
+    const uint64_t expected[] = {
+        0x93228a4de0eec5a2ULL, 0xc5bac3db178713c4ULL, 0xa97f2f7b1d9b3314ULL,
+        0x786d1f1df3801df4ULL, 0xdca5a8138ad37c87ULL, 0xb9e734f117cfaf70ULL,
+        0x6cc5eab49a92d617ULL,
+    };
+    int matches = 1;
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        matches &= hashBytesSeeded(keys[i], strlen(keys[i]), i) == expected[i];
+    }
+    ASSERT_TRUE(matches, "check the test vectors");
+
+    String string = getStringFromChar("message digest", 14, arena).string;
+    ASSERT_TRUE(hashString(&string) == hashBytes("message digest", 14),
+                "check string hash");
+    ASSERT_TRUE(hashStringSeeded(&string, 3) == expected[3],
+                "check seeded string hash");
+    ASSERT_TRUE(hashBytesSeeded("a", 1, 1) != hashBytesSeeded("a", 1, 2),
+                "check the seed changes the hash");
+}
+
+// feed every length in pieces of every size and compare with one shot
+static void testStreaming(struct Arena *arena) {
+    size_t total = 300;
+    uint8_t *bytes = mallocArena(&arena, total);
+    for (size_t i = 0; i < total; i++) {
+        bytes[i] = (uint8_t)((i * 131) + 7);
+    }
+    int matches = 1;
+    size_t pieces[] = {1, 3, 16, 17, 47, 48, 49, 100};
+    for (size_t size = 0; size <= total; size++) {
+        uint64_t expected = hashBytesSeeded(bytes, size, 42);
+        for (size_t p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++) {
+            struct HashState state;
+            initHashState(&state, 42);
+            for (size_t offset = 0; offset < size; offset += pieces[p]) {
+                size_t count = size - offset < pieces[p] ? size - offset
+                                                         : pieces[p];
+                updateHashState(&state, bytes + offset, count);
+            }
+            matches &= finishHashState(&state) == expected;
+        }
+    }
+    ASSERT_TRUE(matches, "check streaming matches one shot");
+}
+
+static void testHashSpans(struct Arena *arena) {
+    BUFFER(char) buffer = NEW_BUFFER();
+    int status = 0;
+    INIT_BUFFER(buffer, arena, 64, status);
+    ASSERT_TRUE(status == OK, "status check");
+    char text[100];
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = (char)('a' + (i % 26));
+    }
+    // move the head along so the next 60 wrap around the end
+    PUSH_BUFFER_N(buffer, text, 40);
+    CONSUME_BUFFER(buffer, 40);
+    PUSH_BUFFER_N(buffer, text + 40, 60);
+    char *first = NULL;
+    char *second = NULL;
+    size_t firstCount = 0;
+    size_t secondCount = 0;
+    BUFFER_READ_SPANS(buffer, first, firstCount, second, secondCount);
+    ASSERT_TRUE(secondCount != 0, "check the buffer wrapped");
+    struct HashState state;
+    initHashState(&state, HASH_DEFAULT_SEED);
+    updateHashState(&state, first, firstCount);
+    updateHashState(&state, second, secondCount);
+    ASSERT_TRUE(finishHashState(&state) == hashBytes(text + 40, 60),
+                "check hashing the spans");
+}
+
+// sequential keys should spread evenly over the low bits
+static void testDistribution(struct Arena *arena) {
+    size_t bucketCount = 64;
+    size_t *buckets = zmallocArena(&arena, bucketCount * sizeof(size_t));
+    size_t keys = 64000;
+    for (uint64_t key = 0; key < keys; key++) {
+        buckets[hashBytes(&key, sizeof(key)) & (bucketCount - 1)]++;
+    }
+    size_t expected = keys / bucketCount;
+    int even = 1;
+    for (size_t i = 0; i < bucketCount; i++) {
+        even &= buckets[i] > expected * 8 / 10 &&
+                buckets[i] < expected * 12 / 10;
+    }
+    ASSERT_TRUE(even, "check the buckets are even");
+}
+
+int runHashTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testKnownValues);
+    ADD_TEST(testStreaming);
+    ADD_TEST(testHashSpans);
+    ADD_TEST(testDistribution);
+    return runTest();
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_HASH_H
+#define TEST_HASH_H
+
+#include "../hash.h"
+#include "../ringbuffer.h"
+#include "unittest.h"
+
+int runHashTests(void);
+
+#endif
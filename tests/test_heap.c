@@ -0,0 +1,139 @@
+#include "test_heap.h"
+#include <stdio.h>
+
+struct Deadline {
+    uint64_t time;
+    int task;
+};
+
+#define INT_LESS(first, second) (*(first) < *(second))
+#define DEADLINE_LESS(first, second) ((first)->time < (second)->time)
+HEAP_DEFINE(int, IntHeap, INT_LESS, 2)
+HEAP_DEFINE(int, IntHeap4, INT_LESS, 4)
+HEAP_DEFINE(struct Deadline, DeadlineHeap, DEADLINE_LESS, 4)
+
+static void testPushPop(struct Arena *arena) {
+    IntHeap binary;
+    IntHeap4 quad;
+    ASSERT_TRUE(IntHeapInit(&binary, arena) == OK, "status check");
+    ASSERT_TRUE(IntHeap4Init(&quad, arena) == OK, "status check");
+    ASSERT_TRUE(IntHeapPeek(&binary) == NULL, "check empty peek");
+    ASSERT_TRUE(IntHeapPop(&binary, NULL) == INVALIDARGS, "check empty pop");
+
+    uint32_t state = 3;
+    int status = 0;
+    for (int i = 0; i < 2000; i++) {
+        int value = (int)(nextRandom(&state) % 500);
+        status |= IntHeapPush(&binary, value, NULL);
+        status |= IntHeap4Push(&quad, value, NULL);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(IntHeapSize(&binary) == 2000, "check size");
+
+    int sorted = 1;
+    int same = 1;
+    int previous = -1;
+    while (IntHeapSize(&binary) != 0) {
+        int first = 0;
+        int second = 0;
+        int peeked = *IntHeapPeek(&binary);
+        status |= IntHeapPop(&binary, &first);
+        status |= IntHeap4Pop(&quad, &second);
+        sorted &= previous <= first && peeked == first;
+        same &= first == second;
+        previous = first;
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(sorted, "check pop order");
+    ASSERT_TRUE(same, "check binary and 4-ary heaps agree");
+    ASSERT_TRUE(IntHeap4Size(&quad) == 0, "check 4-ary heap is empty");
+}
+
+static void testHeapify(struct Arena *arena) {
+    ARRAY(int) values = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(values, arena, status);
+    uint32_t state = 11;
+    for (int i = 0; i < 1000; i++) {
+        PUSH_ARRAY(values, (int)(nextRandom(&state) % 10000), status);
+    }
+    IntHeap4 heap;
+    status |= IntHeap4Init(&heap, arena);
+    status |= IntHeap4Heapify(&heap, values.items, values.size);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(IntHeap4Size(&heap) == 1000, "check size");
+    ASSERT_TRUE(*IntHeap4Get(&heap, 10) == values.items[10],
+                "check handles follow the source index");
+
+    int sorted = 1;
+    int previous = -1;
+    while (IntHeap4Size(&heap) != 0) {
+        int value = 0;
+        status |= IntHeap4Pop(&heap, &value);
+        sorted &= previous <= value;
+        previous = value;
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(sorted, "check heapify order");
+
+    status = IntHeap4Heapify(&heap, NULL, 0);
+    ASSERT_TRUE(status == OK && IntHeap4Size(&heap) == 0,
+                "check empty heapify");
+}
+
+static void testDecreaseKey(struct Arena *arena) {
+    DeadlineHeap heap;
+    ASSERT_TRUE(DeadlineHeapInit(&heap, arena) == OK, "status check");
+    uint32_t handles[100];
+    int status = 0;
+    for (int i = 0; i < 100; i++) {
+        struct Deadline deadline = {.time = 1000 + (uint64_t)i, .task = i};
+        status |= DeadlineHeapPush(&heap, deadline, &handles[i]);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+
+    struct Deadline sooner = {.time = 5, .task = 77};
+    status = DeadlineHeapDecreaseKey(&heap, handles[77], sooner);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(DeadlineHeapPeek(&heap)->task == 77, "check new top");
+    ASSERT_TRUE(DeadlineHeapGet(&heap, handles[77])->time == 5,
+                "check handle still points at the item");
+
+    struct Deadline later = {.time = 9000, .task = 50};
+    status = DeadlineHeapDecreaseKey(&heap, handles[50], later);
+    ASSERT_TRUE(status == INVALIDARGS, "check increase is rejected");
+
+    struct Deadline top;
+    status = DeadlineHeapPop(&heap, &top);
+    ASSERT_TRUE(status == OK && top.task == 77, "check pop");
+    ASSERT_TRUE(DeadlineHeapGet(&heap, handles[77]) == NULL,
+                "check popped handle is stale");
+    status = DeadlineHeapDecreaseKey(&heap, handles[77], sooner);
+    ASSERT_TRUE(status == INVALIDARGS, "check stale handle is rejected");
+
+    // the freed handle gets reused and every other handle still works
+    uint32_t reused = 0;
+    status = DeadlineHeapPush(&heap, sooner, &reused);
+    ASSERT_TRUE(status == OK && reused == handles[77], "check handle reuse");
+    int tracked = 1;
+    for (int i = 0; i < 100; i++) {
+        if (i != 77) {
+            tracked &= DeadlineHeapGet(&heap, handles[i])->task == i;
+        }
+    }
+    ASSERT_TRUE(tracked, "check handles track their items");
+}
+
+int runHeapTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testPushPop);
+    ADD_TEST(testHeapify);
+    ADD_TEST(testDecreaseKey);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_HEAP_H
+#define TEST_HEAP_H
+
+#include "../heap.h"
+#include "unittest.h"
+
+int runHeapTests(void);
+
+#endif
@@ -0,0 +1,81 @@
+#include "test_intern.h"
+#include <stdio.h>
+
+static void testInternString(struct Arena *arena) {
+    struct InternTable table;
+    int status = initInternTable(&table, arena, 0);
+    ASSERT_TRUE(status == OK, "status check");
+
+    char first[] = "identifier";
+    char second[] = "identifier";
+    char third[] = "tag";
+    String firstString = getStringFromChar(first, 10, arena).string;
+    String secondString = getStringFromChar(second, 10, arena).string;
+    String thirdString = getStringFromChar(third, 3, arena).string;
+
+    uint32_t firstId = internString(&table, &firstString);
+    uint32_t secondId = internString(&table, &secondString);
+    uint32_t thirdId = internString(&table, &thirdString);
+    ASSERT_TRUE(firstId == 0, "check the first id is zero");
+    ASSERT_TRUE(firstId == secondId, "check equal strings share an id");
+    ASSERT_TRUE(thirdId == 1, "check ids are dense");
+    ASSERT_TRUE(internTableSize(&table) == 2, "check table size");
+
+    // the table holds its own copy so changing the source is fine
+    first[0] = 'X';
+    struct StringReturn canonical = getInternedString(&table, firstId);
+    ASSERT_TRUE(canonical.status == OK, "status check");
+    ASSERT_TRUE(canonical.string.size == 10, "check canonical size");
+    ASSERT_TRUE(!memcmp(getChar(&canonical.string), "identifier", 10),
+                "check canonical copy");
+    ASSERT_TRUE(findInternedString(&table, &secondString) == firstId,
+                "check find returns the id");
+    ASSERT_TRUE(findInternedString(&table, &firstString) == INTERN_INVALID_ID,
+                "check find doesn't add strings");
+    freeInternTable(&table);
+}
+
+static void testInternGrowth(struct Arena *arena) {
+    struct InternTable table;
+    int status = initInternTable(&table, arena, 1);
+    ASSERT_TRUE(status == OK, "status check");
+    char buffer[16];
+    // enough strings to force the slots to grow a few times
+    for (int i = 0; i < 1000; i++) {
+        int size = snprintf(buffer, sizeof(buffer), "name%d", i);
+        String string = getStringFromChar(buffer, size, arena).string;
+        if (internString(&table, &string) != (uint32_t)i) {
+            ASSERT_TRUE(0, "check ids are handed out in order");
+            break;
+        }
+    }
+    ASSERT_TRUE(internTableSize(&table) == 1000, "check table size");
+    int size = snprintf(buffer, sizeof(buffer), "name%d", 421);
+    String string = getStringFromChar(buffer, size, arena).string;
+    ASSERT_TRUE(internString(&table, &string) == 421,
+                "check lookups after growth");
+    struct StringReturn canonical = getInternedString(&table, 999);
+    ASSERT_TRUE(canonical.status == OK && canonical.string.size == 7 &&
+                    !memcmp(getChar(&canonical.string), "name999", 7),
+                "check lookup by id after growth");
+
+    String empty = getStringFromChar("", 0, arena).string;
+    ASSERT_TRUE(internString(&table, &empty) == 1000,
+                "check the empty string can be interned");
+    ASSERT_TRUE(internString(&table, &empty) == 1000,
+                "check the empty string is found again");
+    freeInternTable(&table);
+}
+
+int runInternTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testInternString);
+    ADD_TEST(testInternGrowth);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_INTERN_H
+#define TEST_INTERN_H
+
+#include "../intern.h"
+#include "unittest.h"
+
+int runInternTests(void);
+
+#endif
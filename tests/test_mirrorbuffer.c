@@ -0,0 +1,112 @@
+#include "test_mirrorbuffer.h"
+#include <stdio.h>
+#include <string.h>
+
+static void testMirror(struct Arena *arena) {
+    struct MirrorBuffer *buffer = createMirrorBuffer(&arena, 100);
+    ASSERT_TRUE(buffer != NULL, "check create");
+    if (buffer == NULL) {
+        return;
+    }
+    size_t capacity = buffer->capacity;
+    ASSERT_TRUE(capacity >= 100 && (capacity & (capacity - 1)) == 0,
+                "check capacity is a power of two");
+    buffer->data[0] = 42;
+    buffer->data[capacity - 1] = 7;
+    ASSERT_TRUE(buffer->data[capacity] == 42, "check the second mapping");
+    buffer->data[capacity + 1] = 9;
+    ASSERT_TRUE(buffer->data[1] == 9, "check writes show up in the first");
+    ASSERT_TRUE(buffer->data[(2 * capacity) - 1] == 7, "check the last byte");
+    destroyMirrorBuffer(&buffer);
+    ASSERT_TRUE(buffer == NULL, "check destroy");
+}
+
+static void testPushPop(struct Arena *arena) {
+    struct MirrorBuffer *buffer = createMirrorBuffer(&arena, 1);
+    ASSERT_TRUE(buffer != NULL, "check create");
+    if (buffer == NULL) {
+        return;
+    }
+    size_t capacity = buffer->capacity;
+    uint8_t *data = mallocArena(&arena, capacity);
+    for (size_t i = 0; i < capacity; i++) {
+        data[i] = (uint8_t)i;
+    }
+    // move near the end so the next push wraps
+    ASSERT_TRUE(pushMirrorBuffer(buffer, data, capacity - 3) == OK,
+                "check push");
+    ASSERT_TRUE(pushMirrorBuffer(buffer, data, 4) == BUFFERFULL,
+                "check push that doesn't fit");
+    ASSERT_TRUE(popMirrorBuffer(buffer, data, capacity - 3) == capacity - 3,
+                "check pop");
+    const char message[] = "hello over the wrap";
+    ASSERT_TRUE(pushMirrorBuffer(buffer, message, sizeof(message)) == OK,
+                "check push");
+    size_t count = 0;
+    uint8_t *span = mirrorBufferReadSpan(buffer, &count);
+    ASSERT_TRUE(count == sizeof(message), "check read span size");
+    ASSERT_TRUE(memcmp(span, message, sizeof(message)) == 0,
+                "check the span is contiguous across the wrap");
+    char out[sizeof(message)] = {0};
+    ASSERT_TRUE(popMirrorBuffer(buffer, out, 100) == sizeof(message),
+                "check pop is clamped");
+    ASSERT_TRUE(strcmp(out, message) == 0, "check popped bytes");
+    ASSERT_TRUE(mirrorBufferSize(buffer) == 0, "check empty");
+    destroyMirrorBuffer(&buffer);
+}
+
+// length prefixed messages written straight into the write span. The reader
+// parses them in place, including the ones that straddle the end
+static void testParseInPlace(struct Arena *arena) {
+    struct MirrorBuffer *buffer = createMirrorBuffer(&arena, 1);
+    ASSERT_TRUE(buffer != NULL, "check create");
+    if (buffer == NULL) {
+        return;
+    }
+    uint32_t nextWrite = 0;
+    uint32_t nextRead = 0;
+    int valid = 1;
+    for (int round = 0; round < 200; round++) {
+        for (;;) {
+            uint32_t length = 1 + ((nextWrite * 7) % 50);
+            size_t space = 0;
+            uint8_t *span = mirrorBufferWriteSpan(buffer, &space);
+            if (space < length + 1) {
+                break;
+            }
+            span[0] = (uint8_t)length;
+            memset(span + 1, (int)(nextWrite & 0xff), length);
+            commitMirrorBuffer(buffer, length + 1);
+            nextWrite++;
+        }
+        // only read about half so the head lands somewhere new each round
+        size_t count = 0;
+        uint8_t *span = mirrorBufferReadSpan(buffer, &count);
+        size_t used = 0;
+        while (used < count / 2) {
+            uint32_t length = span[used];
+            valid &= length == 1 + ((nextRead * 7) % 50);
+            valid &= span[used + length] == (uint8_t)nextRead;
+            used += length + 1;
+            nextRead++;
+        }
+        consumeMirrorBuffer(buffer, used);
+    }
+    ASSERT_TRUE(valid, "check every message parsed in place");
+    ASSERT_TRUE(buffer->head > 4 * buffer->capacity, "check it wrapped");
+    destroyMirrorBuffer(&buffer);
+}
+
+int runMirrorBufferTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testMirror);
+    ADD_TEST(testPushPop);
+    ADD_TEST(testParseInPlace);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_MIRRORBUFFER_H
+#define TEST_MIRRORBUFFER_H
+
+#include "../mirrorbuffer.h"
+#include "unittest.h"
+
+int runMirrorBufferTests(void);
+
+#endif
@@ -0,0 +1,226 @@
+#include "test_mpmcbuffer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define THREAD_COUNT 3
+#define ITEMS_PER_PRODUCER 50000
+#define BATCH_SIZE 8
+
+typedef MPMC_BUFFER(uint64_t) MpmcQueue;
+
+struct Shared {
+    MpmcQueue queue;
+    _Atomic uint64_t consumed;
+};
+
+struct Worker {
+    struct Shared *shared;
+    uint64_t id;
+    int batched;
+    // consumer results
+    uint64_t sum;
+    uint64_t count;
+    int ordered;
+};
+
+// items are the producer id in the top bits and a counter that starts at 1
+static void *producer(void *context) {
+    struct Worker *worker = context;
+    uint64_t batch[BATCH_SIZE];
+    uint64_t next = 1;
+    int status = 0;
+    while (next <= ITEMS_PER_PRODUCER) {
+        if (!worker->batched) {
+            TRY_PUSH_MPMC_BUFFER(worker->shared->queue,
+                                 (worker->id << 32) | next, status);
+            if (status == BUFFERFULL) {
+                sched_yield();
+                continue;
+            }
+            next++;
+            continue;
+        }
+        size_t count = 0;
+        while (count < BATCH_SIZE && next + count <= ITEMS_PER_PRODUCER) {
+            batch[count] = (worker->id << 32) | (next + count);
+            count++;
+        }
+        size_t pushed = 0;
+        PUSH_MPMC_BUFFER_N(worker->shared->queue, batch, count, pushed);
+        if (pushed == 0) {
+            sched_yield();
+        }
+        next += pushed;
+    }
+    return NULL;
+}
+
+// every consumer should see the items from one producer in the order they
+// were pushed
+static void *consumer(void *context) {
+    struct Worker *worker = context;
+    uint64_t last[THREAD_COUNT] = {0};
+    uint64_t batch[BATCH_SIZE];
+    const uint64_t total = (uint64_t)THREAD_COUNT * ITEMS_PER_PRODUCER;
+    int status = 0;
+    worker->ordered = 1;
+    while (atomic_load(&worker->shared->consumed) < total) {
+        size_t popped = 0;
+        if (worker->batched) {
+            POP_MPMC_BUFFER_N(worker->shared->queue, batch, BATCH_SIZE,
+                              popped);
+        }
+        else {
+            TRY_POP_MPMC_BUFFER(worker->shared->queue, batch[0], status);
+            popped = status == OK;
+        }
+        if (popped == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < popped; i++) {
+            uint64_t from = batch[i] >> 32;
+            uint64_t value = batch[i] & UINT32_MAX;
+            worker->ordered &= from < THREAD_COUNT && value > last[from];
+            last[from % THREAD_COUNT] = value;
+            worker->sum += value;
+        }
+        worker->count += popped;
+        atomic_fetch_add(&worker->shared->consumed, popped);
+    }
+    return NULL;
+}
+
+static void testSingleThread(struct Arena *arena) {
+    MpmcQueue queue;
+    int status = 0;
+    INIT_MPMC_BUFFER(queue, arena, 5, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(MPMC_BUFFER_CAPACITY(queue) == 8, "check round up");
+    INIT_MPMC_BUFFER(queue, arena, 1, status);
+    ASSERT_TRUE(status == INVALIDARGS, "check too small");
+    INIT_MPMC_BUFFER(queue, arena, 4, status);
+
+    uint64_t item = 0;
+    TRY_POP_MPMC_BUFFER(queue, item, status);
+    ASSERT_TRUE(status == BUFFEREMPTY, "check empty pop");
+    for (uint64_t i = 0; i < 4; i++) {
+        TRY_PUSH_MPMC_BUFFER(queue, i, status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    TRY_PUSH_MPMC_BUFFER(queue, 99, status);
+    ASSERT_TRUE(status == BUFFERFULL, "check full push");
+
+    TRY_POP_MPMC_BUFFER(queue, item, status);
+    ASSERT_TRUE(status == OK && item == 0, "check pop order");
+    TRY_PUSH_MPMC_BUFFER(queue, 4, status);
+    ASSERT_TRUE(status == OK, "check push after pop");
+    int ordered = 1;
+    // go around a few laps to make sure the sequences keep up
+    for (uint64_t i = 1; i < 40; i++) {
+        TRY_POP_MPMC_BUFFER(queue, item, status);
+        ordered &= status == OK && item == i;
+        TRY_PUSH_MPMC_BUFFER(queue, i + 4, status);
+        ordered &= status == OK;
+    }
+    ASSERT_TRUE(ordered, "check wrapped items");
+}
+
+static void testBatches(struct Arena *arena) {
+    MpmcQueue queue;
+    int status = 0;
+    INIT_MPMC_BUFFER(queue, arena, 8, status);
+    ASSERT_TRUE(status == OK, "status check");
+
+    uint64_t items[12] = {0};
+    for (uint64_t i = 0; i < 12; i++) {
+        items[i] = i + 1;
+    }
+    size_t pushed = 0;
+    PUSH_MPMC_BUFFER_N(queue, items, 5, pushed);
+    ASSERT_TRUE(pushed == 5, "check batch push");
+    PUSH_MPMC_BUFFER_N(queue, items + 5, 7, pushed);
+    ASSERT_TRUE(pushed == 3, "check batch push stops when full");
+    PUSH_MPMC_BUFFER_N(queue, items, 1, pushed);
+    ASSERT_TRUE(pushed == 0, "check batch push into a full buffer");
+
+    uint64_t out[12] = {0};
+    size_t popped = 0;
+    POP_MPMC_BUFFER_N(queue, out, 3, popped);
+    ASSERT_TRUE(popped == 3 && out[0] == 1 && out[2] == 3, "check batch pop");
+    uint64_t item = 0;
+    TRY_POP_MPMC_BUFFER(queue, item, status);
+    ASSERT_TRUE(status == OK && item == 4, "check single pop after batch");
+    PUSH_MPMC_BUFFER_N(queue, items + 8, 4, pushed);
+    ASSERT_TRUE(pushed == 4, "check batch push wraps");
+    POP_MPMC_BUFFER_N(queue, out, 12, popped);
+    int ordered = popped == 8;
+    for (size_t i = 0; i < popped; i++) {
+        ordered &= out[i] == i + 5;
+    }
+    ASSERT_TRUE(ordered, "check batch pop wraps");
+    POP_MPMC_BUFFER_N(queue, out, 12, popped);
+    ASSERT_TRUE(popped == 0, "check batch pop from an empty buffer");
+}
+
+static void runThreads(struct Arena *arena, int batched) {
+    struct Shared *shared = mallocArena(&arena, sizeof(struct Shared));
+    struct Worker *workers =
+        mallocArena(&arena, 2 * THREAD_COUNT * sizeof(struct Worker));
+    int status = 0;
+    INIT_MPMC_BUFFER(shared->queue, arena, 64, status);
+    atomic_init(&shared->consumed, 0);
+    ASSERT_TRUE(status == OK, "status check");
+
+    pthread_t threads[2 * THREAD_COUNT];
+    int started = 1;
+    for (uint64_t i = 0; i < 2 * THREAD_COUNT; i++) {
+        // mix single and batched calls when batched is set
+        workers[i] = (struct Worker){shared, i % THREAD_COUNT,
+                                     batched && (i % 2 == 0), 0, 0, 1};
+        started &= pthread_create(&threads[i], NULL,
+                                  i < THREAD_COUNT ? producer : consumer,
+                                  &workers[i]) == 0;
+    }
+    ASSERT_TRUE(started, "check thread start");
+    for (int i = 0; i < 2 * THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    uint64_t sum = 0;
+    uint64_t count = 0;
+    int ordered = 1;
+    for (int i = THREAD_COUNT; i < 2 * THREAD_COUNT; i++) {
+        sum += workers[i].sum;
+        count += workers[i].count;
+        ordered &= workers[i].ordered;
+    }
+    const uint64_t perProducer =
+        (uint64_t)ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER + 1) / 2;
+    ASSERT_TRUE(ordered, "check each producer's items arrived in order");
+    ASSERT_TRUE(count == (uint64_t)THREAD_COUNT * ITEMS_PER_PRODUCER,
+                "check item count");
+    ASSERT_TRUE(sum == THREAD_COUNT * perProducer, "check nothing was lost");
+}
+
+static void testManyThreads(struct Arena *arena) { runThreads(arena, 0); }
+
+static void testManyThreadsBatched(struct Arena *arena) {
+    runThreads(arena, 1);
+}
+
+int runMpmcBufferTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testSingleThread);
+    ADD_TEST(testBatches);
+    ADD_TEST(testManyThreads);
+    ADD_TEST(testManyThreadsBatched);
+    return runTest();
+}
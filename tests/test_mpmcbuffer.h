@@ -0,0 +1,9 @@
+#ifndef TEST_MPMCBUFFER_H
+#define TEST_MPMCBUFFER_H
+
+#include "../mpmcbuffer.h"
+#include "unittest.h"
+
+int runMpmcBufferTests(void);
+
+#endif
@@ -0,0 +1,209 @@
+#include "test_number.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static String view(const char *text, struct Arena *arena) {
+    return getStringFromChar((char *)text, strlen(text), arena).string;
+}
+
+static void testParseIntegers(struct Arena *arena) {
+    int64_t value = 0;
+    String string = view("12345", arena);
+    ASSERT_TRUE(parseInt64(&string, &value) == OK && value == 12345,
+                "check parse");
+    string = view("-9223372036854775808", arena);
+    ASSERT_TRUE(parseInt64(&string, &value) == OK && value == INT64_MIN,
+                "check the smallest int64");
+    string = view("+9223372036854775807", arena);
+    ASSERT_TRUE(parseInt64(&string, &value) == OK && value == INT64_MAX,
+                "check the largest int64");
+    string = view("9223372036854775808", arena);
+    ASSERT_TRUE(parseInt64(&string, &value) == OUTOFRANGE &&
+                    value == INT64_MAX,
+                "check int64 overflow is clamped");
+    string = view("-99999999999999999999999", arena);
+    ASSERT_TRUE(parseInt64(&string, &value) == OUTOFRANGE &&
+                    value == INT64_MIN,
+                "check int64 underflow is clamped");
+
+    const char *bad[] = {"", "-", "+", "12a", "1 2", " 12", "1.5", "0x10"};
+    int rejected = 1;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        string = view(bad[i], arena);
+        rejected &= parseInt64(&string, &value) == INVALIDARGS;
+    }
+    ASSERT_TRUE(rejected, "check bad integers are rejected");
+
+    uint64_t unsignedValue = 0;
+    string = view("18446744073709551615", arena);
+    ASSERT_TRUE(parseUint64(&string, &unsignedValue) == OK &&
+                    unsignedValue == UINT64_MAX,
+                "check the largest uint64");
+    string = view("18446744073709551616", arena);
+    ASSERT_TRUE(parseUint64(&string, &unsignedValue) == OUTOFRANGE &&
+                    unsignedValue == UINT64_MAX,
+                "check uint64 overflow");
+    string = view("-1", arena);
+    ASSERT_TRUE(parseUint64(&string, &unsignedValue) == OUTOFRANGE,
+                "check negative uint64");
+    string = view("-0", arena);
+    ASSERT_TRUE(parseUint64(&string, &unsignedValue) == OK &&
+                    unsignedValue == 0,
+                "check negative zero");
+
+    // format and parse back numbers of every length so the eight digit
+    // blocks and the digit pairs both get used
+    char buffer[NUMBER_BUFFER_SIZE];
+    int matches = 1;
+    uint64_t number = 1;
+    for (int digits = 1; digits <= 19; digits++) {
+        number = (number * 10) + (uint64_t)(digits % 10);
+        for (int sign = -1; sign <= 1; sign += 2) {
+            int64_t expected = sign * (int64_t)(number / 10);
+            size_t length = formatInt64(buffer, expected);
+            char reference[NUMBER_BUFFER_SIZE];
+            snprintf(reference, sizeof(reference), "%lld", (long long)expected);
+            matches &= length == strlen(reference) &&
+                       !memcmp(buffer, reference, length);
+            String formatted = getStringFromChar(buffer, length, arena).string;
+            matches &=
+                parseInt64(&formatted, &value) == OK && value == expected;
+        }
+    }
+    ASSERT_TRUE(matches, "check integers round trip");
+}
+
+static void testParseDoubles(struct Arena *arena) {
+    struct {
+        const char *text;
+        double expected;
+    } cases[] = {
+        {"0", 0.0},
+        {"-0.0", -0.0},
+        {"1.5", 1.5},
+        {".25", 0.25},
+        {"5.", 5.0},
+        {"1e10", 1e10},
+        {"1E-5", 1e-5},
+        {"-123.456e+2", -12345.6},
+        {"0.1", 0.1},
+        {"3.141592653589793", 3.141592653589793},
+        {"1.7976931348623157e308", 1.7976931348623157e308},
+        {"2.2250738585072014e-308", 2.2250738585072014e-308},
+        {"4.9406564584124654e-324", 4.9406564584124654e-324},
+        {"1e-400", 0.0},
+        {"123456789012345678901234567890", 123456789012345678901234567890.0},
+        {"0.000000000000000000000000000001", 1e-30},
+        {"9007199254740993", 9007199254740992.0},
+    };
+    int matches = 1;
+    double value = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        String string = view(cases[i].text, arena);
+        int status = parseDouble(&string, &value);
+        matches &= status == OK && value == cases[i].expected &&
+                   signbit(value) == signbit(cases[i].expected);
+    }
+    ASSERT_TRUE(matches, "check parsed doubles");
+
+    String string = view("1e309", arena);
+    ASSERT_TRUE(parseDouble(&string, &value) == OUTOFRANGE && isinf(value),
+                "check overflow");
+    string = view("-Infinity", arena);
+    ASSERT_TRUE(parseDouble(&string, &value) == OK && isinf(value) &&
+                    value < 0,
+                "check infinity");
+    string = view("NaN", arena);
+    ASSERT_TRUE(parseDouble(&string, &value) == OK && isnan(value),
+                "check nan");
+    const char *bad[] = {"", ".", "-", "e5", "1e", "1e+", "1.2.3", "1f", "in"};
+    int rejected = 1;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        string = view(bad[i], arena);
+        rejected &= parseDouble(&string, &value) == INVALIDARGS;
+    }
+    ASSERT_TRUE(rejected, "check bad doubles are rejected");
+}
+
+static int formatsAs(double value, const char *expected) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    size_t length = formatDouble(buffer, value);
+    return length == strlen(expected) && !memcmp(buffer, expected, length);
+}
+
+static void testFormatDoubles(struct Arena *arena) {
+    ASSERT_TRUE(formatsAs(0.0, "0") && formatsAs(-0.0, "-0"), "check zeros");
+    ASSERT_TRUE(formatsAs(1.0, "1") && formatsAs(123456.0, "123456"),
+                "check whole numbers");
+    ASSERT_TRUE(formatsAs(0.1, "0.1") && formatsAs(0.3, "0.3") &&
+                    formatsAs(0.1 + 0.2, "0.30000000000000004"),
+                "check shortest digits");
+    ASSERT_TRUE(formatsAs(1e21, "1e+21") &&
+                    formatsAs(1e20, "100000000000000000000"),
+                "check the switch to exponents");
+    ASSERT_TRUE(formatsAs(0.000001, "0.000001") && formatsAs(1e-7, "1e-7"),
+                "check small numbers");
+    ASSERT_TRUE(formatsAs(5e-324, "5e-324") &&
+                    formatsAs(1.7976931348623157e308,
+                              "1.7976931348623157e+308"),
+                "check the ends of the range");
+    ASSERT_TRUE(formatsAs(HUGE_VAL, "inf") && formatsAs(-HUGE_VAL, "-inf") &&
+                    formatsAs(NAN, "nan"),
+                "check special values");
+
+    // random bit patterns have to come back exactly and with no more digits
+    // than needed
+    uint64_t random = 88172645463325252ULL;
+    int roundTrips = 1;
+    int shortest = 1;
+    for (int i = 0; i < 20000; i++) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        double value = 0;
+        memcpy(&value, &random, sizeof(value));
+        if (isnan(value)) {
+            continue;
+        }
+        struct StringReturn result = doubleToString(value, arena);
+        double parsed = 0;
+        parseDouble(&result.string, &parsed);
+        roundTrips &= !memcmp(&parsed, &value, sizeof(value));
+        // count the significant digits and check one less doesn't work
+        size_t digits = 0;
+        int leading = 1;
+        for (size_t k = 0; k < result.string.size; k++) {
+            char character = result.string.items[k];
+            if (character == 'e') {
+                break;
+            }
+            if (character >= '1' && character <= '9') {
+                leading = 0;
+            }
+            digits += !leading && character >= '0' && character <= '9';
+        }
+        char shorter[40];
+        if (digits > 1 &&
+            memchr(result.string.items, '.', result.string.size) != NULL) {
+            snprintf(shorter, sizeof(shorter), "%.*e", (int)digits - 2, value);
+            shortest &= strtod(shorter, NULL) != value;
+        }
+    }
+    ASSERT_TRUE(roundTrips, "check random doubles round trip");
+    ASSERT_TRUE(shortest, "check random doubles are shortest");
+}
+
+int runNumberTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testParseIntegers);
+    ADD_TEST(testParseDoubles);
+    ADD_TEST(testFormatDoubles);
+    return runTest();
+}
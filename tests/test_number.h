@@ -0,0 +1,9 @@
+#ifndef TEST_NUMBER_H
+#define TEST_NUMBER_H
+
+#include "../number.h"
+#include "unittest.h"
+
+int runNumberTests(void);
+
+#endif
@@ -0,0 +1,173 @@
+#include "test_rope.h"
+#include <stdio.h>
+#include <string.h>
+
+static int ropeEquals(const struct Rope *rope, const char *expected,
+                      size_t size) {
+    struct StringReturn flat = flattenRope(rope);
+    return flat.status == OK && flat.string.size == size &&
+           memcmp(flat.string.items, expected, size) == 0;
+}
+
+static size_t chunkCount(const struct Rope *rope) {
+    struct RopeIterator iterator;
+    initRopeIterator(&iterator, rope);
+    String chunk;
+    size_t count = 0;
+    while (nextRopeChunk(&iterator, &chunk)) {
+        count++;
+    }
+    return count;
+}
+
+static void testRopeEdits(struct Arena *arena) {
+    struct Rope rope;
+    int status = initRope(&rope, arena);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(ropeSize(&rope) == 0 && ropeEquals(&rope, "", 0),
+                "check empty rope");
+
+    const char text[] = "hello world";
+    String view = {(char *)text, sizeof(text) - 1, sizeof(text) - 1, arena};
+    status = appendRopeView(&rope, &view);
+    ASSERT_TRUE(status == OK && ropeSize(&rope) == 11, "check append");
+    status = insertRope(&rope, 5, ",", 1);
+    ASSERT_TRUE(status == OK && ropeEquals(&rope, "hello, world", 12),
+                "check insert in the middle");
+    insertRope(&rope, 12, "!", 1);
+    insertRope(&rope, 0, ">> ", 3);
+    ASSERT_TRUE(ropeEquals(&rope, ">> hello, world!", 16),
+                "check insert at the ends");
+    ASSERT_TRUE(ropeCharAt(&rope, 3) == 'h' && ropeCharAt(&rope, 15) == '!',
+                "check char at");
+    ASSERT_TRUE(insertRope(&rope, 17, "x", 1) == INVALIDARGS,
+                "check insert past the end");
+
+    status = deleteRope(&rope, 8, 1);
+    ASSERT_TRUE(status == OK && ropeEquals(&rope, ">> hello world!", 15),
+                "check delete");
+    deleteRope(&rope, 14, 100);
+    ASSERT_TRUE(ropeEquals(&rope, ">> hello world", 14),
+                "check delete is clamped");
+
+    struct Rope word;
+    status = substringRope(&rope, 3, 5, &word);
+    ASSERT_TRUE(status == OK && ropeEquals(&word, "hello", 5),
+                "check substring");
+    deleteRope(&rope, 0, 9);
+    ASSERT_TRUE(ropeEquals(&rope, "world", 5) && ropeEquals(&word, "hello", 5),
+                "check substring survives edits to the original");
+
+    status = concatRope(&word, &rope);
+    ASSERT_TRUE(status == OK && ropeEquals(&word, "helloworld", 10),
+                "check concat");
+    concatRope(&word, &word);
+    ASSERT_TRUE(ropeEquals(&word, "helloworldhelloworld", 20),
+                "check concat with itself");
+    ASSERT_TRUE(ropeEquals(&rope, "world", 5), "check other is unchanged");
+    ASSERT_TRUE(view.items == text && !memcmp(text, "hello world", 11),
+                "check the view was never written to");
+}
+
+// typing one byte at a time should merge into a few chunks
+static void testSmallInserts(struct Arena *arena) {
+    struct Rope rope;
+    initRope(&rope, arena);
+    char expected[1000];
+    int status = OK;
+    for (size_t i = 0; i < sizeof(expected); i++) {
+        expected[i] = (char)('a' + (i % 26));
+        status |= insertRope(&rope, i, &expected[i], 1);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(ropeEquals(&rope, expected, sizeof(expected)),
+                "check the typed text");
+    ASSERT_TRUE(chunkCount(&rope) <= sizeof(expected) / 64,
+                "check the bytes were merged into chunks");
+}
+
+// random edits against a plain array doing the same thing
+static void testRandomEdits(struct Arena *arena) {
+    enum { CAPACITY = 1 << 16 };
+    char *model = mallocArena(&arena, CAPACITY);
+    char *source = mallocArena(&arena, CAPACITY);
+    for (size_t i = 0; i < CAPACITY; i++) {
+        source[i] = (char)('A' + (i % 53));
+    }
+    struct Rope rope;
+    initRope(&rope, arena);
+    String view = {source, 4096, 4096, arena};
+    appendRopeView(&rope, &view);
+    memcpy(model, source, 4096);
+    size_t size = 4096;
+    uint32_t random = 12345;
+    int matches = 1;
+    int status = OK;
+    for (size_t step = 0; step < 4000; step++) {
+        random = (random * 1103515245) + 12345;
+        size_t position = (random >> 8) % (size + 1);
+        size_t count = (random >> 4) % 300;
+        switch ((random >> 28) % 4) {
+        case 0:
+        case 1:
+            if (size + count > CAPACITY) {
+                break;
+            }
+            status |= insertRope(&rope, position, source + step, count);
+            memmove(model + position + count, model + position,
+                    size - position);
+            memcpy(model + position, source + step, count);
+            size += count;
+            break;
+        case 2: {
+            status |= deleteRope(&rope, position, count);
+            count = count < size - position ? count : size - position;
+            memmove(model + position, model + position + count,
+                    size - position - count);
+            size -= count;
+            break;
+        }
+        default: {
+            struct Rope substring;
+            status |= substringRope(&rope, position, count, &substring);
+            count = count < size - position ? count : size - position;
+            matches &= ropeEquals(&substring, model + position, count);
+            break;
+        }
+        }
+        matches &= ropeSize(&rope) == size;
+        if (step % 500 == 0 && size != 0) {
+            matches &= ropeCharAt(&rope, position % size) ==
+                       model[position % size];
+        }
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(matches, "check sizes and substrings during the edits");
+    ASSERT_TRUE(ropeEquals(&rope, model, size), "check the final text");
+
+    struct RopeIterator iterator;
+    initRopeIterator(&iterator, &rope);
+    String chunk;
+    size_t offset = 0;
+    int ordered = 1;
+    while (nextRopeChunk(&iterator, &chunk)) {
+        ordered &= chunk.size != 0 && offset + chunk.size <= size &&
+                   !memcmp(chunk.items, model + offset, chunk.size);
+        offset += chunk.size;
+    }
+    ASSERT_TRUE(ordered && offset == size, "check the chunks are in order");
+}
+
+int runRopeTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testRopeEdits);
+    ADD_TEST(testSmallInserts);
+    ADD_TEST(testRandomEdits);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_ROPE_H
+#define TEST_ROPE_H
+
+#include "../rope.h"
+#include "unittest.h"
+
+int runRopeTests(void);
+
+#endif
@@ -0,0 +1,105 @@
+#include "test_slotmap.h"
+#include <stdio.h>
+
+struct Entity {
+    int id;
+    float x;
+};
+
+static void testInsertGet(struct Arena *arena) {
+    SLOTMAP(struct Entity) entities = NEW_SLOTMAP();
+    int status = 0;
+    INIT_SLOTMAP(entities, arena, status);
+    ASSERT_TRUE(status == OK, "status check");
+
+    struct SlotMapHandle handles[500];
+    for (int i = 0; i < 500; i++) {
+        struct Entity entity = {.id = i, .x = (float)i * 0.5f};
+        SLOTMAP_INSERT(entities, entity, handles[i], status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(SLOTMAP_SIZE(entities) == 500, "check size");
+
+    // handles keep working after the dense array has been moved by growth
+    int found = 1;
+    for (int i = 0; i < 500; i++) {
+        struct Entity *entity = NULL;
+        SLOTMAP_GET(entities, handles[i], entity);
+        found &= entity != NULL && entity->id == i;
+    }
+    ASSERT_TRUE(found, "check every handle finds its item");
+
+    struct Entity *missing = NULL;
+    SLOTMAP_GET(entities, NULL_SLOTMAP_HANDLE, missing);
+    ASSERT_TRUE(missing == NULL, "check null handle");
+    struct SlotMapHandle outOfRange = {9999, 1};
+    ASSERT_FALSE(SLOTMAP_CONTAINS(entities, outOfRange), "check bad index");
+}
+
+static void testRemove(struct Arena *arena) {
+    SLOTMAP(int) values = NEW_SLOTMAP();
+    int status = 0;
+    INIT_SLOTMAP(values, arena, status);
+    struct SlotMapHandle handles[100];
+    for (int i = 0; i < 100; i++) {
+        SLOTMAP_INSERT(values, i, handles[i], status);
+    }
+
+    // remove every even item
+    for (int i = 0; i < 100; i += 2) {
+        SLOTMAP_REMOVE(values, handles[i], status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(SLOTMAP_SIZE(values) == 50, "check size after remove");
+
+    int packed = 1;
+    for (size_t i = 0; i < values.items.size; i++) {
+        packed &= values.items.items[i] % 2 == 1;
+    }
+    ASSERT_TRUE(packed, "check dense array only holds live items");
+
+    int tracked = 1;
+    for (int i = 0; i < 100; i++) {
+        int *value = NULL;
+        SLOTMAP_GET(values, handles[i], value);
+        tracked &= i % 2 == 0 ? value == NULL : value != NULL && *value == i;
+    }
+    ASSERT_TRUE(tracked, "check handles after swap remove");
+
+    SLOTMAP_REMOVE(values, handles[0], status);
+    ASSERT_TRUE(status == INVALIDARGS, "check double remove");
+
+    // freed slots are reused with a new generation
+    struct SlotMapHandle reused;
+    SLOTMAP_INSERT(values, 1000, reused, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(reused.index == handles[98].index, "check slot reuse");
+    ASSERT_TRUE(reused.generation != handles[98].generation,
+                "check generation bump");
+    ASSERT_FALSE(SLOTMAP_CONTAINS(values, handles[98]),
+                 "check stale handle stays stale");
+    int *value = NULL;
+    SLOTMAP_GET(values, reused, value);
+    ASSERT_TRUE(value != NULL && *value == 1000, "check reused slot");
+
+    // empty the map completely
+    for (int i = 1; i < 100; i += 2) {
+        SLOTMAP_REMOVE(values, handles[i], status);
+    }
+    SLOTMAP_REMOVE(values, reused, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(SLOTMAP_SIZE(values) == 0, "check empty");
+}
+
+int runSlotMapTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testInsertGet);
+    ADD_TEST(testRemove);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_SLOTMAP_H
+#define TEST_SLOTMAP_H
+
+#include "../slotmap.h"
+#include "unittest.h"
+
+int runSlotMapTests(void);
+
+#endif
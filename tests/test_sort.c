@@ -0,0 +1,137 @@
+#include "test_sort.h"
+#include <stdio.h>
+
+struct Record {
+    int key;
+    int order;
+};
+
+#define RECORD_LESS(first, second) ((first)->key < (second)->key)
+SORT_DEFINE(struct Record, sortRecords, RECORD_LESS)
+
+static void testSortIntegers(struct Arena *arena) {
+    ARRAY(int32_t) integers = NEW_ARRAY();
+    ARRAY(uint64_t) longs = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(integers, arena, status);
+    INIT_ARRAY(longs, arena, status);
+    uint32_t state = 7;
+    for (int i = 0; i < 5000; i++) {
+        PUSH_ARRAY(integers, (int32_t)nextRandom(&state), status);
+        uint64_t wide = ((uint64_t)nextRandom(&state) << 32) | i;
+        PUSH_ARRAY(longs, wide, status);
+    }
+    SORT_ARRAY(integers, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int sorted = 1;
+    for (size_t i = 1; i < integers.size; i++) {
+        sorted &= integers.items[i - 1] <= integers.items[i];
+    }
+    ASSERT_TRUE(sorted, "check int32 order");
+    ASSERT_TRUE(integers.items[0] < 0, "check negatives sort first");
+
+    SORT_ARRAY(longs, status);
+    ASSERT_TRUE(status == OK, "status check");
+    sorted = 1;
+    for (size_t i = 1; i < longs.size; i++) {
+        sorted &= longs.items[i - 1] <= longs.items[i];
+    }
+    ASSERT_TRUE(sorted, "check uint64 order");
+}
+
+static void testSortFloats(struct Arena *arena) {
+    ARRAY(float) floats = NEW_ARRAY();
+    ARRAY(double) doubles = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(floats, arena, status);
+    INIT_ARRAY(doubles, arena, status);
+    uint32_t state = 11;
+    for (int i = 0; i < 1000; i++) {
+        float value = ((float)(nextRandom(&state) % 20001) - 10000.0f) / 7.0f;
+        PUSH_ARRAY(floats, value, status);
+        PUSH_ARRAY(doubles, (double)value * 1e10, status);
+    }
+    SORT_ARRAY(floats, status);
+    ASSERT_TRUE(status == OK, "status check");
+    SORT_ARRAY(doubles, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int sorted = 1;
+    for (size_t i = 1; i < floats.size; i++) {
+        sorted &= floats.items[i - 1] <= floats.items[i];
+        sorted &= doubles.items[i - 1] <= doubles.items[i];
+    }
+    ASSERT_TRUE(sorted, "check float and double order");
+}
+
+static void testSortStrings(struct Arena *arena) {
+    ARRAY(String) strings = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(strings, arena, status);
+    char *words[] = {"pear",          "apple", "applesauce-long-name",
+                     "applesauce-lo", "",      "apple",
+                     "banana"};
+    for (int i = 0; i < 7; i++) {
+        String word =
+            getStringFromChar(words[i], strlen(words[i]), arena).string;
+        PUSH_ARRAY(strings, word, status);
+    }
+    SORT_ARRAY(strings, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(strings.items[0].size == 0, "check the empty string is first");
+    ASSERT_TRUE(strings.items[1].items == words[1] &&
+                    strings.items[2].items == words[5],
+                "check equal strings keep their order");
+    ASSERT_TRUE(!memcmp(strings.items[3].items, "applesauce-lo", 13) &&
+                    strings.items[3].size == 13,
+                "check shared prefixes");
+    ASSERT_TRUE(strings.items[4].size == 20, "check longer string is after");
+    ASSERT_TRUE(!memcmp(strings.items[6].items, "pear", 4), "check last");
+}
+
+static void testSortRecords(struct Arena *arena) {
+    ARRAY(struct Record) records = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(records, arena, status);
+    uint32_t state = 3;
+    for (int i = 0; i < 2000; i++) {
+        struct Record record = {(int)(nextRandom(&state) % 50), i};
+        PUSH_ARRAY(records, record, status);
+    }
+    ARRAY(struct Record) copy = NEW_ARRAY();
+    INIT_ARRAY(copy, arena, status);
+    COPY(records, copy, status);
+
+    SORT_ARRAY_BY(records, sortRecords);
+    int sorted = 1;
+    for (size_t i = 1; i < records.size; i++) {
+        sorted &= records.items[i - 1].key <= records.items[i].key;
+    }
+    ASSERT_TRUE(sorted, "check introsort order");
+
+    SORT_ARRAY_STABLE_BY(copy, sortRecords, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int stable = 1;
+    for (size_t i = 1; i < copy.size; i++) {
+        struct Record *previous = &copy.items[i - 1];
+        struct Record *current = &copy.items[i];
+        stable &= previous->key < current->key ||
+                  (previous->key == current->key &&
+                   previous->order < current->order);
+    }
+    ASSERT_TRUE(stable, "check stable order");
+}
+
+int runSortTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testSortIntegers);
+    ADD_TEST(testSortFloats);
+    ADD_TEST(testSortStrings);
+    ADD_TEST(testSortRecords);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_SORT_H
+#define TEST_SORT_H
+
+#include "../sort.h"
+#include "unittest.h"
+
+int runSortTests(void);
+
+#endif
@@ -0,0 +1,156 @@
+#include "test_spscbuffer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define TRANSFER_COUNT 200000
+
+typedef SPSC_BUFFER(uint64_t) SpscQueue;
+
+struct Transfer {
+    SpscQueue queue;
+    int overwrite;
+};
+
+// push 1..TRANSFER_COUNT and then a 0 to say that it is done
+static void *producer(void *context) {
+    struct Transfer *transfer = context;
+    int status = 0;
+    for (uint64_t i = 1; i <= TRANSFER_COUNT; i++) {
+        if (transfer->overwrite) {
+            PUSH_OVERWRITE_SPSC_BUFFER(transfer->queue, i, status);
+            continue;
+        }
+        TRY_PUSH_SPSC_BUFFER(transfer->queue, i, status);
+        while (status == BUFFERFULL) {
+            sched_yield();
+            TRY_PUSH_SPSC_BUFFER(transfer->queue, i, status);
+        }
+    }
+    // the end marker can't be dropped so wait for room
+    TRY_PUSH_SPSC_BUFFER(transfer->queue, 0, status);
+    while (status == BUFFERFULL) {
+        sched_yield();
+        TRY_PUSH_SPSC_BUFFER(transfer->queue, 0, status);
+    }
+    return NULL;
+}
+
+static void testSingleThread(struct Arena *arena) {
+    SpscQueue queue;
+    int status = 0;
+    INIT_SPSC_BUFFER(queue, arena, 3, 0, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(SPSC_BUFFER_CAPACITY(queue) == 4, "check round up");
+
+    uint64_t item = 0;
+    TRY_POP_SPSC_BUFFER(queue, item, status);
+    ASSERT_TRUE(status == BUFFEREMPTY, "check empty pop");
+    for (uint64_t i = 0; i < 4; i++) {
+        TRY_PUSH_SPSC_BUFFER(queue, i, status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    TRY_PUSH_SPSC_BUFFER(queue, 99, status);
+    ASSERT_TRUE(status == BUFFERFULL, "check full push");
+    ASSERT_TRUE(SPSC_BUFFER_SIZE(queue) == 4, "check size");
+    PUSH_OVERWRITE_SPSC_BUFFER(queue, 99, status);
+    ASSERT_TRUE(status == INVALIDARGS, "check overwrite needs the flag");
+
+    TRY_POP_SPSC_BUFFER(queue, item, status);
+    ASSERT_TRUE(status == OK && item == 0, "check pop order");
+    TRY_PUSH_SPSC_BUFFER(queue, 4, status);
+    ASSERT_TRUE(status == OK, "check push after pop");
+    int ordered = 1;
+    for (uint64_t i = 1; i <= 4; i++) {
+        TRY_POP_SPSC_BUFFER(queue, item, status);
+        ordered &= status == OK && item == i;
+    }
+    ASSERT_TRUE(ordered, "check wrapped items");
+
+    SpscQueue ring;
+    INIT_SPSC_BUFFER(ring, arena, 4, 1, status);
+    for (uint64_t i = 0; i < 10; i++) {
+        PUSH_OVERWRITE_SPSC_BUFFER(ring, i, status);
+    }
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(SPSC_BUFFER_SIZE(ring) == 4, "check overwrite keeps size");
+    TRY_POP_SPSC_BUFFER(ring, item, status);
+    ASSERT_TRUE(status == OK && item == 6, "check oldest was dropped");
+}
+
+static void testTwoThreads(struct Arena *arena) {
+    struct Transfer *transfer = mallocArena(&arena, sizeof(struct Transfer));
+    int status = 0;
+    INIT_SPSC_BUFFER(transfer->queue, arena, 64, 0, status);
+    transfer->overwrite = 0;
+    ASSERT_TRUE(status == OK, "status check");
+
+    pthread_t thread;
+    ASSERT_TRUE(pthread_create(&thread, NULL, producer, transfer) == 0,
+                "check thread start");
+    uint64_t expected = 1;
+    int ordered = 1;
+    for (;;) {
+        uint64_t item = 0;
+        TRY_POP_SPSC_BUFFER(transfer->queue, item, status);
+        if (status == BUFFEREMPTY) {
+            // let the producer run if there is only one core
+            sched_yield();
+            continue;
+        }
+        if (item == 0) {
+            break;
+        }
+        ordered &= item == expected;
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    ASSERT_TRUE(ordered, "check every item arrived in order");
+    ASSERT_TRUE(expected == TRANSFER_COUNT + 1, "check item count");
+}
+
+static void testTwoThreadsOverwrite(struct Arena *arena) {
+    struct Transfer *transfer = mallocArena(&arena, sizeof(struct Transfer));
+    int status = 0;
+    INIT_SPSC_BUFFER(transfer->queue, arena, 16, 1, status);
+    transfer->overwrite = 1;
+    ASSERT_TRUE(status == OK, "status check");
+
+    pthread_t thread;
+    ASSERT_TRUE(pthread_create(&thread, NULL, producer, transfer) == 0,
+                "check thread start");
+    // items can be dropped but the ones that arrive have to be in order
+    uint64_t previous = 0;
+    int ordered = 1;
+    for (;;) {
+        uint64_t item = 0;
+        TRY_POP_SPSC_BUFFER(transfer->queue, item, status);
+        if (status == BUFFEREMPTY) {
+            // let the producer run if there is only one core
+            sched_yield();
+            continue;
+        }
+        if (item == 0) {
+            break;
+        }
+        ordered &= item > previous && item <= TRANSFER_COUNT;
+        previous = item;
+    }
+    pthread_join(thread, NULL);
+    ASSERT_TRUE(ordered, "check surviving items are in order");
+    ASSERT_TRUE(previous == TRANSFER_COUNT, "check the last item arrived");
+}
+
+int runSpscBufferTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testSingleThread);
+    ADD_TEST(testTwoThreads);
+    ADD_TEST(testTwoThreadsOverwrite);
+    return runTest();
+}
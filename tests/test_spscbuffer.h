@@ -0,0 +1,9 @@
+#ifndef TEST_SPSCBUFFER_H
+#define TEST_SPSCBUFFER_H
+
+#include "../spscbuffer.h"
+#include "unittest.h"
+
+int runSpscBufferTests(void);
+
+#endif
@@ -66,6 +66,143 @@ static void testString(struct Arena *arena) {
                 "Check the original doesn't change");
 }
 
+static void testFindChar(struct Arena *arena) {
+    char text[] = "a fairly long line of text, with commas, to search, ok";
+    String string = getStringFromChar(text, sizeof(text) - 1, arena).string;
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        ASSERT_TRUE(findChar(&string, ',') == 26, "check find");
+        ASSERT_TRUE(findChar(&string, 'k') == 53, "check find in the tail");
+        ASSERT_TRUE(findChar(&string, 'z') == ARRAY_NOT_FOUND,
+                    "check find of a missing character");
+        ASSERT_TRUE(countChar(&string, ',') == 3, "check count");
+    }
+    setSimdLevel(maxLevel);
+}
+
+static String view(const char *text, struct Arena *arena) {
+    return getStringFromChar((char *)text, strlen(text), arena).string;
+}
+
+static void testFindString(struct Arena *arena) {
+    // long enough that the vector loops run and the match is past them
+    char text[] = "the quick brown fox jumps over the lazy dog, the quick "
+                  "brown fox jumps again and then the dog wakes up";
+    String string = getStringFromChar(text, sizeof(text) - 1, arena).string;
+    char buffer[300];
+    memset(buffer, 'a', sizeof(buffer));
+    memcpy(buffer + 290, "ab", 2);
+    String repeats = getStringFromChar(buffer, sizeof(buffer), arena).string;
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        String needle = view("fox", arena);
+        ASSERT_TRUE(findString(&string, &needle) == 16, "check find");
+        needle = view("wakes up", arena);
+        ASSERT_TRUE(findString(&string, &needle) == 94,
+                    "check find at the end");
+        needle = view("dog wakes", arena);
+        ASSERT_TRUE(findString(&string, &needle) == 90,
+                    "check a match past an early first and last byte match");
+        needle = view("dogs", arena);
+        ASSERT_TRUE(findString(&string, &needle) == ARRAY_NOT_FOUND,
+                    "check a missing needle");
+        needle = view("", arena);
+        ASSERT_TRUE(findString(&string, &needle) == 0, "check empty needle");
+        needle = view("aab", arena);
+        ASSERT_TRUE(findString(&repeats, &needle) == 289,
+                    "check a needle in a run of its first byte");
+        ASSERT_TRUE(findAnyByte(text, sizeof(text) - 1, ",y", 2) == 38,
+                    "check find any byte");
+        ASSERT_TRUE(findAnyByte(buffer, sizeof(buffer), "xyzb", 4) == 291,
+                    "check find any byte in the tail");
+        ASSERT_TRUE(findAnyByte(text, sizeof(text) - 1, "0123456789XYZ!?@#",
+                                17) == SIMD_NOT_FOUND,
+                    "check a large set with no match");
+    }
+    setSimdLevel(maxLevel);
+}
+
+static void testStringViews(struct Arena *arena) {
+    String string = view("  \thello, world \n", arena);
+    String trimmed = trimString(&string);
+    String expected = view("hello, world", arena);
+    ASSERT_TRUE(stringsEqual(&trimmed, &expected), "check trim");
+    ASSERT_TRUE(trimmed.items == string.items + 3, "check trim doesn't copy");
+    String left = trimLeft(&string);
+    ASSERT_TRUE(left.size == string.size - 3, "check trim left");
+    String right = trimRight(&string);
+    ASSERT_TRUE(right.size == string.size - 2, "check trim right");
+    String blank = view(" \t ", arena);
+    ASSERT_TRUE(trimString(&blank).size == 0, "check trim of only spaces");
+
+    String prefix = view("hello", arena);
+    String suffix = view("world", arena);
+    ASSERT_TRUE(startsWith(&trimmed, &prefix), "check starts with");
+    ASSERT_FALSE(startsWith(&prefix, &trimmed), "check a longer prefix");
+    ASSERT_TRUE(endsWith(&trimmed, &suffix), "check ends with");
+    ASSERT_FALSE(endsWith(&trimmed, &prefix), "check wrong suffix");
+
+    String slice = sliceString(&trimmed, 7, 100);
+    ASSERT_TRUE(stringsEqual(&slice, &suffix), "check slice is clamped");
+    ASSERT_TRUE(sliceString(&trimmed, 50, 2).size == 0,
+                "check slice past the end");
+
+    String apple = view("apple", arena);
+    String apples = view("apples", arena);
+    String banana = view("banana", arena);
+    ASSERT_TRUE(compareStrings(&apple, &banana) < 0, "check compare");
+    ASSERT_TRUE(compareStrings(&banana, &apple) > 0, "check compare");
+    ASSERT_TRUE(compareStrings(&apple, &apples) < 0, "check prefix first");
+    ASSERT_TRUE(compareStrings(&apple, &apple) == 0, "check compare equal");
+    ASSERT_FALSE(stringsEqual(&apple, &apples), "check not equal");
+}
+
+static void testSplitString(struct Arena *arena) {
+    String line = view("id,name,,score", arena);
+    StringArray fields = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(fields, arena, status);
+    status = splitString(&line, ',', &fields);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(fields.size == 4, "check the empty field is kept");
+    String name = view("name", arena);
+    String score = view("score", arena);
+    ASSERT_TRUE(stringsEqual(&fields.items[1], &name) &&
+                    fields.items[2].size == 0 &&
+                    stringsEqual(&fields.items[3], &score),
+                "check the fields");
+    ASSERT_TRUE(fields.items[3].items == line.items + 9,
+                "check fields point into the line");
+
+    String empty = view("", arena);
+    CLEAR_ARRAY(fields, status);
+    splitString(&empty, ',', &fields);
+    ASSERT_TRUE(fields.size == 1 && fields.items[0].size == 0,
+                "check an empty string is one empty field");
+
+    String words = view("  split these\twords\n\nup ", arena);
+    struct StringSplitter splitter;
+    initStringSplitter(&splitter, &words, " \t\n", 3);
+    String token;
+    size_t count = 0;
+    size_t total = 0;
+    while (nextToken(&splitter, &token)) {
+        count++;
+        total += token.size;
+    }
+    ASSERT_TRUE(count == 4 && total == 17, "check tokens skip empty fields");
+
+    CLEAR_ARRAY(fields, status);
+    status = splitStringAny(&words, " \t\n", 3, &fields);
+    ASSERT_TRUE(status == OK && fields.size == 8,
+                "check split on a set keeps empty fields");
+    StringArray uninitialized = NEW_ARRAY();
+    ASSERT_TRUE(splitString(&line, ',', &uninitialized) == UNINITARRAY,
+                "check uninitialized array");
+}
+
 int runStringTests(void) {
     struct Arena *memory = createArena();
     int status = 0;
@@ -76,6 +213,10 @@ int runStringTests(void) {
     }
     ADD_TEST(testStringChar);
     ADD_TEST(testString);
+    ADD_TEST(testFindChar);
+    ADD_TEST(testFindString);
+    ADD_TEST(testStringViews);
+    ADD_TEST(testSplitString);
     runTest();
     return 0;
 }
@@ -0,0 +1,152 @@
+#include "test_stringbuilder.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static int stringEquals(const String *string, const char *expected) {
+    return string->size == strlen(expected) &&
+           memcmp(string->items, expected, string->size) == 0;
+}
+
+static void testAppend(struct Arena *arena) {
+    struct StringBuilder builder;
+    int status = initStringBuilder(&builder, arena, 0);
+    ASSERT_TRUE(status == OK, "status check");
+    appendCString(&builder, "frame ");
+    appendUint(&builder, 42);
+    appendChar(&builder, ':');
+    appendChar(&builder, ' ');
+    String unit = getStringFromChar("ms", 2, arena).string;
+    appendDouble(&builder, 16.6667, 2);
+    appendString(&builder, &unit);
+    appendChars(&builder, " xyz", 2);
+    ASSERT_TRUE(builder.status == OK, "status check");
+    ASSERT_TRUE(stringEquals(&builder.string, "frame 42: 16.67ms x"),
+                "check appended text");
+
+    struct StringReturn result = finishStringBuilder(&builder);
+    ASSERT_TRUE(result.status == OK, "status check");
+    ASSERT_TRUE(strcmp(result.string.items, "frame 42: 16.67ms x") == 0,
+                "check the result is null terminated");
+    ASSERT_TRUE(builder.string.size == 0 && builder.string.items == NULL,
+                "check the builder is empty after finishing");
+    appendCString(&builder, "again");
+    result = finishStringBuilder(&builder);
+    ASSERT_TRUE(stringEquals(&result.string, "again"), "check reuse");
+
+    result = finishStringBuilder(&builder);
+    ASSERT_TRUE(result.status == OK && result.string.size == 0 &&
+                    result.string.items[0] == '\0',
+                "check finishing an empty builder");
+    ASSERT_TRUE(appendCString(NULL, "x") == NULLPOINTER,
+                "Check safe null returns");
+}
+
+static void testIntegers(struct Arena *arena) {
+    struct StringBuilder builder;
+    initStringBuilder(&builder, arena, 0);
+    appendInt(&builder, 0);
+    appendChar(&builder, ' ');
+    appendInt(&builder, -7);
+    appendChar(&builder, ' ');
+    appendInt(&builder, INT64_MIN);
+    appendChar(&builder, ' ');
+    appendInt(&builder, INT64_MAX);
+    appendChar(&builder, ' ');
+    appendUint(&builder, UINT64_MAX);
+    ASSERT_TRUE(stringEquals(&builder.string,
+                             "0 -7 -9223372036854775808 9223372036854775807 "
+                             "18446744073709551615"),
+                "check integer formatting");
+
+    struct StringBuilder doubles;
+    initStringBuilder(&doubles, arena, 0);
+    appendShortestDouble(&doubles, 0.1);
+    appendChar(&doubles, ' ');
+    appendShortestDouble(&doubles, -2.5e-10);
+    ASSERT_TRUE(stringEquals(&doubles.string, "0.1 -2.5e-10"),
+                "check shortest double formatting");
+}
+
+static void testFormat(struct Arena *arena) {
+    struct StringBuilder builder;
+    initStringBuilder(&builder, arena, 0);
+    appendFormat(&builder, "%s=%d", "count", 12);
+    ASSERT_TRUE(stringEquals(&builder.string, "count=12"), "check format");
+    // longer than what is left so it has to grow and format again
+    char expected[400];
+    memset(expected, 'z', 300);
+    expected[300] = '\0';
+    appendFormat(&builder, "[%s]", expected);
+    ASSERT_TRUE(builder.string.size == 8 + 302, "check grown format size");
+    ASSERT_TRUE(builder.string.items[9] == 'z' &&
+                    builder.string.items[309] == ']',
+                "check grown format text");
+    appendFormat(&builder, "%s", "");
+    ASSERT_TRUE(builder.string.size == 310, "check empty format");
+
+    // a log of lines should match snprintf
+    struct StringBuilder lines;
+    initStringBuilder(&lines, arena, 0);
+    int matches = 1;
+    for (int i = 0; i < 2000 && matches; i++) {
+        char line[128];
+        int length =
+            snprintf(line, sizeof(line), "[%05d] level=%s value=%.3f\n", i,
+                     i % 3 ? "info" : "warn", i * 0.125);
+        size_t before = lines.string.size;
+        appendFormat(&lines, "[%05d] level=%s value=%.3f\n", i,
+                     i % 3 ? "info" : "warn", i * 0.125);
+        matches &= lines.string.size - before == (size_t)length &&
+                   memcmp(lines.string.items + before, line, length) == 0;
+    }
+    ASSERT_TRUE(matches && lines.status == OK, "check log lines");
+}
+
+static void testGrowInPlace(struct Arena *arena) {
+    (void)arena;
+    // a fresh arena so the builder is the last allocation
+    struct Arena *local = createArena();
+    struct StringBuilder builder;
+    initStringBuilder(&builder, local, 16);
+    char *start = builder.string.items;
+    for (int i = 0; i < 20; i++) {
+        appendCString(&builder, "0123456789");
+    }
+    ASSERT_TRUE(builder.string.items == start, "check growth was in place");
+    ASSERT_TRUE(builder.string.size == 200, "check size");
+    struct StringReturn result = finishStringBuilder(&builder);
+    ASSERT_TRUE(result.string.items == start, "check finish didn't copy");
+    // the spare capacity went back so the next allocation follows the string
+    char *next = mallocArena(&local, 1);
+    ASSERT_TRUE(next == start + 201, "check spare capacity was returned");
+
+    // something else in the way means it has to move
+    initStringBuilder(&builder, local, 16);
+    start = builder.string.items;
+    mallocArena(&local, 8);
+    // the first block is at least STRING_BUILDER_MIN_CAPACITY so go past it
+    for (int i = 0; i < 10; i++) {
+        appendCString(&builder, "0123456789");
+    }
+    ASSERT_TRUE(builder.string.items != start, "check growth that has to copy");
+    ASSERT_TRUE(builder.string.size == 100 &&
+                    memcmp(builder.string.items + 90, "0123456789", 10) == 0,
+                "check copied text");
+    burnItDown(&local);
+}
+
+int runStringBuilderTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testAppend);
+    ADD_TEST(testIntegers);
+    ADD_TEST(testFormat);
+    ADD_TEST(testGrowInPlace);
+    return runTest();
+}
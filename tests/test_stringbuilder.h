@@ -0,0 +1,9 @@
+#ifndef TEST_STRINGBUILDER_H
+#define TEST_STRINGBUILDER_H
+
+#include "../stringbuilder.h"
+#include "unittest.h"
+
+int runStringBuilderTests(void);
+
+#endif
@@ -0,0 +1,179 @@
+#include "test_threadpool.h"
+#include <stdio.h>
+
+// Worker setup only fails when memory runs out, so the tests build their own
+// copy of the pool where createArena fails on the call they pick. The public
+// functions of the copy are renamed so they don't clash with the real ones.
+static int arenasBeforeFailure = -1;
+
+static struct Arena *failingCreateArena(void) {
+    if (arenasBeforeFailure == 0) {
+        return NULL;
+    }
+    if (arenasBeforeFailure > 0) {
+        arenasBeforeFailure--;
+    }
+    return createArena();
+}
+
+#define createArena failingCreateArena
+#define createThreadPool failingCreateThreadPool
+#define destroyThreadPool failingDestroyThreadPool
+#define threadPoolSize failingThreadPoolSize
+#define parallelFor failingParallelFor
+#define parallelMap failingParallelMap
+#define parallelReduce failingParallelReduce
+// so the prototypes are seen again under the new names
+#undef THREADPOOL_H
+#include "../threadpool.c"
+#undef createArena
+#undef createThreadPool
+#undef destroyThreadPool
+#undef threadPoolSize
+#undef parallelFor
+#undef parallelMap
+#undef parallelReduce
+
+static void squareRange(void *items, size_t start, size_t end,
+                        struct Arena **scratch, void *context) {
+    (void)context;
+    int64_t *values = items;
+    // use the scratch arena to make sure it is usable from every worker
+    int64_t *copy = mallocArena(scratch, (end - start) * sizeof(int64_t));
+    for (size_t i = start; i < end; i++) {
+        copy[i - start] = values[i] * values[i];
+    }
+    memcpy(values + start, copy, (end - start) * sizeof(int64_t));
+}
+
+static void halfRange(const void *source, void *destination, size_t start,
+                      size_t end, struct Arena **scratch, void *context) {
+    (void)scratch;
+    (void)context;
+    const int64_t *input = source;
+    double *output = destination;
+    for (size_t i = start; i < end; i++) {
+        output[i] = (double)input[i] / 2.0;
+    }
+}
+
+static void sumRange(const void *items, size_t start, size_t end,
+                     void *result, struct Arena **scratch, void *context) {
+    (void)scratch;
+    (void)context;
+    const int64_t *values = items;
+    int64_t *sum = result;
+    for (size_t i = start; i < end; i++) {
+        *sum += values[i];
+    }
+}
+
+static void combineSum(void *result, const void *partial, void *context) {
+    (void)context;
+    *(int64_t *)result += *(const int64_t *)partial;
+}
+
+static void testParallelFor(struct Arena *arena) {
+    struct ThreadPool *pool = createThreadPool(&arena, 4);
+    ASSERT_TRUE(pool != NULL, "check the pool was created");
+    if (pool == NULL) {
+        return;
+    }
+    ASSERT_TRUE(threadPoolSize(pool) == 4, "check pool size");
+    ARRAY(int64_t) values = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(values, arena, status);
+    for (int64_t i = 0; i < 10000; i++) {
+        PUSH_ARRAY(values, i, status);
+    }
+    PARALLEL_FOR(pool, values, 64, squareRange, NULL, status);
+    ASSERT_TRUE(status == OK, "status check");
+    int correct = 1;
+    for (int64_t i = 0; i < 10000; i++) {
+        correct &= values.items[i] == i * i;
+    }
+    ASSERT_TRUE(correct, "check every item was visited once");
+
+    // run a second job on the same pool with the default grain
+    PARALLEL_FOR(pool, values, 0, squareRange, NULL, status);
+    ASSERT_TRUE(values.items[3] == 81, "check the pool can be reused");
+    destroyThreadPool(&pool);
+    ASSERT_TRUE(pool == NULL, "check cleanup");
+}
+
+static void testParallelMapReduce(struct Arena *arena) {
+    struct ThreadPool *pool = createThreadPool(&arena, 3);
+    if (pool == NULL) {
+        ASSERT_TRUE(0, "check the pool was created");
+        return;
+    }
+    ARRAY(int64_t) values = NEW_ARRAY();
+    ARRAY(double) halves = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(values, arena, status);
+    INIT_ARRAY(halves, arena, status);
+    for (int64_t i = 0; i < 5001; i++) {
+        PUSH_ARRAY(values, i, status);
+    }
+    PARALLEL_MAP(pool, values, halves, 100, halfRange, NULL, status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(halves.size == 5001, "check map resized the destination");
+    ASSERT_TRUE(halves.items[5000] == 2500.0 && halves.items[7] == 3.5,
+                "check mapped values");
+
+    int64_t sum = 0;
+    PARALLEL_REDUCE(pool, values, 100, sumRange, combineSum, sum, NULL,
+                    status);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(sum == (int64_t)5000 * 5001 / 2, "check reduced sum");
+    destroyThreadPool(&pool);
+}
+
+static void testSingleThreadPool(struct Arena *arena) {
+    struct ThreadPool *pool = createThreadPool(&arena, 1);
+    if (pool == NULL) {
+        ASSERT_TRUE(0, "check the pool was created");
+        return;
+    }
+    int64_t values[5] = {1, 2, 3, 4, 5};
+    int status = parallelFor(pool, values, 5, 2, squareRange, NULL);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(values[4] == 25, "check the caller runs the work inline");
+    status = parallelFor(pool, NULL, 5, 2, squareRange, NULL);
+    ASSERT_TRUE(status == NULLPOINTER, "check null items are rejected");
+    destroyThreadPool(&pool);
+}
+
+// a worker that fails to set up has to be cleaned up without joining a
+// thread that was never started
+static void testFailedSetup(struct Arena *arena) {
+    int created = 0;
+    // each worker makes one scratch arena, so this fails each worker in turn
+    for (int failed = 0; failed < 4; failed++) {
+        arenasBeforeFailure = failed;
+        struct ThreadPool *pool = failingCreateThreadPool(&arena, 4);
+        created |= pool != NULL;
+        failingDestroyThreadPool(&pool);
+    }
+    arenasBeforeFailure = -1;
+    ASSERT_TRUE(!created, "check a failed worker fails the pool");
+    struct ThreadPool *pool = failingCreateThreadPool(&arena, 4);
+    ASSERT_TRUE(pool != NULL && failingThreadPoolSize(pool) == 4,
+                "check the pool works after a failed setup");
+    failingDestroyThreadPool(&pool);
+}
+
+int runThreadPoolTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testParallelFor);
+    ADD_TEST(testParallelMapReduce);
+    ADD_TEST(testSingleThreadPool);
+    ADD_TEST(testFailedSetup);
+    return runTest();
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_THREADPOOL_H
+#define TEST_THREADPOOL_H
+
+#include "../threadpool.h"
+#include "unittest.h"
+
+int runThreadPoolTests(void);
+
+#endif
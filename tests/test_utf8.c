@@ -0,0 +1,140 @@
+#include "test_utf8.h"
+#include <stdio.h>
+
+static int validAtEveryLevel(const char *bytes, size_t size) {
+    int maxLevel = getSimdLevel();
+    int valid = validUtf8(bytes, size);
+    for (int level = SIMD_SCALAR; level < maxLevel; level++) {
+        setSimdLevel(level);
+        if (validUtf8(bytes, size) != valid) {
+            valid = -1;
+        }
+    }
+    setSimdLevel(maxLevel);
+    return valid;
+}
+
+// check a sequence by itself and at every offset around a vector boundary
+static int checkSequence(const char *sequence, size_t size) {
+    char padded[80];
+    int valid = validAtEveryLevel(sequence, size);
+    for (size_t offset = 0; offset + size <= sizeof(padded); offset++) {
+        memset(padded, 'x', sizeof(padded));
+        memcpy(padded + offset, sequence, size);
+        if (validAtEveryLevel(padded, sizeof(padded)) != valid ||
+            validAtEveryLevel(padded, offset + size) != valid) {
+            return -1;
+        }
+    }
+    return valid;
+}
+
+static void testValidate(struct Arena *arena) {
+    (void)arena;
+    ASSERT_TRUE(checkSequence("", 0) == 1, "check empty");
+    ASSERT_TRUE(checkSequence("plain", 5) == 1, "check ascii");
+    ASSERT_TRUE(checkSequence("\xc3\xa9", 2) == 1, "check two bytes");
+    ASSERT_TRUE(checkSequence("\xe2\x82\xac", 3) == 1, "check three bytes");
+    ASSERT_TRUE(checkSequence("\xf0\x9f\x98\x80", 4) == 1, "check four bytes");
+    ASSERT_TRUE(checkSequence("\xf4\x8f\xbf\xbf", 4) == 1, "check U+10FFFF");
+    ASSERT_TRUE(checkSequence("\xed\x9f\xbf", 3) == 1,
+                "check just below the surrogates");
+
+    ASSERT_TRUE(checkSequence("\x80", 1) == 0, "check lone continuation");
+    ASSERT_TRUE(checkSequence("\xc3", 1) == 0, "check truncated");
+    ASSERT_TRUE(checkSequence("\xe2\x82", 2) == 0, "check truncated three");
+    ASSERT_TRUE(checkSequence("\xf0\x9f\x98", 3) == 0, "check truncated four");
+    ASSERT_TRUE(checkSequence("\xc3\xa9\xa9", 3) == 0,
+                "check extra continuation");
+    ASSERT_TRUE(checkSequence("\xc0\xaf", 2) == 0, "check overlong two");
+    ASSERT_TRUE(checkSequence("\xe0\x80\xaf", 3) == 0, "check overlong three");
+    ASSERT_TRUE(checkSequence("\xf0\x80\x80\xaf", 4) == 0,
+                "check overlong four");
+    ASSERT_TRUE(checkSequence("\xed\xa0\x80", 3) == 0, "check surrogate");
+    ASSERT_TRUE(checkSequence("\xf4\x90\x80\x80", 4) == 0,
+                "check past U+10FFFF");
+    ASSERT_TRUE(checkSequence("\xf5\x80\x80\x80", 4) == 0, "check bad lead");
+    ASSERT_TRUE(checkSequence("\xff", 1) == 0, "check 0xff");
+    ASSERT_TRUE(checkSequence("\xe2\x82x", 3) == 0,
+                "check ascii inside a sequence");
+}
+
+// mix valid sequences and then flip random bytes. Every level has to agree
+// with the scalar one
+static void testRandomBytes(struct Arena *arena) {
+    const char *pieces[] = {"a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                            "\xed\x9f\xbf", " "};
+    size_t size = 4096;
+    char *bytes = mallocArena(&arena, size);
+    uint32_t random = 99;
+    int agree = 1;
+    size_t validCount = 0;
+    for (int round = 0; round < 200; round++) {
+        size_t used = 0;
+        for (;;) {
+            random = (random * 1103515245) + 12345;
+            const char *piece = pieces[(random >> 16) % 6];
+            size_t pieceSize = strlen(piece);
+            if (used + pieceSize > size) {
+                break;
+            }
+            memcpy(bytes + used, piece, pieceSize);
+            used += pieceSize;
+        }
+        // half the rounds stay valid
+        for (int flip = 0; flip < round % 2; flip++) {
+            random = (random * 1103515245) + 12345;
+            bytes[(random >> 8) % used] = (char)(random >> 24);
+        }
+        int result = validAtEveryLevel(bytes, used);
+        agree &= result != -1;
+        validCount += result == 1;
+    }
+    ASSERT_TRUE(agree, "check every level agrees");
+    ASSERT_TRUE(validCount >= 100, "check the valid rounds pass");
+}
+
+static void testDecode(struct Arena *arena) {
+    char text[] = "caf\xc3\xa9 costs \xe2\x82\xac"
+                  "5 \xf0\x9f\x98\x80 and that is a long enough tail";
+    String string = getStringFromChar(text, sizeof(text) - 1, arena).string;
+    ASSERT_TRUE(validateUtf8(&string), "check valid");
+    int maxLevel = getSimdLevel();
+    for (int level = SIMD_SCALAR; level <= maxLevel; level++) {
+        setSimdLevel(level);
+        ASSERT_TRUE(countCodepoints(&string) == 46, "check codepoint count");
+    }
+    setSimdLevel(maxLevel);
+
+    Utf32String codepoints = NEW_ARRAY();
+    int status = 0;
+    INIT_ARRAY(codepoints, arena, status);
+    status = decodeUtf8(&string, &codepoints);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(codepoints.size == 46, "check decoded count");
+    ASSERT_TRUE(codepoints.items[0] == 'c' && codepoints.items[3] == 0xE9 &&
+                    codepoints.items[11] == 0x20AC &&
+                    codepoints.items[14] == 0x1F600 &&
+                    codepoints.items[45] == 'l',
+                "check decoded codepoints");
+
+    String bad = getStringFromChar("ab\xc3", 3, arena).string;
+    ASSERT_TRUE(decodeUtf8(&bad, &codepoints) == INVALIDARGS,
+                "check invalid input is rejected");
+    ASSERT_TRUE(codepoints.size == 46, "check nothing was added");
+    ASSERT_TRUE(countCodepoints(&bad) == 3, "check leads are still counted");
+}
+
+int runUtf8Tests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testValidate);
+    ADD_TEST(testRandomBytes);
+    ADD_TEST(testDecode);
+    return runTest();
+}
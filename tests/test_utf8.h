@@ -0,0 +1,10 @@
+#ifndef TEST_UTF8_H
+#define TEST_UTF8_H
+
+#include "../simd.h"
+#include "../utf8.h"
+#include "unittest.h"
+
+int runUtf8Tests(void);
+
+#endif
@@ -0,0 +1,120 @@
+#include "test_windowstats.h"
+#include <math.h>
+#include <stdio.h>
+
+static int closeTo(double first, double second, double tolerance) {
+    return fabs(first - second) <= tolerance;
+}
+
+static void testSmallWindow(struct Arena *arena) {
+    struct WindowStats stats;
+    int status = initWindowStats(&stats, arena, 4, 0, 100, 100);
+    ASSERT_TRUE(status == OK, "status check");
+    ASSERT_TRUE(windowCount(&stats) == 0 && windowMean(&stats) == 0,
+                "check empty window");
+    ASSERT_TRUE(initWindowStats(&stats, arena, 1, 0, 1, 1) == INVALIDARGS,
+                "check window too small");
+    ASSERT_TRUE(initWindowStats(&stats, arena, 4, 1, 1, 1) == INVALIDARGS,
+                "check empty range");
+    initWindowStats(&stats, arena, 4, 0, 100, 100);
+
+    pushWindowSample(&stats, 10);
+    pushWindowSample(&stats, 30);
+    pushWindowSample(&stats, 20);
+    ASSERT_TRUE(windowCount(&stats) == 3, "check count");
+    ASSERT_TRUE(closeTo(windowMean(&stats), 20, 1e-9), "check mean");
+    ASSERT_TRUE(closeTo(windowVariance(&stats), 200.0 / 3.0, 1e-9),
+                "check variance");
+    ASSERT_TRUE(windowMin(&stats) == 10 && windowMax(&stats) == 30,
+                "check min and max");
+    pushWindowSample(&stats, 40);
+    // 10 falls out of the window
+    pushWindowSample(&stats, 25);
+    ASSERT_TRUE(windowCount(&stats) == 4, "check count is capped");
+    ASSERT_TRUE(closeTo(windowMean(&stats), 28.75, 1e-9), "check mean");
+    ASSERT_TRUE(windowMin(&stats) == 20 && windowMax(&stats) == 40,
+                "check min and max after eviction");
+    pushWindowSample(&stats, 50);
+    pushWindowSample(&stats, 60);
+    ASSERT_TRUE(windowMin(&stats) == 25, "check min moves with the window");
+    ASSERT_TRUE(windowPercentile(&stats, 0) == 25 &&
+                    windowPercentile(&stats, 100) == 60,
+                "check the percentile ends");
+    ASSERT_TRUE(closeTo(windowPercentile(&stats, 50), 40, 1),
+                "check the median");
+
+    clearWindowStats(&stats);
+    ASSERT_TRUE(windowCount(&stats) == 0 && windowMax(&stats) == 0,
+                "check clear");
+    pushWindowSample(&stats, 5);
+    ASSERT_TRUE(windowMin(&stats) == 5 && windowMean(&stats) == 5,
+                "check push after clear");
+}
+
+// compare against scanning a copy of the window for a long random run
+static void testAgainstScan(struct Arena *arena) {
+    const size_t windowSize = 1000;
+    const size_t total = 20000;
+    struct WindowStats stats;
+    int status = initWindowStats(&stats, arena, windowSize, 0, 50, 500);
+    ASSERT_TRUE(status == OK, "status check");
+    double *values = mallocArena(&arena, total * sizeof(double));
+    uint32_t random = 777;
+    for (size_t i = 0; i < total; i++) {
+        random = (random * 1103515245) + 12345;
+        // frame times from about 8 to 40 with a slow drift
+        double drift = (double)(i % 5000) / 1000.0;
+        values[i] = 8 + (((random >> 16) % 1000) / 40.0) + drift;
+    }
+    int matches = 1;
+    for (size_t i = 0; i < total; i++) {
+        pushWindowSample(&stats, values[i]);
+        if (i % 997 != 0 && i != total - 1) {
+            continue;
+        }
+        size_t start = i + 1 > windowSize ? i + 1 - windowSize : 0;
+        double sum = 0;
+        double minimum = values[start];
+        double maximum = values[start];
+        size_t below = 0;
+        for (size_t j = start; j <= i; j++) {
+            sum += values[j];
+            minimum = values[j] < minimum ? values[j] : minimum;
+            maximum = values[j] > maximum ? values[j] : maximum;
+        }
+        size_t count = i + 1 - start;
+        double mean = sum / (double)count;
+        double squares = 0;
+        for (size_t j = start; j <= i; j++) {
+            squares += (values[j] - mean) * (values[j] - mean);
+        }
+        matches &= windowCount(&stats) == count;
+        matches &= closeTo(windowMean(&stats), mean, 1e-9);
+        matches &= closeTo(windowVariance(&stats), squares / (double)count,
+                           1e-6);
+        matches &= windowMin(&stats) == minimum;
+        matches &= windowMax(&stats) == maximum;
+        // the 90th percentile should split the window within a bucket once
+        // there are enough samples for that to mean anything
+        double p90 = windowPercentile(&stats, 90);
+        for (size_t j = start; j <= i; j++) {
+            below += values[j] <= p90;
+        }
+        matches &= count < 100 ||
+                   closeTo((double)below / (double)count, 0.9, 0.02);
+    }
+    ASSERT_TRUE(matches, "check the window matches a scan");
+}
+
+int runWindowStatsTests(void) {
+    struct Arena *memory = createArena();
+    int status = 0;
+    status = setUp(memory);
+    if (status != 0) {
+        printf("Failed to setup the test\n");
+        return status;
+    }
+    ADD_TEST(testSmallWindow);
+    ADD_TEST(testAgainstScan);
+    return runTest();
+}
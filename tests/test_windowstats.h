@@ -0,0 +1,9 @@
+#ifndef TEST_WINDOWSTATS_H
+#define TEST_WINDOWSTATS_H
+
+#include "../windowstats.h"
+#include "unittest.h"
+
+int runWindowStatsTests(void);
+
+#endif
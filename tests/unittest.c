@@ -1,8 +1,28 @@
 #include "unittest.h"
 #include "test_arena.h"
 #include "test_array.h"
+#include "test_asyncreader.h"
+#include "test_bitset.h"
+#include "test_blockingbuffer.h"
+#include "test_btree.h"
 #include "test_buffer.h"
+#include "test_deque.h"
+#include "test_file.h"
+#include "test_heap.h"
+#include "test_hash.h"
+#include "test_intern.h"
+#include "test_mirrorbuffer.h"
+#include "test_mpmcbuffer.h"
+#include "test_number.h"
+#include "test_rope.h"
+#include "test_slotmap.h"
+#include "test_sort.h"
+#include "test_spscbuffer.h"
 #include "test_string.h"
+#include "test_stringbuilder.h"
+#include "test_threadpool.h"
+#include "test_utf8.h"
+#include "test_windowstats.h"
 
 struct Arena *allocator = NULL;
 UnitestList testCollection = NEW_ARRAY();
@@ -75,5 +95,25 @@ int main(void) {
     status |= runArrayTests();
     status |= runStringTests();
     status |= runBufferTests();
+    status |= runInternTests();
+    status |= runSortTests();
+    status |= runThreadPoolTests();
+    status |= runHeapTests();
+    status |= runSlotMapTests();
+    status |= runBitsetTests();
+    status |= runBTreeTests();
+    status |= runSpscBufferTests();
+    status |= runMpmcBufferTests();
+    status |= runMirrorBufferTests();
+    status |= runDequeTests();
+    status |= runBlockingBufferTests();
+    status |= runWindowStatsTests();
+    status |= runStringBuilderTests();
+    status |= runHashTests();
+    status |= runUtf8Tests();
+    status |= runNumberTests();
+    status |= runFileTests();
+    status |= runRopeTests();
+    status |= runAsyncReaderTests();
     return status;
 }
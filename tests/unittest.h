@@ -4,6 +4,7 @@
 #include "../arena.h"
 #include "../array.h"
 #include "../debug.h"
+#include <stdint.h>
 #include <stdio.h>
 
 struct UnitTest {
@@ -57,6 +58,12 @@ extern int setupFailed;
             DEBUG_ERROR("`ADD_TEST` failed to add assertion");                 \
     } while (0)
 
+// small linear congruential generator so the tests are repeatable
+static inline uint32_t nextRandom(uint32_t *state) {
+    *state = (*state * 1664525U) + 1013904223U;
+    return *state;
+}
+
 int setUp(struct Arena *currentAllocator);
 int runTest(void);
 
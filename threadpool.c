@@ -0,0 +1,443 @@
+#include "threadpool.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+// each deque can hold this many chunks. The grain is raised if a job would
+// need more than that
+#define WORK_DEQUE_CAPACITY 4096
+#define WORK_EMPTY (-1)
+#define WORK_ABORT (-2)
+#define CACHE_LINE 64
+
+// Chase-Lev deque. The owner pushes and pops at the bottom and thieves take
+// from the top. Only chunk indexes are stored so nothing needs to be
+// allocated per task. The arena only aligns to max_align_t so the ends are
+// kept apart with padding instead of alignas.
+struct WorkDeque {
+    _Atomic int64_t top;
+    char topPadding[CACHE_LINE - sizeof(int64_t)];
+    _Atomic int64_t bottom;
+    _Atomic int64_t *slots;
+    int64_t mask;
+    char bottomPadding[CACHE_LINE - (3 * sizeof(int64_t))];
+};
+
+struct Worker {
+    struct WorkDeque deque;
+    struct Arena *scratch;
+    struct ThreadPool *pool;
+    pthread_t thread;
+    uint32_t index;
+};
+
+enum JobKind {
+    JOB_FOR = 0,
+    JOB_MAP = 1,
+    JOB_REDUCE = 2,
+};
+
+struct Job {
+    enum JobKind kind;
+    size_t count;
+    size_t grain;
+    const void *source;
+    void *destination;
+    ParallelForFunction forFunction;
+    ParallelMapFunction mapFunction;
+    ParallelReduceFunction reduceFunction;
+    // one result slot per chunk for reduce
+    char *partials;
+    size_t resultSize;
+    void *context;
+};
+
+struct ThreadPool {
+    ARRAY(struct Worker) workers;
+    struct Job job;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    uint64_t generation;
+    int shutdown;
+    char padding[CACHE_LINE];
+    _Atomic size_t pendingChunks;
+    char pendingPadding[CACHE_LINE - sizeof(size_t)];
+    _Atomic uint32_t activeWorkers;
+};
+
+static int pushWork(struct WorkDeque *deque, int64_t task) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top > deque->mask) {
+        return -1;
+    }
+    atomic_store_explicit(&deque->slots[bottom & deque->mask], task,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return 0;
+}
+
+static int64_t popWork(struct WorkDeque *deque) {
+    int64_t bottom =
+        atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return WORK_EMPTY;
+    }
+    int64_t task = atomic_load_explicit(&deque->slots[bottom & deque->mask],
+                                        memory_order_relaxed);
+    if (top == bottom) {
+        // last item so race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(
+                &deque->top, &top, top + 1, memory_order_seq_cst,
+                memory_order_relaxed)) {
+            task = WORK_EMPTY;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static int64_t stealWork(struct WorkDeque *deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return WORK_EMPTY;
+    }
+    int64_t task = atomic_load_explicit(&deque->slots[top & deque->mask],
+                                        memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return WORK_ABORT;
+    }
+    return task;
+}
+
+// go around the other workers until something is stolen or every deque is
+// seen empty
+static int64_t findWork(struct ThreadPool *pool, uint32_t thief) {
+    uint32_t workerCount = (uint32_t)pool->workers.size;
+    for (;;) {
+        int sawAbort = 0;
+        for (uint32_t i = 1; i < workerCount; i++) {
+            struct Worker *victim =
+                &pool->workers.items[(thief + i) % workerCount];
+            int64_t task = stealWork(&victim->deque);
+            if (task >= 0) {
+                return task;
+            }
+            sawAbort |= task == WORK_ABORT;
+        }
+        if (!sawAbort) {
+            return WORK_EMPTY;
+        }
+    }
+}
+
+static void runChunk(struct ThreadPool *pool, struct Worker *worker,
+                     int64_t chunk) {
+    struct Job *job = &pool->job;
+    size_t start = (size_t)chunk * job->grain;
+    size_t end = start + job->grain < job->count ? start + job->grain
+                                                 : job->count;
+    worker->scratch = getLastArenaNode(worker->scratch);
+    void *restorePoint = startScratchPad(worker->scratch);
+    switch (job->kind) {
+    case JOB_FOR:
+        job->forFunction(job->destination, start, end, &worker->scratch,
+                         job->context);
+        break;
+    case JOB_MAP:
+        job->mapFunction(job->source, job->destination, start, end,
+                         &worker->scratch, job->context);
+        break;
+    case JOB_REDUCE:
+        job->reduceFunction(job->source, start, end,
+                            job->partials + ((size_t)chunk * job->resultSize),
+                            &worker->scratch, job->context);
+        break;
+    }
+    restoreSratchPad(&worker->scratch, restorePoint);
+}
+
+static void runWorker(struct ThreadPool *pool, struct Worker *worker) {
+    for (;;) {
+        int64_t chunk = popWork(&worker->deque);
+        if (chunk == WORK_EMPTY) {
+            chunk = findWork(pool, worker->index);
+        }
+        if (chunk == WORK_EMPTY) {
+            return;
+        }
+        runChunk(pool, worker, chunk);
+        atomic_fetch_sub_explicit(&pool->pendingChunks, 1,
+                                  memory_order_acq_rel);
+    }
+}
+
+static void *workerMain(void *argument) {
+    struct Worker *worker = argument;
+    struct ThreadPool *pool = worker->pool;
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seenGeneration && !pool->shutdown) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seenGeneration = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        runWorker(pool, worker);
+        atomic_fetch_sub_explicit(&pool->activeWorkers, 1,
+                                  memory_order_release);
+    }
+}
+
+struct ThreadPool *createThreadPool(struct Arena **arena,
+                                    uint32_t threadCount) {
+    if (arena == NULL || *arena == NULL) {
+        DEBUG_ERROR("`createThreadPool` was called with a bad arena pointer");
+        return NULL;
+    }
+    if (threadCount == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = online > 0 ? (uint32_t)online : 1;
+    }
+    struct ThreadPool *pool = zmallocArena(arena, sizeof(struct ThreadPool));
+    if (pool == NULL) {
+        DEBUG_ERROR("`createThreadPool` was unable to allocate the pool");
+        return NULL;
+    }
+    int status = 0;
+    INIT_ARRAY(pool->workers, *arena, status);
+    REALLOC_ARRAY(pool->workers, threadCount, status);
+    if (status != OK) {
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    atomic_init(&pool->pendingChunks, 0);
+    atomic_init(&pool->activeWorkers, 0);
+
+    for (uint32_t i = 0; i < threadCount; i++) {
+        struct Worker *worker = &pool->workers.items[i];
+        memset(worker, 0, sizeof(struct Worker));
+        worker->pool = pool;
+        worker->index = i;
+        worker->deque.mask = WORK_DEQUE_CAPACITY - 1;
+        worker->deque.slots =
+            mallocArena(arena, WORK_DEQUE_CAPACITY * sizeof(_Atomic int64_t));
+        worker->scratch = createArena();
+        if (worker->deque.slots == NULL || worker->scratch == NULL) {
+            DEBUG_ERROR("`createThreadPool` was unable to set up a worker");
+            // this worker's thread was never started so it can't be joined
+            burnItDown(&worker->scratch);
+            pool->workers.size = i;
+            destroyThreadPool(&pool);
+            return NULL;
+        }
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        pool->workers.size = i + 1;
+        // worker 0 is the thread that calls into the pool
+        if (i != 0 &&
+            pthread_create(&worker->thread, NULL, workerMain, worker) != 0) {
+            DEBUG_ERROR("`createThreadPool` was unable to start a thread");
+            burnItDown(&worker->scratch);
+            pool->workers.size = i;
+            destroyThreadPool(&pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void destroyThreadPool(struct ThreadPool **pool) {
+    if (pool == NULL || *pool == NULL) {
+        return;
+    }
+    struct ThreadPool *localPool = *pool;
+    pthread_mutex_lock(&localPool->lock);
+    localPool->shutdown = 1;
+    pthread_cond_broadcast(&localPool->wake);
+    pthread_mutex_unlock(&localPool->lock);
+    for (size_t i = 0; i < localPool->workers.size; i++) {
+        struct Worker *worker = &localPool->workers.items[i];
+        if (i != 0) {
+            pthread_join(worker->thread, NULL);
+        }
+        burnItDown(&worker->scratch);
+    }
+    pthread_cond_destroy(&localPool->wake);
+    pthread_mutex_destroy(&localPool->lock);
+    FREE_ARRAY(localPool->workers);
+    *pool = NULL;
+}
+
+uint32_t threadPoolSize(const struct ThreadPool *pool) {
+    if (pool == NULL) {
+        return 0;
+    }
+    return (uint32_t)pool->workers.size;
+}
+
+static size_t chunkCountFor(const struct Job *job) {
+    return (job->count + job->grain - 1) / job->grain;
+}
+
+// pick the grain and split the chunks between the workers. This is only
+// called while every worker is parked so the deques can be filled directly
+static void planJob(struct ThreadPool *pool, size_t grain) {
+    struct Job *job = &pool->job;
+    size_t workerCount = pool->workers.size;
+    if (grain == 0) {
+        // a few chunks per worker leaves room to balance uneven work
+        grain = job->count / (workerCount * 8);
+    }
+    size_t maxChunks = workerCount * WORK_DEQUE_CAPACITY;
+    if (grain == 0 || (job->count + grain - 1) / grain > maxChunks) {
+        size_t minimumGrain = (job->count + maxChunks - 1) / maxChunks;
+        grain = grain > minimumGrain ? grain : minimumGrain;
+    }
+    job->grain = grain == 0 ? 1 : grain;
+}
+
+static void distributeJob(struct ThreadPool *pool) {
+    size_t workerCount = pool->workers.size;
+    size_t chunkCount = chunkCountFor(&pool->job);
+    size_t perWorker = (chunkCount + workerCount - 1) / workerCount;
+    for (size_t i = 0; i < workerCount; i++) {
+        size_t first = i * perWorker;
+        size_t last = first + perWorker < chunkCount ? first + perWorker
+                                                     : chunkCount;
+        // push backwards so the owner pops its chunks in order and thieves
+        // take from the far end
+        for (size_t chunk = last; chunk > first; chunk--) {
+            pushWork(&pool->workers.items[i].deque, (int64_t)chunk - 1);
+        }
+    }
+    atomic_store_explicit(&pool->pendingChunks, chunkCount,
+                          memory_order_relaxed);
+}
+
+static void runJob(struct ThreadPool *pool) {
+    distributeJob(pool);
+    uint32_t helpers = (uint32_t)pool->workers.size - 1;
+    if (helpers != 0) {
+        atomic_store_explicit(&pool->activeWorkers, helpers,
+                              memory_order_relaxed);
+        pthread_mutex_lock(&pool->lock);
+        pool->generation++;
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    runWorker(pool, &pool->workers.items[0]);
+    // wait for the chunks other workers took and for every worker to park
+    // again so the next job can fill the deques
+    while (atomic_load_explicit(&pool->pendingChunks, memory_order_acquire) !=
+               0 ||
+           atomic_load_explicit(&pool->activeWorkers, memory_order_acquire) !=
+               0) {
+        sched_yield();
+    }
+}
+
+int parallelFor(struct ThreadPool *pool, void *items, size_t count,
+                size_t grain, ParallelForFunction function, void *context) {
+    if (pool == NULL || function == NULL || (items == NULL && count != 0)) {
+        DEBUG_ERROR("`parallelFor` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (count == 0) {
+        return OK;
+    }
+    memset(&pool->job, 0, sizeof(struct Job));
+    pool->job.kind = JOB_FOR;
+    pool->job.count = count;
+    pool->job.destination = items;
+    pool->job.forFunction = function;
+    pool->job.context = context;
+    planJob(pool, grain);
+    runJob(pool);
+    return OK;
+}
+
+int parallelMap(struct ThreadPool *pool, const void *source,
+                void *destination, size_t count, size_t grain,
+                ParallelMapFunction function, void *context) {
+    if (pool == NULL || function == NULL ||
+        ((source == NULL || destination == NULL) && count != 0)) {
+        DEBUG_ERROR("`parallelMap` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (count == 0) {
+        return OK;
+    }
+    memset(&pool->job, 0, sizeof(struct Job));
+    pool->job.kind = JOB_MAP;
+    pool->job.count = count;
+    pool->job.source = source;
+    pool->job.destination = destination;
+    pool->job.mapFunction = function;
+    pool->job.context = context;
+    planJob(pool, grain);
+    runJob(pool);
+    return OK;
+}
+
+int parallelReduce(struct ThreadPool *pool, const void *items, size_t count,
+                   size_t grain, ParallelReduceFunction reduce,
+                   ParallelCombineFunction combine, void *result,
+                   size_t resultSize, void *context) {
+    if (pool == NULL || reduce == NULL || combine == NULL || result == NULL ||
+        (items == NULL && count != 0)) {
+        DEBUG_ERROR("`parallelReduce` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (count == 0) {
+        return OK;
+    }
+    memset(&pool->job, 0, sizeof(struct Job));
+    pool->job.kind = JOB_REDUCE;
+    pool->job.count = count;
+    pool->job.source = items;
+    pool->job.reduceFunction = reduce;
+    pool->job.resultSize = resultSize;
+    pool->job.context = context;
+    planJob(pool, grain);
+
+    // the chunk results live on the calling thread's scratch arena
+    struct Worker *caller = &pool->workers.items[0];
+    caller->scratch = getLastArenaNode(caller->scratch);
+    void *restorePoint = startScratchPad(caller->scratch);
+    size_t chunkCount = chunkCountFor(&pool->job);
+    char *partials = mallocArena(&caller->scratch, chunkCount * resultSize);
+    if (partials == NULL) {
+        DEBUG_ERROR("`parallelReduce` was unable to allocate chunk results");
+        return FAILEDALLOC;
+    }
+    for (size_t i = 0; i < chunkCount; i++) {
+        memcpy(partials + (i * resultSize), result, resultSize);
+    }
+    pool->job.partials = partials;
+    runJob(pool);
+    for (size_t i = 0; i < chunkCount; i++) {
+        combine(result, partials + (i * resultSize), context);
+    }
+    return restoreSratchPad(&caller->scratch, restorePoint);
+}
@@ -0,0 +1,93 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "arena.h"
+#include "array.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// A small job system for running loops over arrays on every core. Each worker
+// owns a work stealing deque and a scratch arena. The range is cut into chunks
+// of `grain` items, the chunks are handed out to the workers and any worker
+// that runs dry steals from the others. The thread calling into the pool works
+// on the job too, so a pool of one thread runs everything inline.
+//
+// The scratch arena passed to the callbacks belongs to the worker running the
+// chunk. It can be used without locks and is reset after every chunk.
+// Callbacks must not call back into the pool.
+struct ThreadPool;
+
+// run over items [start, end)
+typedef void (*ParallelForFunction)(void *items, size_t start, size_t end,
+                                    struct Arena **scratch, void *context);
+// read source [start, end) and write destination [start, end)
+typedef void (*ParallelMapFunction)(const void *source, void *destination,
+                                    size_t start, size_t end,
+                                    struct Arena **scratch, void *context);
+// fold items [start, end) into result. result starts as a copy of the value
+// that was passed to parallelReduce, so that value has to be the identity of
+// the reduction (0 for a sum, 1 for a product)
+typedef void (*ParallelReduceFunction)(const void *items, size_t start,
+                                       size_t end, void *result,
+                                       struct Arena **scratch, void *context);
+// fold a chunk result into the final result. Chunk results are combined in
+// order on the calling thread so the answer doesn't change from run to run
+typedef void (*ParallelCombineFunction)(void *result, const void *partial,
+                                        void *context);
+
+// create a pool with threadCount threads including the calling thread. A
+// count of 0 uses one thread per online cpu
+struct ThreadPool *createThreadPool(struct Arena **arena, uint32_t threadCount);
+
+// stop and join the threads. The pool pointer will be returned as null
+void destroyThreadPool(struct ThreadPool **pool);
+
+uint32_t threadPoolSize(const struct ThreadPool *pool);
+
+// a grain of 0 lets the pool pick a chunk size
+int parallelFor(struct ThreadPool *pool, void *items, size_t count,
+                size_t grain, ParallelForFunction function, void *context);
+int parallelMap(struct ThreadPool *pool, const void *source,
+                void *destination, size_t count, size_t grain,
+                ParallelMapFunction function, void *context);
+int parallelReduce(struct ThreadPool *pool, const void *items, size_t count,
+                   size_t grain, ParallelReduceFunction reduce,
+                   ParallelCombineFunction combine, void *result,
+                   size_t resultSize, void *context);
+
+#define PARALLEL_FOR(pool, array, grain, function, context, status)            \
+    do {                                                                       \
+        (status) = parallelFor(pool, (array).items, (array).size, grain,       \
+                               function, context);                             \
+    } while (0)
+
+// destination is resized to match source before the map runs
+#define PARALLEL_MAP(pool, source, destination, grain, function, context,      \
+                     status)                                                   \
+    do {                                                                       \
+        if (!ARRAY_INITIALIZED(destination)) {                                 \
+            DEBUG_ERROR("called PARALLEL_MAP with an unintialized array");     \
+            (status) = UNINITARRAY;                                            \
+            break;                                                             \
+        }                                                                      \
+        if ((destination).alloc < (source).size) {                             \
+            REALLOC_ARRAY(destination, (source).size, status);                 \
+        }                                                                      \
+        if ((destination).items == NULL && (source).size != 0) {               \
+            DEBUG_ERROR("cannot grow the destination array");                  \
+            break;                                                             \
+        }                                                                      \
+        (destination).size = (source).size;                                    \
+        (status) = parallelMap(pool, (source).items, (destination).items,      \
+                               (source).size, grain, function, context);       \
+    } while (0)
+
+// result holds the identity going in and the reduced value coming out
+#define PARALLEL_REDUCE(pool, array, grain, reduce, combine, result, context,  \
+                        status)                                                \
+    do {                                                                       \
+        (status) =                                                             \
+            parallelReduce(pool, (array).items, (array).size, grain, reduce,   \
+                           combine, &(result), sizeof(result), context);       \
+    } while (0)
+#endif
@@ -0,0 +1,95 @@
+#include "utf8.h"
+#include "arena.h"
+#include "array.h"
+#include "debug.h"
+#include "simd.h"
+#include <stdint.h>
+#include <string.h>
+
+int validateUtf8(const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("`validateUtf8` was called with a null pointer");
+        return 0;
+    }
+    return validUtf8(string->items, string->size);
+}
+
+size_t countCodepoints(const String *string) {
+    if (string == NULL) {
+        DEBUG_ERROR("`countCodepoints` was called with a null pointer");
+        return 0;
+    }
+    return countUtf8Leads(string->items, string->size);
+}
+
+// the input has already been validated so there are no checks in here
+static size_t decodeValid(const unsigned char *bytes, size_t size,
+                          uint32_t *codepoints) {
+    size_t count = 0;
+    size_t i = 0;
+    while (i < size) {
+        // widen runs of ascii eight at a time
+        uint64_t word;
+        if (i + 8 <= size) {
+            memcpy(&word, bytes + i, sizeof(word));
+            if ((word & 0x8080808080808080ULL) == 0) {
+                for (size_t k = 0; k < 8; k++) {
+                    codepoints[count + k] = bytes[i + k];
+                }
+                count += 8;
+                i += 8;
+                continue;
+            }
+        }
+        uint32_t lead = bytes[i];
+        if (lead < 0x80) {
+            codepoints[count++] = lead;
+            i++;
+        }
+        else if (lead < 0xE0) {
+            codepoints[count++] = ((lead & 0x1F) << 6) | (bytes[i + 1] & 0x3F);
+            i += 2;
+        }
+        else if (lead < 0xF0) {
+            codepoints[count++] = ((lead & 0x0F) << 12) |
+                                  ((uint32_t)(bytes[i + 1] & 0x3F) << 6) |
+                                  (bytes[i + 2] & 0x3F);
+            i += 3;
+        }
+        else {
+            codepoints[count++] = ((lead & 0x07) << 18) |
+                                  ((uint32_t)(bytes[i + 1] & 0x3F) << 12) |
+                                  ((uint32_t)(bytes[i + 2] & 0x3F) << 6) |
+                                  (bytes[i + 3] & 0x3F);
+            i += 4;
+        }
+    }
+    return count;
+}
+
+int decodeUtf8(const String *string, Utf32String *codepoints) {
+    if (string == NULL || codepoints == NULL) {
+        DEBUG_ERROR("`decodeUtf8` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (!ARRAY_INITIALIZED(*codepoints)) {
+        DEBUG_ERROR("`decodeUtf8` was given an uninitialized array");
+        return UNINITARRAY;
+    }
+    if (!validateUtf8(string)) {
+        return INVALIDARGS;
+    }
+    // size the array once up front so decoding can write straight into it
+    size_t count = countCodepoints(string);
+    int status = OK;
+    if (codepoints->alloc - codepoints->size < count) {
+        REALLOC_ARRAY(*codepoints, codepoints->size + count, status);
+        if (status != OK) {
+            return status;
+        }
+    }
+    codepoints->size +=
+        decodeValid((const unsigned char *)string->items, string->size,
+                    codepoints->items + codepoints->size);
+    return OK;
+}
@@ -0,0 +1,26 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include "arena.h"
+#include "array.h"
+#include "string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef ARRAY(uint32_t) Utf32String;
+
+// returns 1 if the string is well formed UTF-8. This is the check to run on
+// text that came from outside before trusting it. The AVX2 and SSE4.2 kernels
+// check a whole vector of bytes at once with table lookups instead of walking
+// a state machine one byte at a time
+int validateUtf8(const String *string);
+
+// number of codepoints in the string. This only counts the bytes that start a
+// codepoint so it has to be valid UTF-8 for the count to mean anything
+size_t countCodepoints(const String *string);
+
+// decode the string into codepoints and push them onto codepoints, which has
+// to be initialized. Returns INVALIDARGS without touching codepoints if the
+// string is not valid UTF-8
+int decodeUtf8(const String *string, Utf32String *codepoints);
+#endif
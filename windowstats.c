@@ -0,0 +1,209 @@
+#include "windowstats.h"
+#include "array.h"
+#include "debug.h"
+#include "deque.h"
+#include "ringbuffer.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Neumaier's version of Kahan summation. The low bits lost by each add are
+// kept in compensation and added back when the sum is read
+static void addCompensated(struct CompensatedSum *sum, double value) {
+    double total = sum->sum + value;
+    if (fabs(sum->sum) >= fabs(value)) {
+        sum->compensation += (sum->sum - total) + value;
+    }
+    else {
+        sum->compensation += (value - total) + sum->sum;
+    }
+    sum->sum = total;
+}
+
+static double readCompensated(const struct CompensatedSum *sum) {
+    return sum->sum + sum->compensation;
+}
+
+static uint32_t bucketFor(const struct WindowStats *stats, double value) {
+    double position = (value - stats->low) / stats->bucketWidth;
+    if (!(position > 0)) {
+        return 0;
+    }
+    if (position >= (double)stats->histogram.size) {
+        return (uint32_t)stats->histogram.size - 1;
+    }
+    return (uint32_t)position;
+}
+
+int initWindowStats(struct WindowStats *stats, struct Arena *arena,
+                    size_t windowSize, double low, double high,
+                    uint32_t bucketCount) {
+    if (stats == NULL || arena == NULL) {
+        DEBUG_ERROR("`initWindowStats` was called with a null pointer");
+        return NULLPOINTER;
+    }
+    if (windowSize <= 1 || bucketCount == 0 || !(high > low)) {
+        DEBUG_ERROR("`initWindowStats` was called with a bad window or range");
+        return INVALIDARGS;
+    }
+    int status = 0;
+    INIT_BUFFER(stats->samples, arena, windowSize, status);
+    if (status != OK || stats->samples.array.items == NULL) {
+        return FAILEDALLOC;
+    }
+    // the deques never hold more than the window so they never grow later
+    INIT_DEQUE(stats->minimums, arena, status);
+    RESERVE_DEQUE(stats->minimums, windowSize, status);
+    if (status != OK) {
+        return status;
+    }
+    INIT_DEQUE(stats->maximums, arena, status);
+    RESERVE_DEQUE(stats->maximums, windowSize, status);
+    if (status != OK) {
+        return status;
+    }
+    INIT_ARRAY(stats->histogram, arena, status);
+    REALLOC_ARRAY(stats->histogram, bucketCount, status);
+    if (status != OK) {
+        return status;
+    }
+    stats->histogram.size = bucketCount;
+    stats->low = low;
+    stats->bucketWidth = (high - low) / bucketCount;
+    clearWindowStats(stats);
+    return OK;
+}
+
+void clearWindowStats(struct WindowStats *stats) {
+    stats->samples.array.size = 0;
+    stats->samples.offset_index = 0;
+    stats->samples.head = stats->samples.array.items;
+    stats->samples.tail = stats->samples.array.items;
+    CLEAR_DEQUE(stats->minimums);
+    CLEAR_DEQUE(stats->maximums);
+    memset(stats->histogram.items, 0,
+           stats->histogram.size * sizeof(*stats->histogram.items));
+    memset(&stats->sum, 0, sizeof(stats->sum));
+    memset(&stats->sumSquares, 0, sizeof(stats->sumSquares));
+    stats->sequence = 0;
+}
+
+void pushWindowSample(struct WindowStats *stats, double value) {
+    int status = 0;
+    size_t windowSize = stats->samples.array.alloc;
+    if (stats->samples.array.size == windowSize) {
+        double evicted = *stats->samples.head;
+        addCompensated(&stats->sum, -evicted);
+        addCompensated(&stats->sumSquares, -(evicted * evicted));
+        stats->histogram.items[bucketFor(stats, evicted)]--;
+        // make the room ourselves, PUSH_BUFFER would complain about eating
+        // the head on every sample
+        CONSUME_BUFFER(stats->samples, 1);
+    }
+    PUSH_BUFFER(stats->samples, value);
+    addCompensated(&stats->sum, value);
+    addCompensated(&stats->sumSquares, value * value);
+    stats->histogram.items[bucketFor(stats, value)]++;
+
+    // drop anything that can never be the answer again from the back, then
+    // anything that fell out of the window from the front
+    struct WindowSample sample = {stats->sequence, value};
+    while (DEQUE_SIZE(stats->minimums) != 0 &&
+           GET_DEQUE_ITEM(stats->minimums, DEQUE_SIZE(stats->minimums) - 1)
+                   ->value >= value) {
+        DROP_BACK_DEQUE(stats->minimums);
+    }
+    PUSH_BACK_DEQUE(stats->minimums, sample, status);
+    while (DEQUE_SIZE(stats->maximums) != 0 &&
+           GET_DEQUE_ITEM(stats->maximums, DEQUE_SIZE(stats->maximums) - 1)
+                   ->value <= value) {
+        DROP_BACK_DEQUE(stats->maximums);
+    }
+    PUSH_BACK_DEQUE(stats->maximums, sample, status);
+    stats->sequence++;
+    if (stats->sequence > windowSize) {
+        uint64_t oldest = stats->sequence - windowSize;
+        if (GET_DEQUE_ITEM(stats->minimums, 0)->sequence < oldest) {
+            DROP_FRONT_DEQUE(stats->minimums);
+        }
+        if (GET_DEQUE_ITEM(stats->maximums, 0)->sequence < oldest) {
+            DROP_FRONT_DEQUE(stats->maximums);
+        }
+    }
+}
+
+size_t windowCount(const struct WindowStats *stats) {
+    return stats->samples.array.size;
+}
+
+double windowMean(const struct WindowStats *stats) {
+    size_t count = windowCount(stats);
+    if (count == 0) {
+        return 0;
+    }
+    return readCompensated(&stats->sum) / (double)count;
+}
+
+double windowVariance(const struct WindowStats *stats) {
+    size_t count = windowCount(stats);
+    if (count == 0) {
+        return 0;
+    }
+    double mean = windowMean(stats);
+    double variance =
+        (readCompensated(&stats->sumSquares) / (double)count) - (mean * mean);
+    // the subtraction can land a hair under zero when every sample is equal
+    return variance > 0 ? variance : 0;
+}
+
+double windowStandardDeviation(const struct WindowStats *stats) {
+    return sqrt(windowVariance(stats));
+}
+
+double windowMin(const struct WindowStats *stats) {
+    if (DEQUE_SIZE(stats->minimums) == 0) {
+        return 0;
+    }
+    return GET_DEQUE_ITEM(stats->minimums, 0)->value;
+}
+
+double windowMax(const struct WindowStats *stats) {
+    if (DEQUE_SIZE(stats->maximums) == 0) {
+        return 0;
+    }
+    return GET_DEQUE_ITEM(stats->maximums, 0)->value;
+}
+
+double windowPercentile(const struct WindowStats *stats, double percentile) {
+    size_t count = windowCount(stats);
+    if (count == 0) {
+        return 0;
+    }
+    if (percentile <= 0) {
+        return windowMin(stats);
+    }
+    if (percentile >= 100) {
+        return windowMax(stats);
+    }
+    double rank = (percentile / 100.0) * (double)count;
+    double seen = 0;
+    double result = windowMax(stats);
+    for (size_t i = 0; i < stats->histogram.size; i++) {
+        double bucketCount = stats->histogram.items[i];
+        if (seen + bucketCount >= rank && bucketCount != 0) {
+            double fraction = (rank - seen) / bucketCount;
+            result = stats->low + (((double)i + fraction) * stats->bucketWidth);
+            break;
+        }
+        seen += bucketCount;
+    }
+    // the end buckets also hold everything outside the range so keep the
+    // answer inside what was actually seen
+    if (result < windowMin(stats)) {
+        return windowMin(stats);
+    }
+    if (result > windowMax(stats)) {
+        return windowMax(stats);
+    }
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef WINDOWSTATS_H
+#define WINDOWSTATS_H
+
+#include "arena.h"
+#include "array.h"
+#include "deque.h"
+#include "ringbuffer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Running statistics over the last windowSize samples pushed, for things like
+// frame times. Nothing scans the window. Each push updates the stats with the
+// new sample and the one it pushes out of the BUFFER:
+//   - sum and sum of squares are kept with compensated (Neumaier) adds so
+//     adding and taking away values forever doesn't drift
+//   - min and max come from monotonic deques. The front is always the answer
+//     and every sample is pushed and popped at most once
+//   - percentiles come from a histogram with bucketCount buckets over
+//     [low, high). Samples outside the range land in the end buckets. The
+//     answer is interpolated inside a bucket so it is only as good as the
+//     bucket width, and a query walks the buckets so keep the count small
+struct WindowSample {
+    uint64_t sequence;
+    double value;
+};
+
+struct CompensatedSum {
+    double sum;
+    double compensation;
+};
+
+struct WindowStats {
+    BUFFER(double) samples;
+    DEQUE(struct WindowSample) minimums;
+    DEQUE(struct WindowSample) maximums;
+    ARRAY(uint32_t) histogram;
+    double low;
+    double bucketWidth;
+    struct CompensatedSum sum;
+    struct CompensatedSum sumSquares;
+    // samples pushed so far
+    uint64_t sequence;
+};
+
+int initWindowStats(struct WindowStats *stats, struct Arena *arena,
+                    size_t windowSize, double low, double high,
+                    uint32_t bucketCount);
+void pushWindowSample(struct WindowStats *stats, double value);
+void clearWindowStats(struct WindowStats *stats);
+
+size_t windowCount(const struct WindowStats *stats);
+// these all give 0 for an empty window
+double windowMean(const struct WindowStats *stats);
+double windowVariance(const struct WindowStats *stats);
+double windowStandardDeviation(const struct WindowStats *stats);
+double windowMin(const struct WindowStats *stats);
+double windowMax(const struct WindowStats *stats);
+// percentile is from 0 to 100
+double windowPercentile(const struct WindowStats *stats, double percentile);
+
+#endif